@@ -36,7 +36,6 @@
 #include "libls/ls_panic.h"
 #include "libls/ls_lua_compat.h"
 #include "libls/ls_alloc_utils.h"
-#include "libls/ls_freemem.h"
 
 #include "priv.h"
 
@@ -72,9 +71,9 @@ typedef struct {
     size_t capacity;
 } TokenList;
 
-static inline TokenList token_list_new(void)
+static inline TokenList token_list_new_reserve(size_t capacity)
 {
-    return (TokenList) {NULL, 0, 0};
+    return (TokenList) {LS_XNEW(Token, capacity), 0, capacity};
 }
 
 static inline void token_list_push(TokenList *x, Token token)
@@ -85,9 +84,12 @@ static inline void token_list_push(TokenList *x, Token token)
     x->data[x->size++] = token;
 }
 
-static inline void token_list_clear(TokenList *x)
+// Unlike the other containers we clear, we do not free (any part of) the memory here: the token
+// list is refilled on each click event, and click events may arrive at a rate of hundreds per
+// second (e.g. when the user scrolls with a mouse wheel).
+static inline void token_list_reset(TokenList *x)
 {
-    x->data = LS_M_FREEMEM(x->data, &x->size, &x->capacity);
+    x->size = 0;
 }
 
 static inline void token_list_free(TokenList *x)
@@ -102,10 +104,16 @@ typedef struct {
     // Whether the last key (at depth == 1) was "name".
     bool last_key_is_name;
 
-    // An array in which all the JSON strings, including keys, are stored.
+    // Whether we are inside a value of a key (at depth == 1) that has been filtered out with the
+    // /click_fields/ option. Tokens of such a value are not recorded (but still counted towards the
+    // depth).
+    bool skip_value;
+
+    // An array in which all the JSON strings, including keys, are stored. Reset, but not freed,
+    // after each event.
     LS_StringArray strarr;
 
-    // A flat list of current event's tokens.
+    // A flat list of current event's tokens. Reset, but not freed, after each event.
     TokenList tokens;
 
     // Current event's widget index, or a negative value if is not known yet or invalid.
@@ -191,8 +199,9 @@ static void flush(Context *ctx)
 
     // reset the context
     ctx->last_key_is_name = false;
-    ls_strarr_clear(&ctx->strarr);
-    token_list_clear(&ctx->tokens);
+    ctx->skip_value = false;
+    ls_strarr_reset(&ctx->strarr);
+    token_list_reset(&ctx->tokens);
     ctx->widget = -1;
 }
 
@@ -209,7 +218,10 @@ static int token_helper(Context *ctx, Token token)
             LS_ERRF(ctx->bd, "(event watcher) expected '{'");
             return 0;
         }
-        token_list_push(&ctx->tokens, token);
+        bool skip = ctx->skip_value;
+        if (!skip) {
+            token_list_push(&ctx->tokens, token);
+        }
         switch (token.type) {
         case TYPE_ARRAY_START:
         case TYPE_MAP_START:
@@ -229,12 +241,20 @@ static int token_helper(Context *ctx, Token token)
         default:
             break;
         }
+        if (skip && ctx->depth == 1) {
+            // The skipped value has ended.
+            ctx->skip_value = false;
+        }
     }
     return 1;
 }
 
 static inline size_t append_to_strarr(Context *ctx, const char *buf, size_t nbuf)
 {
+    if (ctx->skip_value) {
+        // The token is not going to be recorded anyway.
+        return 0;
+    }
     ls_strarr_append(&ctx->strarr, buf, nbuf);
     return ls_strarr_size(ctx->strarr) - 1;
 }
@@ -278,11 +298,34 @@ static int callback_start_map(void *vctx)
     return token_helper(vctx, (Token) {TYPE_MAP_START, {0}});
 }
 
+static bool is_wanted_click_field(Priv *p, const unsigned char *buf, size_t nbuf)
+{
+    if (!p->filter_click_fields) {
+        return true;
+    }
+    size_t n = ls_strarr_size(p->click_fields);
+    for (size_t i = 0; i < n; ++i) {
+        size_t nfield;
+        const char *field = ls_strarr_at(p->click_fields, i, &nfield);
+        if (nfield == nbuf && memcmp(field, buf, nbuf) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static int callback_map_key(void *vctx, const unsigned char *buf, size_t nbuf)
 {
     Context *ctx = vctx;
     if (ctx->depth == 1) {
         ctx->last_key_is_name = (nbuf == 4 && memcmp(buf, "name", 4) == 0);
+
+        if (!is_wanted_click_field(ctx->bd->priv, buf, nbuf)) {
+            // Neither the key nor the value is recorded; /callback_string()/ still parses the
+            // widget index out of the value if this key is "name".
+            ctx->skip_value = true;
+            return 1;
+        }
     }
     return token_helper(ctx, (Token) {
         TYPE_STRING_KEY,
@@ -314,8 +357,9 @@ int event_watcher(LuastatusBarlibData *bd, LuastatusBarlibEWFuncs funcs)
     Context ctx = {
         .depth = -1,
         .last_key_is_name = false,
-        .strarr = ls_strarr_new(),
-        .tokens = token_list_new(),
+        .skip_value = false,
+        .strarr = ls_strarr_new_reserve(1024, 64),
+        .tokens = token_list_new_reserve(64),
         .widget = -1,
         .bd = bd,
         .funcs = funcs,
@@ -30,12 +30,14 @@
 #include "include/sayf_macros.h"
 
 #include "libls/ls_string.h"
+#include "libls/ls_strarr.h"
 #include "libls/ls_alloc_utils.h"
 #include "libls/ls_parse_int.h"
 #include "libls/ls_cstring_utils.h"
 #include "libls/ls_tls_ebuf.h"
 #include "libls/ls_io_utils.h"
 #include "libls/ls_lua_compat.h"
+#include "libls/ls_frame_writer.h"
 #include "libsafe/safev.h"
 
 #include "priv.h"
@@ -51,6 +53,11 @@ static void destroy(LuastatusBarlibData *bd)
     }
     free(p->bufs);
     ls_string_free(p->tmpbuf);
+    ls_string_free(p->frame);
+    ls_strarr_destroy(p->click_fields);
+    if (p->fw_inited) {
+        ls_frame_writer_destroy(&p->fw);
+    }
     ls_close(p->in_fd);
     if (p->out) {
         fclose(p->out);
@@ -58,6 +65,22 @@ static void destroy(LuastatusBarlibData *bd)
     free(p);
 }
 
+// Appends entries of a comma-separated list /s/ to /p->click_fields/.
+static void append_click_fields(Priv *p, const char *s)
+{
+    for (;;) {
+        const char *comma = strchr(s, ',');
+        size_t ns = comma ? (size_t) (comma - s) : strlen(s);
+        if (ns) {
+            ls_strarr_append(&p->click_fields, s, ns);
+        }
+        if (!comma) {
+            break;
+        }
+        s = comma + 1;
+    }
+}
+
 static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidgets)
 {
     Priv *p = bd->priv = LS_XNEW(Priv, 1);
@@ -67,7 +90,12 @@ static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidget
         .tmpbuf = ls_string_new_reserve(1024),
         .in_fd = -1,
         .out = NULL,
+        .frame = ls_string_new_reserve(1024),
+        .async_output = false,
+        .fw_inited = false,
         .noclickev = false,
+        .filter_click_fields = false,
+        .click_fields = ls_strarr_new(),
         .noseps = false,
     };
     for (size_t i = 0; i < nwidgets; ++i)
@@ -92,10 +120,15 @@ static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidget
             }
         } else if (strcmp(*s, "no_click_events") == 0) {
             p->noclickev = true;
+        } else if ((v = ls_strfollow(*s, "click_fields="))) {
+            p->filter_click_fields = true;
+            append_click_fields(p, v);
         } else if (strcmp(*s, "no_separators") == 0) {
             p->noseps = true;
         } else if (strcmp(*s, "allow_stopping") == 0) {
             allow_stopping = true;
+        } else if (strcmp(*s, "async_output") == 0) {
+            p->async_output = true;
         } else if ((v = ls_strfollow(*s, "extra_init_json="))) {
             extra_init_json = v;
         } else {
@@ -147,6 +180,12 @@ static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidget
         goto error;
     }
 
+    // From now on, if /async_output/ was specified, everything is written by the frame writer.
+    if (p->async_output) {
+        ls_frame_writer_init(&p->fw, out_fd);
+        p->fw_inited = true;
+    }
+
     return LUASTATUS_OK;
 
 error:
@@ -158,22 +197,34 @@ static bool redraw(LuastatusBarlibData *bd)
 {
     Priv *p = bd->priv;
 
-    FILE *out = p->out;
     size_t n = p->nwidgets;
     LS_String *bufs = p->bufs;
+    LS_String *frame = &p->frame;
 
-    putc('[', out);
+    ls_string_clear(frame);
+    ls_string_append_c(frame, '[');
     bool first = true;
     for (size_t i = 0; i < n; ++i) {
         if (bufs[i].size) {
             if (!first) {
-                putc(',', out);
+                ls_string_append_c(frame, ',');
             }
-            fwrite(bufs[i].data, 1, bufs[i].size, out);
+            ls_string_append_b(frame, bufs[i].data, bufs[i].size);
             first = false;
         }
     }
-    fputs("],\n", out);
+    ls_string_append_s(frame, "],\n");
+
+    if (p->async_output) {
+        if (ls_frame_writer_submit(&p->fw, frame) < 0) {
+            LS_FATALF(bd, "write error: %s", ls_tls_strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    FILE *out = p->out;
+    fwrite(frame->data, 1, frame->size, out);
     fflush(out);
     if (ferror(out)) {
         LS_FATALF(bd, "write error: %s", ls_tls_strerror(errno));
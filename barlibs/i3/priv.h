@@ -24,6 +24,8 @@
 #include <stddef.h>
 
 #include "libls/ls_string.h"
+#include "libls/ls_strarr.h"
+#include "libls/ls_frame_writer.h"
 
 typedef struct {
     size_t nwidgets;
@@ -39,7 +41,24 @@ typedef struct {
     // /fdopen/'ed output file descriptor.
     FILE *out;
 
+    // Buffer the next frame (a JSON array of segments of all widgets) is rendered to.
+    LS_String frame;
+
+    // Whether the /async_output/ option was specified.
+    bool async_output;
+
+    // Frame writer for the /async_output/ mode; only initialized if /fw_inited/ is true.
+    LS_FrameWriter fw;
+    bool fw_inited;
+
     bool noclickev;
 
+    // Whether the /click_fields/ option was specified.
+    bool filter_click_fields;
+
+    // Top-level keys of click events that are to be passed to widgets' /event/ functions; only
+    // meaningful if /filter_click_fields/ is true.
+    LS_StringArray click_fields;
+
     bool noseps;
 } Priv;
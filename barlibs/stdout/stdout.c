@@ -19,6 +19,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <lua.h>
 #include <lauxlib.h>
 #include <errno.h>
@@ -34,6 +35,7 @@
 #include "libls/ls_parse_int.h"
 #include "libls/ls_alloc_utils.h"
 #include "libls/ls_lua_compat.h"
+#include "libls/ls_frame_writer.h"
 #include "libsafe/safev.h"
 
 #include "sanitize.h"
@@ -55,6 +57,16 @@ typedef struct {
     // /fdopen/'ed output file descriptor.
     FILE *out;
 
+    // Buffer the next frame (a line with content of all widgets) is rendered to.
+    LS_String frame;
+
+    // Whether the /async_output/ option was specified.
+    bool async_output;
+
+    // Frame writer for the /async_output/ mode; only initialized if /fw_inited/ is true.
+    LS_FrameWriter fw;
+    bool fw_inited;
+
     // Value of /in_filename/ option.
     FILE *in;
 } Priv;
@@ -67,6 +79,10 @@ static void destroy(LuastatusBarlibData *bd)
     }
     free(p->bufs);
     ls_string_free(p->tmpbuf);
+    ls_string_free(p->frame);
+    if (p->fw_inited) {
+        ls_frame_writer_destroy(&p->fw);
+    }
     free(p->sep);
     free(p->error);
     if (p->out) {
@@ -88,6 +104,9 @@ static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidget
         .sep = NULL,
         .error = NULL,
         .out = NULL,
+        .frame = ls_string_new_reserve(512),
+        .async_output = false,
+        .fw_inited = false,
         .in = NULL,
     };
     for (size_t i = 0; i < nwidgets; ++i)
@@ -113,6 +132,8 @@ static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidget
             }
         } else if ((v = ls_strfollow(*s, "separator="))) {
             sep = v;
+        } else if (strcmp(*s, "async_output") == 0) {
+            p->async_output = true;
         } else if ((v = ls_strfollow(*s, "error="))) {
             error = v;
         } else if ((v = ls_strfollow(*s, "in_filename="))) {
@@ -147,6 +168,11 @@ static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidget
         goto error;
     }
 
+    if (p->async_output) {
+        ls_frame_writer_init(&p->fw, out_fd);
+        p->fw_inited = true;
+    }
+
     return LUASTATUS_OK;
 
 error:
@@ -157,22 +183,34 @@ error:
 static bool redraw(LuastatusBarlibData *bd)
 {
     Priv *p = bd->priv;
-    FILE *out = p->out;
     size_t n = p->nwidgets;
     LS_String *bufs = p->bufs;
     const char *sep = p->sep;
+    LS_String *frame = &p->frame;
 
+    ls_string_clear(frame);
     bool first = true;
     for (size_t i = 0; i < n; ++i) {
         if (bufs[i].size) {
             if (!first) {
-                fputs(sep, out);
+                ls_string_append_s(frame, sep);
             }
-            fwrite(bufs[i].data, 1, bufs[i].size, out);
+            ls_string_append_b(frame, bufs[i].data, bufs[i].size);
             first = false;
         }
     }
-    putc('\n', out);
+    ls_string_append_c(frame, '\n');
+
+    if (p->async_output) {
+        if (ls_frame_writer_submit(&p->fw, frame) < 0) {
+            LS_FATALF(bd, "write error: %s", ls_tls_strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    FILE *out = p->out;
+    fwrite(frame->data, 1, frame->size, out);
     fflush(out);
     if (ferror(out)) {
         LS_FATALF(bd, "write error: %s", ls_tls_strerror(errno));
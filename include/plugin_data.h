@@ -55,6 +55,13 @@ typedef struct {
     void       (*call_cancel)(void *userdata);
 } LuastatusPluginRunFuncs_v1;
 
+typedef struct {
+    lua_State *(*call_begin) (void *userdata);
+    void       (*call_end)   (void *userdata);
+    void       (*call_cancel)(void *userdata);
+    void       (*call_idle)  (void *userdata);
+} LuastatusPluginRunFuncs_v2;
+
 typedef struct {
     // This function should initialize a widget by assigning something to /pd->priv/.
     // You would typically do:
@@ -123,3 +130,25 @@ typedef struct {
     // This function should destroy a previously successfully initialized widget.
     void (*destroy)(LuastatusPluginData_v1 *pd);
 } LuastatusPluginIface_v1;
+
+// The second version of the plugin interface. It only differs from the first one in the set of
+// functions passed to /run/; luastatus looks for /luastatus_plugin_iface_v2/ first, and falls back
+// to /luastatus_plugin_iface_v1/.
+typedef struct {
+    // See /LuastatusPluginIface_v1/.
+    int (*init)(LuastatusPluginData_v1 *pd, lua_State *L);
+
+    // See /LuastatusPluginIface_v1/.
+    void (*register_funcs)(LuastatusPluginData_v1 *pd, lua_State *L);
+
+    // Same as in /LuastatusPluginIface_v1/; in addition, plugins that wait for events in a loop
+    // should call
+    //     /funcs.call_idle(pd->userdata)/
+    // (not between /call_begin/ and /call_end/ or /call_cancel/) right before each wait. This lets
+    // the widget do some bounded housekeeping work, such as a garbage collection step, when it is
+    // not going to be updated for a while.
+    void (*run)(LuastatusPluginData_v1 *pd, LuastatusPluginRunFuncs_v2 funcs);
+
+    // See /LuastatusPluginIface_v1/.
+    void (*destroy)(LuastatusPluginData_v1 *pd);
+} LuastatusPluginIface_v2;
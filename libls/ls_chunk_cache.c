@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ls_chunk_cache.h"
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "ls_alloc_utils.h"
+#include "ls_lua_compat.h"
+#include "ls_panic.h"
+#include "ls_string.h"
+#include "ls_xallocf.h"
+
+typedef struct Entry {
+    struct Entry *next;
+
+    char *filename;
+
+    // "@" followed by /filename/, as /luaL_loadfile()/ names the chunks.
+    char *chunkname;
+
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+
+    // Whether /bytecode/ is valid. It is not until the file is loaded the second time.
+    bool has_bytecode;
+    LS_String bytecode;
+} Entry;
+
+// Guards /entries/ and the entries themselves.
+static pthread_mutex_t mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static Entry *entries = NULL;
+
+static Entry *find(const char *filename)
+{
+    for (Entry *e = entries; e; e = e->next) {
+        if (strcmp(e->filename, filename) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static bool entry_matches(const Entry *e, const struct stat *st)
+{
+    return e->dev == st->st_dev &&
+           e->ino == st->st_ino &&
+           e->size == st->st_size &&
+           e->mtime.tv_sec == st->st_mtim.tv_sec &&
+           e->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+static int writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+    (void) L;
+    ls_string_append_b(ud, p, sz);
+    return 0;
+}
+
+int ls_chunk_cache_loadfile(lua_State *L, const char *filename)
+{
+    struct stat st;
+    if (stat(filename, &st) < 0) {
+        // Let Lua report the error.
+        return luaL_loadfile(L, filename);
+    }
+
+    bool seen = false;
+
+    LS_PTH_CHECK(pthread_mutex_lock(&mtx));
+    Entry *e = find(filename);
+    if (e && entry_matches(e, &st)) {
+        if (e->has_bytecode) {
+            int r = luaL_loadbuffer(L, e->bytecode.data, e->bytecode.size, e->chunkname);
+            LS_PTH_CHECK(pthread_mutex_unlock(&mtx));
+            return r;
+        }
+        seen = true;
+    } else {
+        if (!e) {
+            e = LS_XNEW(Entry, 1);
+            e->filename = ls_xstrdup(filename);
+            e->chunkname = ls_xallocf("@%s", filename);
+            e->bytecode = ls_string_new();
+            e->next = entries;
+            entries = e;
+        }
+        e->dev = st.st_dev;
+        e->ino = st.st_ino;
+        e->size = st.st_size;
+        e->mtime = st.st_mtim;
+        e->has_bytecode = false;
+        ls_string_free(e->bytecode);
+        e->bytecode = ls_string_new();
+    }
+    LS_PTH_CHECK(pthread_mutex_unlock(&mtx));
+
+    int r = luaL_loadfile(L, filename);
+    if (r != 0 || !seen) {
+        return r;
+    }
+
+    // L: ? chunk
+    LS_String bytecode = ls_string_new();
+    if (ls_lua_dump(L, writer, &bytecode) != 0) {
+        // Just do not cache it.
+        ls_string_free(bytecode);
+        return 0;
+    }
+
+    LS_PTH_CHECK(pthread_mutex_lock(&mtx));
+    // The entry may have been updated (or removed by /ls_chunk_cache_clear()/) while we were not
+    // holding the lock.
+    e = find(filename);
+    if (e && entry_matches(e, &st) && !e->has_bytecode) {
+        e->has_bytecode = true;
+        ls_string_swap(&e->bytecode, &bytecode);
+    }
+    LS_PTH_CHECK(pthread_mutex_unlock(&mtx));
+
+    ls_string_free(bytecode);
+    return 0;
+}
+
+void ls_chunk_cache_clear(void)
+{
+    LS_PTH_CHECK(pthread_mutex_lock(&mtx));
+    for (Entry *e = entries; e;) {
+        Entry *next = e->next;
+        free(e->filename);
+        free(e->chunkname);
+        ls_string_free(e->bytecode);
+        free(e);
+        e = next;
+    }
+    entries = NULL;
+    LS_PTH_CHECK(pthread_mutex_unlock(&mtx));
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <lua.h>
+
+// A process-wide cache of compiled Lua chunks loaded from files.
+//
+// The first time a file is loaded, it is compiled as usual, and only its identity (device, inode
+// number, size and modification time) is remembered. The second time, the resulting function is
+// also dumped into a binary chunk, which is then kept in memory. Subsequent loads of the same file,
+// in any Lua interpreter instance, load that binary chunk instead of parsing the source again, as
+// long as the file has not changed. This way, files that are only ever loaded once (which is the
+// case for most widget files) do not take up memory.
+//
+// All the functions are thread-safe.
+
+// Loads the file /filename/ as a Lua chunk, as if with /luaL_loadfile(L, filename)/, and with the
+// same chunk name.
+int ls_chunk_cache_loadfile(lua_State *L, const char *filename);
+
+// Frees all the cached chunks.
+void ls_chunk_cache_clear(void);
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ls_frame_writer.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include "ls_string.h"
+#include "ls_panic.h"
+
+// Returns /0/ on success, or an /errno/ value on failure.
+static int write_all(int fd, const char *buf, size_t nbuf)
+{
+    while (nbuf) {
+        ssize_t w = write(fd, buf, nbuf);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        buf += w;
+        nbuf -= w;
+    }
+    return 0;
+}
+
+static void *writer_thread(void *arg)
+{
+    LS_FrameWriter *fw = arg;
+
+    // The thread can only be cancelled (by /ls_frame_writer_destroy()/) while it is blocked in
+    // /write()/, that is, while it does not hold the mutex.
+    LS_PTH_CHECK(pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL));
+
+    for (;;) {
+        LS_PTH_CHECK(pthread_mutex_lock(&fw->mtx));
+        while (!fw->has_pending && !fw->stop) {
+            LS_PTH_CHECK(pthread_cond_wait(&fw->cond, &fw->mtx));
+        }
+        // Even if asked to stop, write the pending frame first: it is the last one.
+        if (!fw->has_pending) {
+            LS_PTH_CHECK(pthread_mutex_unlock(&fw->mtx));
+            break;
+        }
+        ls_string_swap(&fw->pending, &fw->writing);
+        fw->has_pending = false;
+        LS_PTH_CHECK(pthread_mutex_unlock(&fw->mtx));
+
+        LS_PTH_CHECK(pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL));
+        int errnum = write_all(fw->fd, fw->writing.data, fw->writing.size);
+        LS_PTH_CHECK(pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL));
+
+        if (errnum) {
+            LS_PTH_CHECK(pthread_mutex_lock(&fw->mtx));
+            fw->errnum = errnum;
+            LS_PTH_CHECK(pthread_mutex_unlock(&fw->mtx));
+            break;
+        }
+    }
+
+    LS_PTH_CHECK(pthread_mutex_lock(&fw->mtx));
+    fw->done = true;
+    LS_PTH_CHECK(pthread_cond_signal(&fw->cond));
+    LS_PTH_CHECK(pthread_mutex_unlock(&fw->mtx));
+    return NULL;
+}
+
+void ls_frame_writer_init(LS_FrameWriter *fw, int fd)
+{
+    *fw = (LS_FrameWriter) {
+        .fd = fd,
+        .pending = ls_string_new_reserve(1024),
+        .has_pending = false,
+        .writing = ls_string_new_reserve(1024),
+        .errnum = 0,
+        .stop = false,
+        .done = false,
+    };
+    LS_PTH_CHECK(pthread_mutex_init(&fw->mtx, NULL));
+    LS_PTH_CHECK(pthread_cond_init(&fw->cond, NULL));
+    LS_PTH_CHECK(pthread_create(&fw->thread, NULL, writer_thread, fw));
+}
+
+int ls_frame_writer_submit(LS_FrameWriter *fw, LS_String *frame)
+{
+    int errnum;
+
+    LS_PTH_CHECK(pthread_mutex_lock(&fw->mtx));
+    errnum = fw->errnum;
+    if (!errnum) {
+        ls_string_swap(&fw->pending, frame);
+        fw->has_pending = true;
+        LS_PTH_CHECK(pthread_cond_signal(&fw->cond));
+    }
+    LS_PTH_CHECK(pthread_mutex_unlock(&fw->mtx));
+
+    if (errnum) {
+        errno = errnum;
+        return -1;
+    }
+    return 0;
+}
+
+void ls_frame_writer_destroy(LS_FrameWriter *fw)
+{
+    struct timespec deadline;
+    if (clock_gettime(CLOCK_REALTIME, &deadline) < 0) {
+        LS_PANIC_WITH_ERRNUM("clock_gettime() failed", errno);
+    }
+    deadline.tv_sec += LS_FRAME_WRITER_FLUSH_TIMEOUT;
+
+    LS_PTH_CHECK(pthread_mutex_lock(&fw->mtx));
+    fw->stop = true;
+    LS_PTH_CHECK(pthread_cond_broadcast(&fw->cond));
+    bool done = true;
+    while (!fw->done) {
+        int rc = pthread_cond_timedwait(&fw->cond, &fw->mtx, &deadline);
+        if (rc == ETIMEDOUT) {
+            done = fw->done;
+            break;
+        }
+        LS_PTH_CHECK(rc);
+    }
+    LS_PTH_CHECK(pthread_mutex_unlock(&fw->mtx));
+
+    if (!done) {
+        // The writer thread is blocked in /write()/, and nobody seems to read from /fd/.
+        (void) pthread_cancel(fw->thread);
+    }
+    LS_PTH_CHECK(pthread_join(fw->thread, NULL));
+
+    LS_PTH_CHECK(pthread_cond_destroy(&fw->cond));
+    LS_PTH_CHECK(pthread_mutex_destroy(&fw->mtx));
+    ls_string_free(fw->pending);
+    ls_string_free(fw->writing);
+}
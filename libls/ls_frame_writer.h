@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "ls_string.h"
+
+// A "frame writer" writes complete frames (e.g. full status lines) to a file descriptor from a
+// separate thread, so that the thread submitting a frame never blocks on the reader of that file
+// descriptor.
+//
+// At most one frame is kept waiting: if a new frame is submitted while the previous one has not
+// been picked up by the writer thread yet, the previous one is discarded. A frame that the writer
+// thread has started to write is always written completely, so that the reader never sees a
+// partial frame followed by another one.
+//
+// <!!!>
+// This structure must reside at a constant address throughout its whole life, as the writer
+// thread holds a pointer to it.
+// </!!!>
+typedef struct {
+    int fd;
+
+    pthread_t thread;
+
+    // Guards /pending/, /has_pending/, /errnum/, /stop/ and /done/.
+    pthread_mutex_t mtx;
+
+    // Signalled whenever /has_pending/, /stop/ or /done/ is set.
+    pthread_cond_t cond;
+
+    // The most recent frame that has not been picked up by the writer thread yet.
+    LS_String pending;
+    bool has_pending;
+
+    // The frame currently being written; only accessed by the writer thread (and by
+    // /ls_frame_writer_destroy()/ after the writer thread has been joined).
+    LS_String writing;
+
+    // /errno/ value of the write error that has stopped the writer thread, or 0.
+    int errnum;
+
+    bool stop;
+
+    // Set by the writer thread right before it exits; /cond/ is signalled then, too.
+    bool done;
+} LS_FrameWriter;
+
+// How long, in seconds, /ls_frame_writer_destroy()/ waits for the writer thread to write the
+// pending frame before giving up on it.
+#define LS_FRAME_WRITER_FLUSH_TIMEOUT 2
+
+// Initializes /fw/ and spawns the writer thread that writes to /fd/.
+//
+// /fd/ should be in blocking mode; it is not closed by /ls_frame_writer_destroy()/.
+void ls_frame_writer_init(LS_FrameWriter *fw, int fd);
+
+// Replaces the pending frame of /fw/ with the content of /frame/. The content of /frame/ is
+// unspecified after the call (its buffer is swapped with the old pending one and can be reused).
+//
+// On success, /0/ is returned.
+//
+// If the writer thread has stopped because of a write error, /-1/ is returned and /errno/ is set
+// to the error that has occurred.
+int ls_frame_writer_submit(LS_FrameWriter *fw, LS_String *frame);
+
+// Lets the writer thread finish writing the current and the pending frames, if any, then stops it
+// and destroys /fw/.
+//
+// If that takes more than /LS_FRAME_WRITER_FLUSH_TIMEOUT/ seconds (the reader of /fd/ is stuck),
+// the writer thread is cancelled, and the frames are abandoned.
+void ls_frame_writer_destroy(LS_FrameWriter *fw);
@@ -51,6 +51,37 @@ LS_INHEADER bool ls_lua_is_lua51(lua_State *L)
 #endif
 }
 
+LS_INHEADER void ls_lua_pushglobaltable(lua_State *L)
+{
+#if LUA_VERSION_NUM <= 501
+    lua_pushvalue(L, LUA_GLOBALSINDEX);
+#else
+    lua_pushglobaltable(L);
+#endif
+}
+
+// Pops a table from the stack and sets it as the environment of the Lua chunk (as returned by
+// /lua_load()/ and friends) at position /pos/.
+LS_INHEADER void ls_lua_setchunkenv(lua_State *L, int pos)
+{
+#if LUA_VERSION_NUM <= 501
+    lua_setfenv(L, pos);
+#else
+    // The first (and only) upvalue of a main chunk is /_ENV/.
+    lua_setupvalue(L, pos, 1);
+#endif
+}
+
+// Dumps the function on top of the stack as a binary chunk, keeping the debug information.
+LS_INHEADER int ls_lua_dump(lua_State *L, lua_Writer writer, void *data)
+{
+#if LUA_VERSION_NUM >= 503
+    return lua_dump(L, writer, data, 0);
+#else
+    return lua_dump(L, writer, data);
+#endif
+}
+
 LS_INHEADER size_t ls_lua_array_len(lua_State *L, int pos)
 {
 #if LUA_VERSION_NUM <= 501
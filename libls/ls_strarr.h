@@ -103,6 +103,14 @@ LS_INHEADER void ls_strarr_clear(LS_StringArray *sa)
     o->data = LS_M_FREEMEM(o->data, &o->size, &o->capacity);
 }
 
+// Like /ls_strarr_clear()/, but keeps all the memory allocated, so that the array can be refilled
+// without any reallocations. Useful when an array is used as a per-iteration scratch buffer.
+LS_INHEADER void ls_strarr_reset(LS_StringArray *sa)
+{
+    ls_string_clear(&sa->buf);
+    sa->offsets.size = 0;
+}
+
 LS_INHEADER void ls_strarr_destroy(LS_StringArray sa)
 {
     ls_string_free(sa.buf);
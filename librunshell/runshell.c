@@ -27,6 +27,7 @@
 #include <errno.h>
 #include <sys/wait.h>
 #include <sys/types.h>
+#include <pthread.h>
 #include <lua.h>
 #include <lauxlib.h>
 
@@ -68,40 +69,116 @@ static const char *my_strerror(int errnum)
 
 extern char **environ;
 
-int runshell(const char *cmd)
+// A list of PIDs of child processes passed to /runshell_forget()/ that have not been reaped yet.
+static struct {
+    pid_t *data;
+    size_t size;
+    size_t capacity;
+} orphans;
+static pthread_mutex_t orphans_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static void reap_orphans(void)
+{
+    CANNOT_FAIL_PTH(pthread_mutex_lock(&orphans_mtx));
+    size_t j = 0;
+    for (size_t i = 0; i < orphans.size; ++i) {
+        pid_t pid = orphans.data[i];
+        int status;
+        pid_t r = waitpid(pid, &status, WNOHANG);
+        if (r == 0 || (r < 0 && errno == EINTR)) {
+            // Still running (or we have been interrupted); keep it.
+            orphans.data[j++] = pid;
+        }
+    }
+    orphans.size = j;
+    CANNOT_FAIL_PTH(pthread_mutex_unlock(&orphans_mtx));
+}
+
+void runshell_forget(pid_t pid)
+{
+    CANNOT_FAIL_PTH(pthread_mutex_lock(&orphans_mtx));
+    if (orphans.size == orphans.capacity) {
+        size_t new_capacity = orphans.capacity ? orphans.capacity * 2 : 4;
+        pid_t *new_data = realloc(orphans.data, sizeof(pid_t) * new_capacity);
+        if (!new_data) {
+            fputs("librunshell: out of memory\n", stderr);
+            abort();
+        }
+        orphans.data = new_data;
+        orphans.capacity = new_capacity;
+    }
+    orphans.data[orphans.size++] = pid;
+    CANNOT_FAIL_PTH(pthread_mutex_unlock(&orphans_mtx));
+}
+
+static char *const *sh_argv(const char *cmd, char *buf[4])
 {
     if (!cmd) {
         fputs("librunshell: passed cmd == NULL (this is not supported)\n", stderr);
         abort();
     }
+    buf[0] = (char *) "sh";
+    buf[1] = (char *) "-c";
+    buf[2] = (char *) cmd;
+    buf[3] = NULL;
+    return buf;
+}
 
+// Blocks /SIGCHLD/ in the calling thread, storing the previous signal mask into /*ss_old/.
+//
+// While we are spawning or waiting for a child process, a /SIGCHLD/ handler (if the program has
+// one) must not be run in this thread: it might reap our child before we do.
+static void block_sigchld(sigset_t *ss_old)
+{
     sigset_t ss_new;
-    sigset_t ss_old;
     CANNOT_FAIL(sigemptyset(&ss_new));
     CANNOT_FAIL(sigaddset(&ss_new, SIGCHLD));
-    CANNOT_FAIL(sigprocmask(SIG_BLOCK, &ss_new, &ss_old));
+    CANNOT_FAIL(sigprocmask(SIG_BLOCK, &ss_new, ss_old));
+}
+
+static void restore_sigmask(const sigset_t *ss_old)
+{
+    CANNOT_FAIL(sigprocmask(SIG_SETMASK, ss_old, NULL));
+}
 
+// Spawns a child process with signal mask /ss/. If /use_path/ is true, /argv[0]/ is searched for in
+// /PATH/; otherwise, /path/ is executed.
+//
+// On success, returns /0/ and stores the PID of the child process into /*pid/. On failure, returns
+// an error number.
+static int do_spawn(
+    pid_t *pid,
+    const char *path,
+    bool use_path,
+    char *const *argv,
+    const sigset_t *ss)
+{
     posix_spawnattr_t attr;
     CANNOT_FAIL_PTH(posix_spawnattr_init(&attr));
-    CANNOT_FAIL_PTH(posix_spawnattr_setsigmask(&attr, &ss_old));
+    CANNOT_FAIL_PTH(posix_spawnattr_setsigmask(&attr, ss));
     CANNOT_FAIL_PTH(posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK));
 
-    char *const argv[] = {
-        (char *) "sh",
-        (char *) "-c",
-        (char *) cmd,
-        NULL,
-    };
-    pid_t pid;
-    int rc = posix_spawn(
-        /*pid=*/ &pid,
-        /*path=*/ "/bin/sh",
-        /*file_actions=*/ NULL,
-        /*attrp=*/ &attr,
-        /*argv=*/ argv,
-        /*envp=*/ environ);
+    int rc;
+    if (use_path) {
+        rc = posix_spawnp(pid, argv[0], /*file_actions=*/ NULL, &attr, argv, environ);
+    } else {
+        rc = posix_spawn(pid, path, /*file_actions=*/ NULL, &attr, argv, environ);
+    }
 
     CANNOT_FAIL_PTH(posix_spawnattr_destroy(&attr));
+    return rc;
+}
+
+// Does what /runshell()/ and /runshell_argv()/ do.
+static int run_sync(const char *path, bool use_path, char *const *argv)
+{
+    reap_orphans();
+
+    sigset_t ss_old;
+    block_sigchld(&ss_old);
+
+    pid_t pid;
+    int rc = do_spawn(&pid, path, use_path, argv, &ss_old);
 
     int ret;
     int saved_errno;
@@ -119,12 +196,86 @@ int runshell(const char *cmd)
         saved_errno = rc;
     }
 
-    CANNOT_FAIL(sigprocmask(SIG_SETMASK, &ss_old, NULL));
+    restore_sigmask(&ss_old);
 
     errno = saved_errno;
     return ret;
 }
 
+// Does what /runshell_spawn()/ and /runshell_spawn_argv()/ do.
+static pid_t run_async(const char *path, bool use_path, char *const *argv)
+{
+    reap_orphans();
+
+    sigset_t ss_old;
+    block_sigchld(&ss_old);
+
+    pid_t pid;
+    int rc = do_spawn(&pid, path, use_path, argv, &ss_old);
+
+    restore_sigmask(&ss_old);
+
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return pid;
+}
+
+int runshell(const char *cmd)
+{
+    char *buf[4];
+    return run_sync("/bin/sh", false, sh_argv(cmd, buf));
+}
+
+int runshell_argv(char *const *argv)
+{
+    return run_sync(NULL, true, argv);
+}
+
+pid_t runshell_spawn(const char *cmd)
+{
+    char *buf[4];
+    return run_async("/bin/sh", false, sh_argv(cmd, buf));
+}
+
+pid_t runshell_spawn_argv(char *const *argv)
+{
+    return run_async(NULL, true, argv);
+}
+
+int runshell_wait(pid_t pid)
+{
+    sigset_t ss_old;
+    block_sigchld(&ss_old);
+
+    int status;
+    int saved_errno = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            status = -1;
+            saved_errno = errno;
+            break;
+        }
+    }
+
+    restore_sigmask(&ss_old);
+
+    errno = saved_errno;
+    return status;
+}
+
+int runshell_poll(pid_t pid, int *status)
+{
+    pid_t r;
+    while ((r = waitpid(pid, status, WNOHANG)) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return r == 0 ? 0 : 1;
+}
+
 int runshell_l_os_execute_lua51ver(lua_State *L)
 {
     const char *cmd = luaL_optstring(L, 1, NULL);
@@ -137,15 +288,10 @@ int runshell_l_os_execute_lua51ver(lua_State *L)
     return 1;
 }
 
-int runshell_l_os_execute(lua_State *L)
+// Pushes the results of /os.execute()/ of Lua 5.2+ for a wait status /rc/ (or for an error, if /rc/
+// is negative) onto /L/'s stack; returns the number of values pushed.
+static int push_execute_results(lua_State *L, int rc)
 {
-    const char *cmd = luaL_optstring(L, 1, NULL);
-    // L: ?
-    if (!cmd) {
-        lua_pushboolean(L, 1); // L: ? true
-        return 1;
-    }
-    int rc = runshell(cmd);
     if (rc < 0) {
         int saved_errno = errno;
         my_pushfail(L); // L: ? fail
@@ -172,3 +318,149 @@ int runshell_l_os_execute(lua_State *L)
     lua_pushinteger(L, code); // L: ? is_ok what code
     return 3;
 }
+
+int runshell_l_os_execute(lua_State *L)
+{
+    const char *cmd = luaL_optstring(L, 1, NULL);
+    // L: ?
+    if (!cmd) {
+        lua_pushboolean(L, 1); // L: ? true
+        return 1;
+    }
+    return push_execute_results(L, runshell(cmd));
+}
+
+static size_t array_len(lua_State *L, int pos)
+{
+#if LUA_VERSION_NUM <= 501
+    return lua_objlen(L, pos);
+#else
+    return lua_rawlen(L, pos);
+#endif
+}
+
+// Checks that the argument at position /pos/ is a non-empty array of strings, and returns a
+// /NULL/-terminated array of them, allocated with /lua_newuserdata()/ (the userdata is left on the
+// top of the stack). The strings themselves are valid as long as the argument is.
+static char **check_argv(lua_State *L, int pos)
+{
+    luaL_checktype(L, pos, LUA_TTABLE);
+    size_t n = array_len(L, pos);
+    if (!n) {
+        luaL_argerror(L, pos, "argv is empty");
+    }
+    if (n > (((size_t) -1) / sizeof(char *)) - 1) {
+        luaL_argerror(L, pos, "argv is too long");
+    }
+    char **argv = lua_newuserdata(L, sizeof(char *) * (n + 1)); // L: ? ud
+    for (size_t i = 1; i <= n; ++i) {
+        lua_rawgeti(L, pos, i); // L: ? ud elem
+        if (lua_type(L, -1) != LUA_TSTRING) {
+            luaL_argerror(L, pos, "argv contains a non-string element");
+        }
+        argv[i - 1] = (char *) lua_tostring(L, -1);
+        lua_pop(L, 1); // L: ? ud
+    }
+    argv[n] = NULL;
+    return argv;
+}
+
+int runshell_l_execute(lua_State *L)
+{
+    if (lua_type(L, 1) == LUA_TTABLE) {
+        char **argv = check_argv(L, 1); // L: ? ud
+        return push_execute_results(L, runshell_argv(argv));
+    }
+    return runshell_l_os_execute(L);
+}
+
+#define HANDLE_MT_NAME "librunshell.Handle"
+
+typedef struct {
+    pid_t pid;
+    bool finished;
+    // Only meaningful if /finished/ is true.
+    int status;
+} Handle;
+
+static int l_handle_poll(lua_State *L)
+{
+    Handle *h = luaL_checkudata(L, 1, HANDLE_MT_NAME);
+    if (!h->finished) {
+        int r = runshell_poll(h->pid, &h->status);
+        if (r < 0) {
+            return push_execute_results(L, -1);
+        }
+        if (r == 0) {
+            lua_pushnil(L); // L: ? nil
+            return 1;
+        }
+        h->finished = true;
+    }
+    return push_execute_results(L, h->status);
+}
+
+static int l_handle_wait(lua_State *L)
+{
+    Handle *h = luaL_checkudata(L, 1, HANDLE_MT_NAME);
+    if (!h->finished) {
+        int status = runshell_wait(h->pid);
+        if (status < 0) {
+            return push_execute_results(L, -1);
+        }
+        h->finished = true;
+        h->status = status;
+    }
+    return push_execute_results(L, h->status);
+}
+
+static int l_handle_gc(lua_State *L)
+{
+    Handle *h = luaL_checkudata(L, 1, HANDLE_MT_NAME);
+    if (!h->finished) {
+        runshell_forget(h->pid);
+        h->finished = true;
+    }
+    return 0;
+}
+
+int runshell_l_spawn(lua_State *L)
+{
+    char **argv = NULL;
+    const char *command = NULL;
+    if (lua_type(L, 1) == LUA_TTABLE) {
+        argv = check_argv(L, 1); // L: ? ud
+    } else {
+        command = luaL_checkstring(L, 1);
+    }
+
+    // Create the handle before spawning the child, so that an error (e.g. a memory error) here does
+    // not leave behind a child that nobody is going to wait for.
+    Handle *h = lua_newuserdata(L, sizeof(Handle)); // L: ? handle
+    *h = (Handle) {.pid = -1, .finished = true};
+
+    if (luaL_newmetatable(L, HANDLE_MT_NAME)) {
+        // L: ? handle mt
+        lua_pushvalue(L, -1); // L: ? handle mt mt
+        lua_setfield(L, -2, "__index"); // L: ? handle mt
+
+        lua_pushcfunction(L, l_handle_poll); // L: ? handle mt f
+        lua_setfield(L, -2, "poll"); // L: ? handle mt
+
+        lua_pushcfunction(L, l_handle_wait); // L: ? handle mt f
+        lua_setfield(L, -2, "wait"); // L: ? handle mt
+
+        lua_pushcfunction(L, l_handle_gc); // L: ? handle mt f
+        lua_setfield(L, -2, "__gc"); // L: ? handle mt
+    }
+    // L: ? handle mt
+    lua_setmetatable(L, -2); // L: ? handle
+
+    pid_t pid = argv ? runshell_spawn_argv(argv) : runshell_spawn(command);
+    if (pid < 0) {
+        return push_execute_results(L, -1);
+    }
+    h->pid = pid;
+    h->finished = false;
+    return 1;
+}
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <lua.h>
+#include <sys/types.h>
 
 // This function is like /system()/, but:
 //
@@ -36,6 +37,45 @@
 //      /system()/, and, on musl, it is not thread-safe).
 int runshell(const char *cmd);
 
+// Like /runshell()/, but executes /argv[0]/ (searched for in /PATH/ if it does not contain a slash)
+// with arguments /argv/ directly, without the /sh -c/ hop. /argv/ must be /NULL/-terminated.
+int runshell_argv(char *const *argv);
+
+// Spawns /sh -c cmd/ without waiting for it to terminate.
+//
+// On success, returns the PID of the child process, which must then be passed to
+// /runshell_wait()/, to /runshell_poll()/ (until it reports termination), or to /runshell_forget()/.
+// On failure, returns /-1/ and sets /errno/.
+pid_t runshell_spawn(const char *cmd);
+
+// Like /runshell_spawn()/, but executes /argv/ as /runshell_argv()/ does.
+pid_t runshell_spawn_argv(char *const *argv);
+
+// Waits for the child process /pid/ to terminate.
+//
+// On success, returns its wait status (as /runshell()/ does). On failure, returns /-1/ and sets
+// /errno/.
+int runshell_wait(pid_t pid);
+
+// Checks, without blocking, if the child process /pid/ has terminated.
+//
+// If it has, stores its wait status into /*status/ and returns /1/. If it has not, returns /0/. On
+// failure, returns /-1/ and sets /errno/.
+int runshell_poll(pid_t pid, int *status);
+
+// Gives up on the child process /pid/: it will be reaped by one of the subsequent /runshell*()/
+// calls (except for /runshell_wait()/ and /runshell_poll()/) once it terminates, so that it does
+// not stay a zombie.
+void runshell_forget(pid_t pid);
+
 int runshell_l_os_execute(lua_State *L);
 
 int runshell_l_os_execute_lua51ver(lua_State *L);
+
+// Implementation of /luastatus.execute(cmd)/: like /os.execute()/ of Lua 5.2+, but /cmd/ may also
+// be an array of strings, which is then executed as /runshell_argv()/ does.
+int runshell_l_execute(lua_State *L);
+
+// Implementation of /luastatus.spawn(cmd)/: spawns /cmd/ (a string or an array of strings, as with
+// /luastatus.execute()/) and returns a handle with /poll()/ and /wait()/ methods.
+int runshell_l_spawn(lua_State *L);
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "evqueue.h"
+
+#include <lua.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "libls/ls_panic.h"
+#include "libls/ls_strarr.h"
+
+#include "lalloc.h"
+
+// Maximum nesting depth of tables copied by /evq_pop()/; deeper tables are replaced with nil.
+enum { COPY_DEPTH_LIMIT = 32 };
+
+void evq_init(
+        EventQueue *q,
+        lua_State *L,
+        lua_State *out,
+        bool coalesce,
+        LS_StringArray coalesce_keys)
+{
+    q->L = L;
+    q->out = out;
+    LS_PTH_CHECK(pthread_mutex_init(&q->mtx, NULL));
+    LS_PTH_CHECK(pthread_cond_init(&q->not_full, NULL));
+    q->size = 0;
+    q->coalesce = coalesce;
+    q->coalesce_keys = coalesce_keys;
+}
+
+lua_State *evq_push_begin(EventQueue *q)
+{
+    LS_PTH_CHECK(pthread_mutex_lock(&q->mtx));
+    if (!q->coalesce) {
+        while (q->size == EVQ_MAX) {
+            LS_PTH_CHECK(pthread_cond_wait(&q->not_full, &q->mtx));
+        }
+    }
+    // Provide the event watcher with the same amount of free stack slots as it would have if it
+    // were given a freshly created Lua interpreter instance.
+    if (!lua_checkstack(q->L, LUA_MINSTACK)) {
+        LS_PANIC("lua_checkstack() failed: out of memory?");
+    }
+    return q->L;
+}
+
+static size_t count_table_keys(lua_State *L, int t)
+{
+    size_t n = 0;
+    lua_pushnil(L); // L: ? nil
+    while (lua_next(L, t)) {
+        // L: ? key value
+        lua_pop(L, 1); // L: ? key
+        ++n;
+    }
+    // L: ?
+    return n;
+}
+
+// Checks if the values at (absolute) positions /a/ and /b/ of /q->L/'s stack are events of the same
+// kind.
+static bool same_kind(EventQueue *q, int a, int b)
+{
+    lua_State *L = q->L;
+
+    if (lua_type(L, a) != LUA_TTABLE || lua_type(L, b) != LUA_TTABLE) {
+        return lua_rawequal(L, a, b);
+    }
+
+    size_t nkeys = ls_strarr_size(q->coalesce_keys);
+    if (nkeys) {
+        for (size_t i = 0; i < nkeys; ++i) {
+            const char *key = ls_strarr_at(q->coalesce_keys, i, NULL);
+            lua_pushstring(L, key); // L: ? key
+            lua_rawget(L, a); // L: ? value_a
+            lua_pushstring(L, key); // L: ? value_a key
+            lua_rawget(L, b); // L: ? value_a value_b
+            bool eq = lua_rawequal(L, -1, -2);
+            lua_pop(L, 2); // L: ?
+            if (!eq) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t na = 0;
+    lua_pushnil(L); // L: ? nil
+    while (lua_next(L, a)) {
+        // L: ? key value_a
+        lua_pushvalue(L, -2); // L: ? key value_a key
+        lua_rawget(L, b); // L: ? key value_a value_b
+        bool eq = lua_rawequal(L, -1, -2);
+        lua_pop(L, 2); // L: ? key
+        if (!eq) {
+            lua_pop(L, 1); // L: ?
+            return false;
+        }
+        ++na;
+    }
+    // L: ?
+    return na == count_table_keys(L, b);
+}
+
+bool evq_push_end(EventQueue *q)
+{
+    lua_State *L = q->L;
+    bool r = true;
+
+    LS_ASSERT((size_t) lua_gettop(L) == q->size + 1);
+    // L: events... new_event
+
+    if (q->coalesce && q->size && same_kind(q, q->size, q->size + 1)) {
+        lua_pop(L, 1); // L: events...
+        ++q->counts[q->size - 1];
+    } else {
+        if (q->size == EVQ_MAX) {
+            // Only possible for a coalescing queue.
+            lua_remove(L, 1);
+            memmove(q->counts, q->counts + 1, sizeof(size_t) * (EVQ_MAX - 1));
+            --q->size;
+            r = false;
+        }
+        q->counts[q->size++] = 1;
+    }
+
+    LS_PTH_CHECK(pthread_mutex_unlock(&q->mtx));
+    return r;
+}
+
+void evq_push_cancel(EventQueue *q)
+{
+    lua_settop(q->L, q->size);
+    LS_PTH_CHECK(pthread_mutex_unlock(&q->mtx));
+}
+
+bool evq_is_empty(EventQueue *q)
+{
+    LS_PTH_CHECK(pthread_mutex_lock(&q->mtx));
+    bool r = q->size == 0;
+    LS_PTH_CHECK(pthread_mutex_unlock(&q->mtx));
+    return r;
+}
+
+// Pushes a copy of the value at (absolute) position /idx/ of /src/'s stack onto /dst/'s stack.
+static void copy_value(lua_State *src, int idx, lua_State *dst, int depth)
+{
+    switch (lua_type(src, idx)) {
+    case LUA_TBOOLEAN:
+        lua_pushboolean(dst, lua_toboolean(src, idx));
+        break;
+    case LUA_TNUMBER:
+#if LUA_VERSION_NUM >= 503
+        if (lua_isinteger(src, idx)) {
+            lua_pushinteger(dst, lua_tointeger(src, idx));
+            break;
+        }
+#endif
+        lua_pushnumber(dst, lua_tonumber(src, idx));
+        break;
+    case LUA_TSTRING:
+        {
+            size_t ns;
+            const char *s = lua_tolstring(src, idx, &ns);
+            lua_pushlstring(dst, s, ns);
+        }
+        break;
+    case LUA_TTABLE:
+        if (depth >= COPY_DEPTH_LIMIT ||
+            !lua_checkstack(src, 2) ||
+            !lua_checkstack(dst, 3))
+        {
+            lua_pushnil(dst);
+            break;
+        }
+        lua_newtable(dst); // dst: ? table
+        lua_pushnil(src); // src: ? nil
+        while (lua_next(src, idx)) {
+            // src: ? key value
+            int top = lua_gettop(src);
+            copy_value(src, top - 1, dst, depth + 1); // dst: ? table key
+            copy_value(src, top, dst, depth + 1); // dst: ? table key value
+            if (lua_isnil(dst, -2)) {
+                // The key could not be copied.
+                lua_pop(dst, 2); // dst: ? table
+            } else {
+                lua_rawset(dst, -3); // dst: ? table
+            }
+            lua_pop(src, 1); // src: ? key
+        }
+        // src: ?
+        break;
+    default:
+        lua_pushnil(dst);
+        break;
+    }
+}
+
+// Copies the event object held by the /out/ staging Lua interpreter instance of the queue passed as
+// a light user data onto /L/'s stack. Must be called in protected mode.
+static int l_copy_out(lua_State *L)
+{
+    EventQueue *q = lua_touserdata(L, 1);
+    copy_value(q->out, 1, L, 0);
+    return 1;
+}
+
+int evq_pop(EventQueue *q, lua_State *dst, size_t *count)
+{
+    LS_PTH_CHECK(pthread_mutex_lock(&q->mtx));
+
+    LS_ASSERT(q->size != 0);
+
+    // Neither of the staging Lua interpreter instances has a memory limit, so this can only fail
+    // on a genuine out-of-memory condition, which the event watcher would not survive either.
+    copy_value(q->L, 1, q->out, 0); // q->out: event
+    lua_remove(q->L, 1);
+
+    *count = q->counts[0];
+    memmove(q->counts, q->counts + 1, sizeof(size_t) * (q->size - 1));
+    if (q->size-- == EVQ_MAX) {
+        LS_PTH_CHECK(pthread_cond_signal(&q->not_full));
+    }
+
+    LS_PTH_CHECK(pthread_mutex_unlock(&q->mtx));
+
+    // /dst/, on the other hand, may have a memory limit; and it must not longjmp out of here with
+    // the queue locked anyway.
+    lua_pushcfunction(dst, l_copy_out); // dst: ? l_copy_out
+    lua_pushlightuserdata(dst, q); // dst: ? l_copy_out q
+    int ret = lua_pcall(dst, 1, 1, 0); // dst: ? result
+    lua_settop(q->out, 0); // q->out: (empty)
+    return ret;
+}
+
+void evq_destroy(EventQueue *q)
+{
+    lalloc_close(q->L);
+    lalloc_close(q->out);
+    LS_PTH_CHECK(pthread_cond_destroy(&q->not_full));
+    LS_PTH_CHECK(pthread_mutex_destroy(&q->mtx));
+    ls_strarr_destroy(q->coalesce_keys);
+}
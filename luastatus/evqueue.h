@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <lua.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "libls/ls_strarr.h"
+
+// Maximum number of (distinct) events an event queue can hold. Pushing an event onto a full queue
+// blocks until the consumer takes one, unless the queue is coalescing, in which case the oldest
+// event is dropped instead.
+enum { EVQ_MAX = 64 };
+
+// An event queue stores event objects generated by barlib's event watcher until they are taken by
+// a consumer. If /coalesce/ is true, consecutive events of the same "kind" (see /coalesce_keys/
+// below) are collapsed into one, with a counter.
+//
+// The event objects are stored on the stack of a *staging* Lua interpreter instance (with no
+// libraries loaded), so that barlib's event watcher is never blocked by the consumer; they are
+// then copied to the consumer's Lua interpreter instance with /evq_pop()/, by way of another,
+// consumer-owned, staging Lua interpreter instance, so that the consumer's one is never touched
+// with the queue locked.
+//
+// There may be only one producer and only one consumer.
+//
+// <!!!>
+// This structure must reside at a constant address throughout its whole life.
+// </!!!>
+typedef struct {
+    // The staging Lua interpreter instance. The /i/-th (zero-based) event object in the queue is
+    // located at position /i + 1/ of its stack.
+    lua_State *L;
+
+    // The consumer-owned staging Lua interpreter instance; holds the event object being popped.
+    // Only accessed by /evq_pop()/, without the lock.
+    lua_State *out;
+
+    // Guards everything else, except for /out/.
+    pthread_mutex_t mtx;
+
+    // Signalled whenever an event is taken from a full non-coalescing queue.
+    pthread_cond_t not_full;
+
+    // /counts[i]/ is the number of events that the /i/-th event object represents.
+    size_t counts[EVQ_MAX];
+    size_t size;
+
+    bool coalesce;
+
+    // If empty, two table events are of the same kind if they have the same set of keys with
+    // raw-equal values.
+    // Otherwise, two table events are of the same kind if values of each of these keys in them are
+    // raw-equal.
+    //
+    // Non-table events are of the same kind if they are raw-equal.
+    LS_StringArray coalesce_keys;
+} EventQueue;
+
+// Initializes /q/. Takes ownership of /L/ and /out/ (which should be Lua interpreter instances newly
+// created with /lalloc_newstate()/) and /coalesce_keys/ (each string in it must be zero-terminated).
+void evq_init(
+        EventQueue *q,
+        lua_State *L,
+        lua_State *out,
+        bool coalesce,
+        LS_StringArray coalesce_keys);
+
+// Begins pushing an event: locks the queue (first waiting until it is not full, if it is not a
+// coalescing one) and returns the staging Lua interpreter instance. The caller should then push
+// exactly one value onto its stack and call /evq_push_end()/, or call /evq_push_cancel()/.
+lua_State *evq_push_begin(EventQueue *q);
+
+// Finishes pushing an event and unlocks the queue.
+//
+// Returns /false/ if the (coalescing) queue was full and the oldest event has been dropped, /true/
+// otherwise.
+bool evq_push_end(EventQueue *q);
+
+// Cancels pushing an event and unlocks the queue.
+void evq_push_cancel(EventQueue *q);
+
+// Checks if the queue is empty. Locks and unlocks the queue.
+bool evq_is_empty(EventQueue *q);
+
+// Removes the oldest event from the queue, writes its counter into /*count/, and pushes a copy of it
+// onto /dst/'s stack. The queue must not be empty.
+//
+// Only nil, boolean, number, string and table values (with keys and values of these types, up to a
+// certain nesting depth) are copied; values of other types are replaced with nil.
+//
+// The copy onto /dst/'s stack is made in protected mode, without the queue locked. Returns the
+// result of /lua_pcall()/: if it is not zero, the error object has been pushed instead of the
+// copy, and the event is lost.
+int evq_pop(EventQueue *q, lua_State *dst, size_t *count);
+
+// Destroys /q/, including its staging Lua interpreter instance.
+void evq_destroy(EventQueue *q);
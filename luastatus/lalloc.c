@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lalloc.h"
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libls/ls_alloc_utils.h"
+
+// Blocks of up to /NCLASSES * GRANULE/ bytes are *small*: they are served from the free lists, the
+// /i/-th (zero-based) of which holds blocks of exactly /(i + 1) * GRANULE/ bytes. Larger blocks are
+// allocated with /malloc()/ directly.
+//
+// /GRANULE/ must be a multiple of the alignment /malloc()/ guarantees.
+enum { GRANULE = 16 };
+enum { NCLASSES = 16 };
+
+// Small blocks are carved out of chunks of this size. The first /GRANULE/ bytes of each chunk hold
+// a pointer to the next chunk.
+enum { CHUNK_SIZE = 16 * 1024 };
+
+typedef struct {
+    LAllocStats stats;
+
+    bool armed;
+
+    // /free_lists[i]/ is a singly linked list of free blocks of the /i/-th size class; the first
+    // bytes of each free block hold a pointer to the next one.
+    void *free_lists[NCLASSES];
+
+    // A singly linked list of all the chunks allocated.
+    char *chunks;
+
+    // The not yet carved part of the most recently allocated chunk.
+    char *cur;
+    size_t ncur;
+} LAlloc;
+
+static inline bool is_small(size_t n)
+{
+    return n <= NCLASSES * GRANULE;
+}
+
+// /n/ must be positive and small.
+static inline size_t class_of(size_t n)
+{
+    return (n - 1) / GRANULE;
+}
+
+static inline void push_free(LAlloc *a, void *p, size_t c)
+{
+    *(void **) p = a->free_lists[c];
+    a->free_lists[c] = p;
+}
+
+static void *small_alloc(LAlloc *a, size_t c)
+{
+    void *p = a->free_lists[c];
+    if (p) {
+        a->free_lists[c] = *(void **) p;
+        return p;
+    }
+
+    size_t n = (c + 1) * GRANULE;
+    if (a->ncur < n) {
+        // Put the remainder of the current chunk (which is a multiple of /GRANULE/, and thus is a
+        // block of some size class) onto a free list so that it does not go to waste.
+        if (a->ncur) {
+            push_free(a, a->cur, class_of(a->ncur));
+        }
+        char *chunk = ls_xmalloc(CHUNK_SIZE, 1);
+        *(char **) chunk = a->chunks;
+        a->chunks = chunk;
+        a->cur = chunk + GRANULE;
+        a->ncur = CHUNK_SIZE - GRANULE;
+    }
+    p = a->cur;
+    a->cur += n;
+    a->ncur -= n;
+    return p;
+}
+
+// /n/ must be positive.
+static inline void *block_alloc(LAlloc *a, size_t n)
+{
+    return is_small(n) ? small_alloc(a, class_of(n)) : malloc(n);
+}
+
+// /n/ must be positive.
+static inline void block_free(LAlloc *a, void *p, size_t n)
+{
+    if (is_small(n)) {
+        push_free(a, p, class_of(n));
+    } else {
+        free(p);
+    }
+}
+
+// Both /on/ and /nn/ must be positive.
+static void *block_realloc(LAlloc *a, void *p, size_t on, size_t nn)
+{
+    bool o_small = is_small(on);
+    bool n_small = is_small(nn);
+
+    if (o_small && n_small && class_of(on) == class_of(nn)) {
+        return p;
+    }
+    if (!o_small && !n_small) {
+        return realloc(p, nn);
+    }
+
+    void *r = block_alloc(a, nn);
+    if (!r) {
+        return NULL;
+    }
+    memcpy(r, p, on < nn ? on : nn);
+    block_free(a, p, on);
+    return r;
+}
+
+static void *alloc_func(void *ud, void *ptr, size_t osize, size_t nsize)
+{
+    LAlloc *a = ud;
+    LAllocStats *s = &a->stats;
+
+    if (!ptr) {
+        // Lua 5.4 passes the type of the object being allocated in /osize/ in this case.
+        osize = 0;
+    }
+
+    if (!nsize) {
+        if (ptr) {
+            block_free(a, ptr, osize);
+            s->nbytes -= osize;
+        }
+        return NULL;
+    }
+
+    size_t new_nbytes = s->nbytes - osize + nsize;
+    if (a->armed && s->limit && nsize > osize && new_nbytes > s->limit) {
+        ++s->nrefused;
+        return NULL;
+    }
+
+    void *r = ptr ? block_realloc(a, ptr, osize, nsize) : block_alloc(a, nsize);
+    if (!r) {
+        return NULL;
+    }
+    s->nbytes = new_nbytes;
+    if (s->peak < new_nbytes) {
+        s->peak = new_nbytes;
+    }
+    return r;
+}
+
+static void lalloc_destroy(LAlloc *a)
+{
+    for (char *chunk = a->chunks; chunk;) {
+        char *next = *(char **) chunk;
+        free(chunk);
+        chunk = next;
+    }
+    free(a);
+}
+
+static LAlloc *get_lalloc(lua_State *L)
+{
+    void *ud;
+    lua_Alloc f = lua_getallocf(L, &ud);
+    return f == alloc_func ? ud : NULL;
+}
+
+lua_State *lalloc_newstate(void)
+{
+    LAlloc *a = LS_XNEW0(LAlloc, 1);
+    lua_State *L = lua_newstate(alloc_func, a);
+    if (L) {
+        return L;
+    }
+    lalloc_destroy(a);
+    return luaL_newstate();
+}
+
+bool lalloc_set_limit(lua_State *L, size_t limit)
+{
+    LAlloc *a = get_lalloc(L);
+    if (!a) {
+        return false;
+    }
+    a->stats.limit = limit;
+    return true;
+}
+
+void lalloc_arm(lua_State *L, bool armed)
+{
+    LAlloc *a = get_lalloc(L);
+    if (a) {
+        a->armed = armed;
+    }
+}
+
+bool lalloc_stats(lua_State *L, LAllocStats *out)
+{
+    LAlloc *a = get_lalloc(L);
+    if (!a) {
+        return false;
+    }
+    *out = a->stats;
+    return true;
+}
+
+void lalloc_close(lua_State *L)
+{
+    LAlloc *a = get_lalloc(L);
+    lua_close(L);
+    if (a) {
+        lalloc_destroy(a);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <lua.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// An accounting allocator for Lua interpreter instances.
+//
+// Each Lua interpreter instance created with /lalloc_newstate()/ gets its own allocator, which:
+//   * serves small blocks from per-size-class free lists carved out of larger chunks (Lua
+//     allocates lots of small strings, tables and closures of a handful of distinct sizes);
+//   * keeps track of the number of bytes currently allocated, and of its peak value;
+//   * optionally refuses to grow past a hard limit, which Lua reports as a memory error.
+//
+// The allocator of a given Lua interpreter instance is only ever called by the thread that holds
+// (the mutex guarding) that instance, so there is no locking inside.
+
+typedef struct {
+    // Number of bytes currently allocated.
+    size_t nbytes;
+
+    // Maximum value /nbytes/ has ever had.
+    size_t peak;
+
+    // The hard limit, or /0/ if there is none.
+    size_t limit;
+
+    // Number of allocations refused because of the limit.
+    size_t nrefused;
+} LAllocStats;
+
+// Creates a new Lua interpreter instance with an accounting allocator.
+//
+// Some Lua implementations (namely, LuaJIT on 64-bit platforms without GC64 mode) do not support
+// custom allocators; in that case, falls back to /luaL_newstate()/, and the functions below will
+// treat the instance as one without an accounting allocator.
+//
+// Returns /NULL/ on failure.
+lua_State *lalloc_newstate(void);
+
+// Sets the hard limit (/0/ means no limit) for /L/. The limit is only enforced while the allocator
+// is *armed* (see /lalloc_arm()/).
+//
+// Returns /false/ if /L/ does not have an accounting allocator.
+bool lalloc_set_limit(lua_State *L, size_t limit);
+
+// Arms or disarms the limit for /L/. It must only be armed while running Lua code in protected
+// mode: a memory error raised outside of it would call the panic function.
+//
+// Does nothing if /L/ does not have an accounting allocator.
+void lalloc_arm(lua_State *L, bool armed);
+
+// Fills /*out/ with statistics of /L/'s allocator.
+//
+// Returns /false/ if /L/ does not have an accounting allocator.
+bool lalloc_stats(lua_State *L, LAllocStats *out);
+
+// Closes /L/ (with /lua_close()/), and destroys its allocator, if any.
+void lalloc_close(lua_State *L);
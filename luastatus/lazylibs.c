@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lazylibs.h"
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "libls/ls_algo.h"
+
+typedef void Fixup(lua_State *L, const char *name);
+
+// With LuaJIT, whose libraries depend on each other in ways we do not want to deal with, and with
+// Lua 5.1, which ignores the "__pairs" metamethod of the stubs, all the libraries are opened right
+// away.
+#if defined(LUA_JITLIBNAME) || LUA_VERSION_NUM < 502
+# define LAZY 0
+#else
+# define LAZY 1
+#endif
+
+typedef struct {
+    const char *name;
+    lua_CFunction open;
+} Lib;
+
+#if LAZY
+
+static const Lib eager_libs[] = {
+    {"_G",            luaopen_base},
+    {LUA_LOADLIBNAME, luaopen_package},
+    {LUA_STRLIBNAME,  luaopen_string},
+};
+
+static const Lib lazy_libs[] = {
+    {LUA_COLIBNAME,   luaopen_coroutine},
+    {LUA_TABLIBNAME,  luaopen_table},
+    {LUA_IOLIBNAME,   luaopen_io},
+    {LUA_OSLIBNAME,   luaopen_os},
+    {LUA_MATHLIBNAME, luaopen_math},
+    {LUA_DBLIBNAME,   luaopen_debug},
+#ifdef LUA_UTF8LIBNAME
+    {LUA_UTF8LIBNAME, luaopen_utf8},
+#endif
+#if LUA_VERSION_NUM == 502 || (LUA_VERSION_NUM == 503 && defined(LUA_COMPAT_BITLIB))
+    {LUA_BITLIBNAME,  luaopen_bit32},
+#endif
+};
+
+// Turns the stub at (absolute) position /pos/ into the library table. Expects the upvalues of the
+// metamethods: a light userdata pointing to the /Lib/, and a full userdata holding a /Fixup */.
+//
+// The metatable of the stub is only removed once the library has been opened and its fields have
+// been copied, so that if the opener throws an error (e.g. because of the memory limit), the next
+// access to the stub tries again instead of finding an empty table.
+static void materialize(lua_State *L, int pos)
+{
+    if (!lua_getmetatable(L, pos)) {
+        // Already materialized.
+        return;
+    }
+    lua_pop(L, 1); // L: ?
+
+    const Lib *lib = lua_touserdata(L, lua_upvalueindex(1));
+    Fixup *fixup = *(Fixup **) lua_touserdata(L, lua_upvalueindex(2));
+
+    // We can not use /luaL_requiref()/ here: it would find the stub in /package.loaded/ and return
+    // it. The openers themselves do not touch the global variable or /package.loaded/.
+    lua_pushcfunction(L, lib->open); // L: ? opener
+    lua_pushstring(L, lib->name); // L: ? opener name
+    lua_call(L, 1, 1); // L: ? lib
+
+    lua_pushnil(L); // L: ? lib nil
+    while (lua_next(L, -2)) {
+        // L: ? lib key value
+        lua_pushvalue(L, -2); // L: ? lib key value key
+        lua_insert(L, -2); // L: ? lib key key value
+        lua_rawset(L, pos); // L: ? lib key
+    }
+    // L: ? lib
+    lua_pop(L, 1); // L: ?
+
+    lua_pushnil(L); // L: ? nil
+    lua_setmetatable(L, pos); // L: ?
+
+    if (fixup) {
+        lua_pushvalue(L, pos); // L: ? stub
+        fixup(L, lib->name); // L: ? stub
+        lua_pop(L, 1); // L: ?
+    }
+}
+
+static int l_stub_index(lua_State *L)
+{
+    // L: stub key
+    materialize(L, 1);
+    lua_settop(L, 2); // L: stub key
+    lua_rawget(L, 1); // L: stub value
+    return 1;
+}
+
+static int l_stub_newindex(lua_State *L)
+{
+    // L: stub key value
+    materialize(L, 1);
+    lua_settop(L, 3); // L: stub key value
+    lua_rawset(L, 1); // L: stub
+    return 0;
+}
+
+static int l_stub_pairs(lua_State *L)
+{
+    // L: stub
+    materialize(L, 1);
+    lua_getglobal(L, "next"); // L: stub next
+    lua_pushvalue(L, 1); // L: stub next stub
+    lua_pushnil(L); // L: stub next stub nil
+    return 3;
+}
+
+// Expects the userdata holding /Fixup */ on top of the stack; does not change the stack.
+static void push_stub_metamethod(lua_State *L, const Lib *lib, lua_CFunction f)
+{
+    // L: ? fixup_ud
+    lua_pushlightuserdata(L, (void *) lib); // L: ? fixup_ud lib
+    lua_pushvalue(L, -2); // L: ? fixup_ud lib fixup_ud
+    lua_pushcclosure(L, f, 2); // L: ? fixup_ud closure
+}
+
+void lazylibs_open(lua_State *L, Fixup *fixup)
+{
+    for (size_t i = 0; i < LS_ARRAY_SIZE(eager_libs); ++i) {
+        luaL_requiref(L, eager_libs[i].name, eager_libs[i].open, 1); // L: ? lib
+        if (fixup) {
+            fixup(L, eager_libs[i].name);
+        }
+        lua_pop(L, 1); // L: ?
+    }
+
+    *(Fixup **) lua_newuserdata(L, sizeof(Fixup *)) = fixup; // L: ? fixup_ud
+
+    lua_getfield(L, LUA_REGISTRYINDEX, "_LOADED"); // L: ? fixup_ud loaded
+    lua_insert(L, -2); // L: ? loaded fixup_ud
+
+    for (size_t i = 0; i < LS_ARRAY_SIZE(lazy_libs); ++i) {
+        const Lib *lib = &lazy_libs[i];
+
+        lua_newtable(L); // L: ? loaded fixup_ud stub
+        lua_insert(L, -2); // L: ? loaded stub fixup_ud
+
+        lua_createtable(L, 0, 3); // L: ? loaded stub fixup_ud mt
+        lua_insert(L, -2); // L: ? loaded stub mt fixup_ud
+
+        push_stub_metamethod(L, lib, l_stub_index); // L: ? loaded stub mt fixup_ud f
+        lua_setfield(L, -3, "__index"); // L: ? loaded stub mt fixup_ud
+
+        push_stub_metamethod(L, lib, l_stub_newindex); // L: ? loaded stub mt fixup_ud f
+        lua_setfield(L, -3, "__newindex"); // L: ? loaded stub mt fixup_ud
+
+        push_stub_metamethod(L, lib, l_stub_pairs); // L: ? loaded stub mt fixup_ud f
+        lua_setfield(L, -3, "__pairs"); // L: ? loaded stub mt fixup_ud
+
+        lua_insert(L, -3); // L: ? loaded fixup_ud stub mt
+        lua_setmetatable(L, -2); // L: ? loaded fixup_ud stub
+
+        lua_pushvalue(L, -1); // L: ? loaded fixup_ud stub stub
+        lua_setglobal(L, lib->name); // L: ? loaded fixup_ud stub
+        lua_setfield(L, -3, lib->name); // L: ? loaded fixup_ud
+    }
+
+    lua_pop(L, 2); // L: ?
+}
+
+#else
+
+static const char *const lib_names[] = {
+    LUA_COLIBNAME,
+    LUA_TABLIBNAME,
+    LUA_IOLIBNAME,
+    LUA_OSLIBNAME,
+    LUA_STRLIBNAME,
+    LUA_MATHLIBNAME,
+    LUA_DBLIBNAME,
+    LUA_LOADLIBNAME,
+#ifdef LUA_BITLIBNAME
+    LUA_BITLIBNAME,
+#endif
+#ifdef LUA_JITLIBNAME
+    LUA_JITLIBNAME,
+#endif
+};
+
+void lazylibs_open(lua_State *L, Fixup *fixup)
+{
+    luaL_openlibs(L);
+    if (fixup) {
+        for (size_t i = 0; i < LS_ARRAY_SIZE(lib_names); ++i) {
+            lua_getglobal(L, lib_names[i]); // L: ? lib
+            if (lua_istable(L, -1)) {
+                fixup(L, lib_names[i]);
+            }
+            lua_pop(L, 1); // L: ?
+        }
+    }
+}
+
+#endif
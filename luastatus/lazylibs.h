@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <lua.h>
+
+// Opens the standard Lua libraries in /L/, as /luaL_openlibs()/ does, except that most of them are
+// opened *lazily*.
+//
+// The base, package and string libraries are opened right away (the latter because it is also the
+// "__index" of the strings' metatable). Each of the other ones is, instead, represented by an empty
+// *stub* table, which is assigned to the corresponding global variable and to the corresponding
+// entry of /package.loaded/. The stub has a metatable with "__index", "__newindex" and "__pairs"
+// metamethods which, the first time any of them is invoked, open the library, copy its fields into
+// the stub, and remove the metatable, so that the stub becomes the library table itself.
+//
+// If /fixup/ is not /NULL/, it is called right after each library (including the ones opened right
+// away) is opened, with the library table on top of /L/'s stack. It must not change the stack.
+//
+// With LuaJIT, whose libraries depend on each other in ways we do not want to deal with, and with
+// Lua 5.1, which does not support the "__pairs" metamethod, just calls /luaL_openlibs()/ and then
+// /fixup/ on each global library table.
+void lazylibs_open(lua_State *L, void (*fixup)(lua_State *L, const char *name));
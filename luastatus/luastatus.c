@@ -23,6 +23,9 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
 #include <string.h>
 #include <stdbool.h>
 #include <signal.h>
@@ -40,7 +43,11 @@
 #include "libls/ls_algo.h"
 #include "libls/ls_panic.h"
 #include "libls/ls_xallocf.h"
+#include "libls/ls_string.h"
+#include "libls/ls_chunk_cache.h"
 #include "libls/ls_lua_compat.h"
+#include "libls/ls_strarr.h"
+#include "libls/ls_parse_int.h"
 
 #include "libwidechar/libwidechar.h"
 #include "librunshell/runshell.h"
@@ -48,6 +55,9 @@
 
 #include "config.generated.h"
 #include "comm.h"
+#include "evqueue.h"
+#include "lalloc.h"
+#include "lazylibs.h"
 
 // Logging macros.
 #define FATALF(...)    sayf(LUASTATUS_LOG_FATAL,    __VA_ARGS__)
@@ -70,8 +80,10 @@
 #define UNLOCK_E(W_) LS_PTH_CHECK(pthread_mutex_unlock(widget_event_L_mtx(W_)))
 
 typedef struct {
-    // The interface loaded from this plugin's .so file.
-    LuastatusPluginIface_v1 iface;
+    // The interface loaded from this plugin's .so file. For a plugin that only provides the first
+    // version of the interface, /iface.run/ is /NULL/, and /run_v1/ is set instead.
+    LuastatusPluginIface_v2 iface;
+    void (*run_v1)(LuastatusPluginData_v1 *pd, LuastatusPluginRunFuncs_v1 funcs);
 
     // An allocated zero-terminated string with plugin name, as specified in widget's
     // /widget.plugin/ string.
@@ -127,16 +139,39 @@ typedef struct {
     // Normal:
     //   if /sepstate_event/ is false, Lua reference (in /L/'s registry) to this widget's
     //     /widget.event/ function (is /LUA_REFNIL/ if the latter is /nil/);
-    //   if /sepstate_event/ is true, Lua reference (in /sepstate.L/'s registry) to the compiled
-    //      /widget.event/ function of this widget.
+    //   if /sepstate_event/ is true, Lua reference (in /own_sepstate_L/'s registry if it is not
+    //      /NULL/, in /sepstate.L/'s otherwise) to the compiled /widget.event/ function of this
+    //      widget.
     // Stillborn: /LUA_REFNIL/.
     int lref_event;
 
-    // Normal: whether /lref_event/ is a reference in /sepstate.L/'s registry, as opposed to
+    // Normal: whether /lref_event/ is a reference in a separate state's registry, as opposed to
     // /L/'s one.
     // Stillborn: /true/.
     bool sepstate_event;
 
+    // Normal: if /sepstate_event/ is true and the event pool is enabled with /-j/, this widget's
+    //   own separate state (so that string-typed /widget.event/ functions of different widgets can
+    //   run in parallel); otherwise, /NULL/.
+    // Stillborn: /NULL/.
+    lua_State *own_sepstate_L;
+
+    // Normal: if /own_sepstate_L/ is not /NULL/, a mutex guarding it.
+    // Stillborn: undefined.
+    pthread_mutex_t own_sepstate_L_mtx;
+
+    // Normal: if /widget.event/ is not /nil/, and either /widget.coalesce_events/ is set or the
+    //   event pool is enabled with /-j/, an event queue that /ew_call_begin/ and /ew_call_end/
+    //   functions push this widget's events onto, and the event pool takes them from; otherwise,
+    //   /NULL/.
+    // Stillborn: /NULL/.
+    EventQueue *evq;
+
+    // Normal: if /evq/ is not /NULL/, whether this widget is *scheduled* in the event pool (see
+    //   below). Guarded by /evpool.mtx/.
+    // Stillborn: undefined.
+    bool evq_scheduled;
+
     // Normal: an allocated zero-terminated string with widget's file name.
     // Stillborn: undefined.
     char *filename;
@@ -144,6 +179,15 @@ typedef struct {
     // Normal: a /Comm/ instance for /luastatus.communicate()/ function.
     // Stillborn: undefined.
     Comm comm;
+
+    // Normal: the value of /widget.gc.idle_step/, or /0/ if it is not set.
+    // Stillborn: undefined.
+    int gc_idle_step;
+
+    // Normal: whether /cb/ has been called since the last garbage collection cycle completed by
+    //   /plugin_call_idle()/. Guarded by /L_mtx/.
+    // Stillborn: undefined.
+    bool gc_idle_pending;
 } Widget;
 
 static const char *loglevel_names[] = {
@@ -159,6 +203,10 @@ static const char *loglevel_names[] = {
 // Current log level. May only be changed once, when parsing command-line arguments.
 static int loglevel = LUASTATUS_LOG_INFO;
 
+// Number of event pool threads specified with /-j/, or /0/ if it was not specified. May only be
+// changed once, when parsing command-line arguments.
+static int evpool_nthreads_opt = 0;
+
 static struct {
     // The interface loaded from this barlib's .so file.
     LuastatusBarlibIface_v1 iface;
@@ -199,6 +247,56 @@ static struct {
     Widget *cur_w;
 } sepstate = {.L = NULL};
 
+// Guards the initialization of /sepstate/, which may happen in any of the threads initializing the
+// widgets (see /widgets_init()/).
+static pthread_mutex_t sepstate_init_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+// If the /-p/ option is passed, widgets are initialized in parallel (see /widgets_init()/), but
+// calls to plugins' /init()/ are serialized with this mutex: plugins are allowed to call /map_get()/, which is not thread-safe, from
+// /init()/, and to assume no other /init()/ is running meanwhile (see DOCS/design/map_get.md).
+static pthread_mutex_t plugin_init_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+// Whether the /-p/ option was passed.
+static bool parallel_init = false;
+
+// Maximum number of threads initializing the widgets. Initialization is mostly spent waiting for
+// files, dynamic libraries and programs spawned by widget files, so this is not tied to the number
+// of CPUs.
+enum { INIT_MAX_THREADS = 16 };
+
+// If not /NULL/, log messages of the current thread are appended to this string instead of being
+// written to stderr. Used by /widgets_init()/ to output the messages of each widget's
+// initialization as a whole, without interleaving them with messages of other widgets.
+static __thread LS_String *tls_log_buf = NULL;
+
+// The event pool is a fixed set of threads that take events from widgets' event queues (see the
+// /evq/ field of /Widget/) and call /widget.event/ functions with them. It is only started if there
+// is at least one widget with an event queue.
+//
+// A widget is *scheduled* if it is either in the /ready/ list, or an event of it is being processed
+// by one of the threads. A widget is never scheduled twice, so events of any given widget are
+// processed one at a time, in order; but events of different widgets are processed in parallel.
+static struct {
+    // Guards /ready*/ and /closed/ fields, as well as /evq_scheduled/ fields of the widgets.
+    pthread_mutex_t mtx;
+
+    // Signalled whenever a widget is appended to /ready/, or /closed/ is set.
+    pthread_cond_t cond;
+
+    // A FIFO ring buffer of scheduled widgets none of which events are being processed; its
+    // capacity is /nwidgets/.
+    Widget **ready;
+    size_t ready_head;
+    size_t ready_size;
+
+    // Whether the threads should exit once there are no scheduled widgets left.
+    bool closed;
+
+    // Initially is (explicitly) set to /NULL/, which indicates that the event pool was not started.
+    pthread_t *threads;
+    size_t nthreads;
+} evpool = {.threads = NULL};
+
 // See DOCS/design/map_get.md
 //
 // Basically, it is a string-to-pointer mapping used by plugins and barlibs for synchronization.
@@ -246,6 +344,16 @@ static void common_vsayf(int level, const char *subsystem, const char *fmt, va_l
         buf[0] = '\0';
     }
 
+    if (tls_log_buf) {
+        if (subsystem) {
+            ls_string_append_f(
+                tls_log_buf, "luastatus: (%s) %s: %s\n", subsystem, loglevel_names[level], buf);
+        } else {
+            ls_string_append_f(tls_log_buf, "luastatus: %s: %s\n", loglevel_names[level], buf);
+        }
+        return;
+    }
+
     if (subsystem) {
         fprintf(stderr, "luastatus: (%s) %s: %s\n", subsystem, loglevel_names[level], buf);
     } else {
@@ -416,12 +524,24 @@ static bool plugin_load(Plugin *p, const char *filename, const char *name)
              filename, *p_lua_ver, LUA_VERSION_NUM);
         goto error;
     }
-    LuastatusPluginIface_v1 *p_iface = dlsym(p->dlhandle, "luastatus_plugin_iface_v1");
-    if (!p_iface) {
-        ERRF("dlsym: luastatus_plugin_iface_v1: %s", safe_dlerror());
-        goto error;
+    LuastatusPluginIface_v2 *p_iface_v2 = dlsym(p->dlhandle, "luastatus_plugin_iface_v2");
+    if (p_iface_v2) {
+        p->iface = *p_iface_v2;
+        p->run_v1 = NULL;
+    } else {
+        LuastatusPluginIface_v1 *p_iface = dlsym(p->dlhandle, "luastatus_plugin_iface_v1");
+        if (!p_iface) {
+            ERRF("dlsym: luastatus_plugin_iface_v1: %s", safe_dlerror());
+            goto error;
+        }
+        p->iface = (LuastatusPluginIface_v2) {
+            .init = p_iface->init,
+            .register_funcs = p_iface->register_funcs,
+            .run = NULL,
+            .destroy = p_iface->destroy,
+        };
+        p->run_v1 = p_iface->run;
     }
-    p->iface = *p_iface;
     DEBUGF("plugin successfully loaded");
     return true;
 
@@ -453,9 +573,11 @@ static void plugin_unload(Plugin *p)
 
 static lua_State *xnew_lua_state(void)
 {
-    lua_State *L = luaL_newstate();
+    lua_State *L = lalloc_newstate();
     if (!L) {
-        FATALF("luaL_newstate() failed: out of memory?");
+        // Do not buffer this message, as we are not going to return.
+        tls_log_buf = NULL;
+        FATALF("lalloc_newstate() failed: out of memory?");
         abort();
     }
     return L;
@@ -521,10 +643,15 @@ static int l_error_handler(lua_State *L)
 // Similar to /lua_call/, but expects an error handler to be at the bottom of /L/'s stack, runs the
 // chunk with that error handler, and logs the error message, if any.
 //
+// The memory limit of /L/, if any, is only enforced inside this function.
+//
 // Returns /true/ on success, /false/ on failure.
 static inline bool do_lua_call(lua_State *L, int nargs, int nresults)
 {
-    return check_lua_call(L, lua_pcall(L, nargs, nresults, 1));
+    lalloc_arm(L, true);
+    int ret = lua_pcall(L, nargs, nresults, 1);
+    lalloc_arm(L, false);
+    return check_lua_call(L, ret);
 }
 
 // Replacement for Lua's /os.exit()/: a simple /exit()/ used by Lua is not thread-safe in Linux.
@@ -572,7 +699,7 @@ static int l_require_plugin(lua_State *L)
     lua_pop(L, 1); // L: ? table
 
     char *filename = ls_xallocf("%s/%s.lua", LUASTATUS_LUA_PLUGINS_DIR, arg);
-    int r = luaL_loadfile(L, filename);
+    int r = ls_chunk_cache_loadfile(L, filename);
     free(filename);
     if (r != 0) {
         return lua_error(L);
@@ -636,35 +763,64 @@ static int l_communicate(lua_State *L)
     }
 }
 
-static void inject_libs_replacements(lua_State *L)
+// Implementation of /luastatus.memory_usage()/.
+static int l_memory_usage(lua_State *L)
 {
-    // L: ?
-    liblrand_inject(L); // L: ?
+    LAllocStats s;
+    if (!lalloc_stats(L, &s)) {
+        ls_lua_pushfail(L);
+        return 1;
+    }
+    lua_createtable(L, 0, 4); // L: ? table
 
-    lua_getglobal(L, "os"); // L: ? os
+    lua_pushinteger(L, s.nbytes); // L: ? table bytes
+    lua_setfield(L, -2, "bytes"); // L: ? table
 
-    lua_pushcfunction(L, l_os_exit); // L: ? os l_os_exit
-    lua_setfield(L, -2, "exit"); // L: ? os
+    lua_pushinteger(L, s.peak); // L: ? table peak
+    lua_setfield(L, -2, "peak"); // L: ? table
 
-    lua_pushcfunction(L, l_os_getenv); // L: ? os l_os_getenv
-    lua_setfield(L, -2, "getenv"); // L: ? os
+    if (s.limit) {
+        lua_pushinteger(L, s.limit); // L: ? table limit
+        lua_setfield(L, -2, "limit"); // L: ? table
+    }
 
-    lua_pushcfunction(L, l_os_setlocale); // L: ? os l_os_setlocale
-    lua_setfield(L, -2, "setlocale"); // L: ? os
+    lua_pushinteger(L, s.nrefused); // L: ? table refused
+    lua_setfield(L, -2, "refused"); // L: ? table
+    return 1;
+}
 
-    bool is_lua51 = ls_lua_is_lua51(L);
-    lua_pushcfunction(
-        L,
-        is_lua51 ? runshell_l_os_execute_lua51ver : runshell_l_os_execute);
-    // L: ? os os_execute_func
-    lua_setfield(L, -2, "execute"); // L: ? os
+// Passed to /lazylibs_open()/ as /fixup/: replaces some of the functions in the standard library
+// with our thread-safe counterparts.
+static void fixup_lib(lua_State *L, const char *name)
+{
+    // L: ? lib
+    if (strcmp(name, LUA_MATHLIBNAME) == 0) {
+        // /liblrand_inject()/ looks up the /math/ global, which, at this point, is the library
+        // table.
+        liblrand_inject(L); // L: ? lib
 
-    lua_pop(L, 1); // L: ?
+    } else if (strcmp(name, LUA_OSLIBNAME) == 0) {
+        lua_pushcfunction(L, l_os_exit); // L: ? os l_os_exit
+        lua_setfield(L, -2, "exit"); // L: ? os
+
+        lua_pushcfunction(L, l_os_getenv); // L: ? os l_os_getenv
+        lua_setfield(L, -2, "getenv"); // L: ? os
+
+        lua_pushcfunction(L, l_os_setlocale); // L: ? os l_os_setlocale
+        lua_setfield(L, -2, "setlocale"); // L: ? os
+
+        bool is_lua51 = ls_lua_is_lua51(L);
+        lua_pushcfunction(
+            L,
+            is_lua51 ? runshell_l_os_execute_lua51ver : runshell_l_os_execute);
+        // L: ? os os_execute_func
+        lua_setfield(L, -2, "execute"); // L: ? os
+    }
 }
 
 static void inject_luastatus_module(lua_State *L, Widget *w)
 {
-    lua_createtable(L, 0, 4); // L: ? table
+    lua_createtable(L, 0, 6); // L: ? table
 
     // ========== require_plugin ==========
     lua_newtable(L); // L: ? table table
@@ -672,9 +828,13 @@ static void inject_luastatus_module(lua_State *L, Widget *w)
     lua_setfield(L, -2, "require_plugin"); // L: ? table
 
     // ========== execute ==========
-    lua_pushcfunction(L, runshell_l_os_execute); // L: ? table cfunction
+    lua_pushcfunction(L, runshell_l_execute); // L: ? table cfunction
     lua_setfield(L, -2, "execute"); // L: ? table
 
+    // ========== spawn ==========
+    lua_pushcfunction(L, runshell_l_spawn); // L: ? table cfunction
+    lua_setfield(L, -2, "spawn"); // L: ? table
+
     // ========== libwidechar ==========
     lua_newtable(L); // L: ? table table
     libwidechar_register_lua_funcs(L); // L: ? table table
@@ -685,29 +845,48 @@ static void inject_luastatus_module(lua_State *L, Widget *w)
     lua_pushcclosure(L, l_communicate, 1); // L: ? table userdata
     lua_setfield(L, -2, "communicate"); // L: ? table
 
+    // ========== memory_usage ==========
+    lua_pushcfunction(L, l_memory_usage); // L: ? table cfunction
+    lua_setfield(L, -2, "memory_usage"); // L: ? table
+
     lua_setglobal(L, "luastatus"); // L: ?
 }
 
-// 1. Replaces some of the functions in the standard library with our thread-safe counterparts.
+// 1. Opens the standard libraries (most of them lazily, see /lazylibs.h/), replacing some of the
+//    functions in them with our thread-safe counterparts.
 // 2. Registers the /luastatus/ module (just creates a global table actually) except for the
 //    /luastatus.plugin/ and /luastatus.barlib/ submodules (created later).
 static void inject_libs(lua_State *L, Widget *w)
 {
-    inject_libs_replacements(L);
+    lazylibs_open(L, fixup_lib);
     inject_luastatus_module(L, w);
 }
 
+// Creates a new Lua interpreter instance for a separate state. If /w/ is not /NULL/, the state is
+// owned by /w/; otherwise, it is the shared one (/sepstate.L/).
+static lua_State *xnew_sepstate_lua_state(Widget *w)
+{
+    lua_State *L = xnew_lua_state();
+    inject_libs(L, w);
+
+    LAllocStats s;
+    if (lalloc_stats(L, &s)) {
+        DEBUGF("separate state of %s%s%s: baseline Lua memory: %zu bytes",
+               w ? "widget '" : "", w ? w->filename : "shared", w ? "'" : "", s.nbytes);
+    }
+
+    lua_pushcfunction(L, l_error_handler); // L: l_error_handler
+    return L;
+}
+
 static void sepstate_maybe_init(void)
 {
-    if (sepstate.L) {
-        // already initialized
-        return;
+    LS_PTH_CHECK(pthread_mutex_lock(&sepstate_init_mtx));
+    if (!sepstate.L) {
+        sepstate.L = xnew_sepstate_lua_state(NULL);
+        LS_PTH_CHECK(pthread_mutex_init(&sepstate.L_mtx, NULL));
     }
-    sepstate.L = xnew_lua_state();
-    luaL_openlibs(sepstate.L);
-    inject_libs(sepstate.L, NULL);
-    lua_pushcfunction(sepstate.L, l_error_handler); // sepstate.L: l_error_handler
-    LS_PTH_CHECK(pthread_mutex_init(&sepstate.L_mtx, NULL));
+    LS_PTH_CHECK(pthread_mutex_unlock(&sepstate_init_mtx));
 }
 
 static void sepstate_maybe_destroy(void)
@@ -716,7 +895,7 @@ static void sepstate_maybe_destroy(void)
         // hasn't been initialized
         return;
     }
-    lua_close(sepstate.L);
+    lalloc_close(sepstate.L);
     LS_PTH_CHECK(pthread_mutex_destroy(&sepstate.L_mtx));
 }
 
@@ -769,21 +948,35 @@ static bool widget_init_inspect_event(Widget *w, const char *filename)
         return true;
     case LUA_TSTRING:
         {
-            sepstate_maybe_init();
+            lua_State *sepL;
+            pthread_mutex_t *sepL_mtx;
+            if (evpool_nthreads_opt) {
+                w->own_sepstate_L = xnew_sepstate_lua_state(w);
+                LS_PTH_CHECK(pthread_mutex_init(&w->own_sepstate_L_mtx, NULL));
+                sepL = w->own_sepstate_L;
+                sepL_mtx = &w->own_sepstate_L_mtx;
+            } else {
+                sepstate_maybe_init();
+                sepL = sepstate.L;
+                sepL_mtx = &sepstate.L_mtx;
+            }
 
             size_t ncode;
             const char *code = lua_tolstring(w->L, -1, &ncode);
 
             char *chunkname = ls_xallocf("widget.event of %s", filename);
-            bool r = check_lua_call(
-                sepstate.L, luaL_loadbuffer(sepstate.L, code, ncode, chunkname));
+            LS_PTH_CHECK(pthread_mutex_lock(sepL_mtx));
+            bool r = check_lua_call(sepL, luaL_loadbuffer(sepL, code, ncode, chunkname));
+            if (r) {
+                // sepL: ? chunk
+                w->lref_event = luaL_ref(sepL, LUA_REGISTRYINDEX); // sepL: ?
+            }
+            LS_PTH_CHECK(pthread_mutex_unlock(sepL_mtx));
             free(chunkname);
             if (!r) {
                 return false;
             }
 
-            // sepstate.L: ? chunk
-            w->lref_event = luaL_ref(sepstate.L, LUA_REGISTRYINDEX); // sepstate.L: ?
             w->sepstate_event = true;
             lua_pop(L, 1); // L: ? widget
             return true;
@@ -794,6 +987,268 @@ static bool widget_init_inspect_event(Widget *w, const char *filename)
     }
 }
 
+// Inspects the 'coalesce_events' field of /w/'s /widget/ table, and creates an event queue for /w/
+// if needed; the /widget/ table is assumed to be on top of /w.L/'s stack. The stack itself is not
+// changed by this function.
+//
+// Must be called after /widget_init_inspect_event()/.
+static bool widget_init_inspect_coalesce_events(Widget *w)
+{
+    lua_State *L = w->L;
+    bool coalesce = true;
+    LS_StringArray keys = ls_strarr_new();
+    // L: ? widget
+    lua_getfield(L, -1, "coalesce_events"); // L: ? widget coalesce_events
+    switch (lua_type(L, -1)) {
+    case LUA_TNIL:
+        coalesce = false;
+        break;
+    case LUA_TBOOLEAN:
+        coalesce = lua_toboolean(L, -1);
+        break;
+    case LUA_TTABLE:
+        {
+            size_t n = ls_lua_array_len(L, -1);
+            for (size_t i = 1; i <= n; ++i) {
+                lua_rawgeti(L, -1, i); // L: ? widget coalesce_events key
+                if (lua_type(L, -1) != LUA_TSTRING) {
+                    ERRF("'widget.coalesce_events' element: expected string, found %s",
+                         luaL_typename(L, -1));
+                    goto error;
+                }
+                ls_strarr_append_s(&keys, lua_tostring(L, -1));
+                lua_pop(L, 1); // L: ? widget coalesce_events
+            }
+        }
+        break;
+    default:
+        ERRF("'widget.coalesce_events': expected boolean, table or nil, found %s",
+             luaL_typename(L, -1));
+        goto error;
+    }
+
+    if (!w->sepstate_event && w->lref_event == LUA_REFNIL) {
+        if (coalesce) {
+            WARNF("'widget.coalesce_events' is set, but 'widget.event' is nil; ignoring");
+        }
+        goto no_queue;
+    }
+    if (!coalesce && !evpool_nthreads_opt) {
+        goto no_queue;
+    }
+
+    w->evq = LS_XNEW(EventQueue, 1);
+    evq_init(w->evq, xnew_lua_state(), xnew_lua_state(), coalesce, keys);
+    lua_pop(L, 1); // L: ? widget
+    return true;
+
+no_queue:
+    ls_strarr_destroy(keys);
+    lua_pop(L, 1); // L: ? widget
+    return true;
+
+error:
+    ls_strarr_destroy(keys);
+    return false;
+}
+
+enum {
+    GC_MODE_DEFAULT,
+    GC_MODE_INCREMENTAL,
+    GC_MODE_GENERATIONAL,
+};
+
+// Garbage collector settings from /widget.gc/; zero means "not set".
+typedef struct {
+    int mode;
+    int pause;
+    int stepmul;
+    int stepsize;
+    int minormul;
+    int majormul;
+} GcOpts;
+
+#if LUA_VERSION_NUM == 502 || LUA_VERSION_NUM >= 504
+#   define GC_HAVE_GENERATIONAL 1
+#else
+#   define GC_HAVE_GENERATIONAL 0
+#endif
+
+static const struct {
+    const char *name;
+    size_t offset;
+    bool supported;
+} gc_params[] = {
+    {"pause",    offsetof(GcOpts, pause),    true},
+    {"stepmul",  offsetof(GcOpts, stepmul),  true},
+    {"stepsize", offsetof(GcOpts, stepsize), LUA_VERSION_NUM >= 504},
+    {"minormul", offsetof(GcOpts, minormul), LUA_VERSION_NUM >= 504},
+    {"majormul", offsetof(GcOpts, majormul), LUA_VERSION_NUM == 504},
+};
+
+// Applies /o/ to /L/'s garbage collector. Settings not supported by this version of Lua must not be
+// set in /o/.
+static void gc_opts_apply(lua_State *L, const GcOpts *o)
+{
+#if defined(LUA_GCPARAM)
+    // Lua 5.5+: the mode and the parameters are set separately.
+    if (o->mode) {
+        lua_gc(L, o->mode == GC_MODE_GENERATIONAL ? LUA_GCGEN : LUA_GCINC);
+    }
+    if (o->pause) {
+        lua_gc(L, LUA_GCPARAM, LUA_GCPPAUSE, o->pause);
+    }
+    if (o->stepmul) {
+        lua_gc(L, LUA_GCPARAM, LUA_GCPSTEPMUL, o->stepmul);
+    }
+    if (o->stepsize) {
+        lua_gc(L, LUA_GCPARAM, LUA_GCPSTEPSIZE, o->stepsize);
+    }
+    if (o->minormul) {
+        lua_gc(L, LUA_GCPARAM, LUA_GCPMINORMUL, o->minormul);
+    }
+#elif LUA_VERSION_NUM == 504
+    // Switching to a mode sets its parameters; zeros leave them unchanged.
+    if (o->mode == GC_MODE_INCREMENTAL || o->pause || o->stepmul || o->stepsize) {
+        lua_gc(L, LUA_GCINC, o->pause, o->stepmul, o->stepsize);
+    }
+    if (o->mode == GC_MODE_GENERATIONAL) {
+        lua_gc(L, LUA_GCGEN, o->minormul, o->majormul);
+    }
+#else
+    if (o->pause) {
+        lua_gc(L, LUA_GCSETPAUSE, o->pause);
+    }
+    if (o->stepmul) {
+        lua_gc(L, LUA_GCSETSTEPMUL, o->stepmul);
+    }
+#   if LUA_VERSION_NUM == 502
+    if (o->mode) {
+        lua_gc(L, o->mode == GC_MODE_GENERATIONAL ? LUA_GCGEN : LUA_GCINC, 0);
+    }
+#   endif
+#endif
+}
+
+// Checks that the value on top of /L/'s stack is an integer in range [1; INT_MAX], and converts it
+// to /int/.
+static bool gc_param_from_lua(lua_State *L, const char *name, int *out)
+{
+    if (lua_type(L, -1) != LUA_TNUMBER) {
+        ERRF("'widget.gc.%s': expected number, found %s", name, luaL_typename(L, -1));
+        return false;
+    }
+    lua_Number v = lua_tonumber(L, -1);
+    if (!(v >= 1 && v <= INT_MAX) || v != (int) v) {
+        ERRF("'widget.gc.%s': expected a positive integer", name);
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+// Inspects the 'gc' field of /w/'s /widget/ table, and configures the garbage collector of /w.L/
+// accordingly; the /widget/ table is assumed to be on top of /w.L/'s stack. The stack itself is not
+// changed by this function.
+static bool widget_init_inspect_gc(Widget *w)
+{
+    lua_State *L = w->L;
+    GcOpts o = {.mode = GC_MODE_DEFAULT};
+    // L: ? widget
+    lua_getfield(L, -1, "gc"); // L: ? widget gc
+    switch (lua_type(L, -1)) {
+    case LUA_TNIL:
+        lua_pop(L, 1); // L: ? widget
+        return true;
+    case LUA_TTABLE:
+        break;
+    default:
+        ERRF("'widget.gc': expected table or nil, found %s", luaL_typename(L, -1));
+        return false;
+    }
+
+    lua_getfield(L, -1, "mode"); // L: ? widget gc mode
+    if (!lua_isnil(L, -1)) {
+        const char *mode = lua_type(L, -1) == LUA_TSTRING ? lua_tostring(L, -1) : "";
+        if (strcmp(mode, "incremental") == 0) {
+            o.mode = GC_MODE_INCREMENTAL;
+        } else if (strcmp(mode, "generational") == 0) {
+            if (GC_HAVE_GENERATIONAL) {
+                o.mode = GC_MODE_GENERATIONAL;
+            } else {
+                WARNF("'widget.gc.mode': generational mode is not supported by this Lua version; "
+                      "ignoring");
+            }
+        } else {
+            ERRF("'widget.gc.mode': expected 'incremental', 'generational' or nil");
+            return false;
+        }
+    }
+    lua_pop(L, 1); // L: ? widget gc
+
+    for (size_t i = 0; i < LS_ARRAY_SIZE(gc_params); ++i) {
+        const char *name = gc_params[i].name;
+        lua_getfield(L, -1, name); // L: ? widget gc value
+        if (!lua_isnil(L, -1)) {
+            int v;
+            if (!gc_param_from_lua(L, name, &v)) {
+                return false;
+            }
+            if (gc_params[i].supported) {
+                *(int *) ((char *) &o + gc_params[i].offset) = v;
+            } else {
+                WARNF("'widget.gc.%s' is not supported by this Lua version; ignoring", name);
+            }
+        }
+        lua_pop(L, 1); // L: ? widget gc
+    }
+
+    lua_getfield(L, -1, "idle_step"); // L: ? widget gc idle_step
+    if (!lua_isnil(L, -1)) {
+        if (!gc_param_from_lua(L, "idle_step", &w->gc_idle_step)) {
+            return false;
+        }
+    }
+    lua_pop(L, 1); // L: ? widget gc
+
+    gc_opts_apply(L, &o);
+
+    lua_pop(L, 1); // L: ? widget
+    return true;
+}
+
+// Inspects the 'memory_limit' field of /w/'s /widget/ table, and sets the memory limit of /w.L/
+// accordingly; the /widget/ table is assumed to be on top of /w.L/'s stack. The stack itself is not
+// changed by this function.
+static bool widget_init_inspect_memory_limit(Widget *w)
+{
+    lua_State *L = w->L;
+    // L: ? widget
+    lua_getfield(L, -1, "memory_limit"); // L: ? widget memory_limit
+    switch (lua_type(L, -1)) {
+    case LUA_TNIL:
+        break;
+    case LUA_TNUMBER:
+        {
+            lua_Number limit = lua_tonumber(L, -1);
+            if (!(limit >= 1 && limit < (lua_Number) SIZE_MAX)) {
+                ERRF("'widget.memory_limit': expected a positive number");
+                return false;
+            }
+            if (!lalloc_set_limit(L, limit)) {
+                WARNF("'widget.memory_limit' is set, but this Lua implementation does not support "
+                      "custom allocators; ignoring");
+            }
+        }
+        break;
+    default:
+        ERRF("'widget.memory_limit': expected number or nil, found %s", luaL_typename(L, -1));
+        return false;
+    }
+    lua_pop(L, 1); // L: ? widget
+    return true;
+}
+
 // Inspects the 'opts' field of /w/'s /widget/ table; the /widget/ table is assumed to be on top
 // of /w.L/'s stack.
 //
@@ -815,23 +1270,58 @@ static bool widget_init_inspect_push_opts(Widget *w)
     }
 }
 
+static void own_sepstate_maybe_destroy(Widget *w)
+{
+    if (!w->own_sepstate_L) {
+        // hasn't been initialized
+        return;
+    }
+    lalloc_close(w->own_sepstate_L);
+    LS_PTH_CHECK(pthread_mutex_destroy(&w->own_sepstate_L_mtx));
+}
+
+// Logs the statistics of the allocator of /w.L/, if it has an accounting one.
+static void widget_log_memory_stats(Widget *w)
+{
+    LAllocStats s;
+    if (!lalloc_stats(w->L, &s)) {
+        return;
+    }
+    if (s.limit) {
+        DEBUGF("widget '%s': Lua memory: %zu bytes in use, peak %zu bytes, limit %zu bytes, "
+               "%zu allocations refused",
+               w->filename, s.nbytes, s.peak, s.limit, s.nrefused);
+    } else {
+        DEBUGF("widget '%s': Lua memory: %zu bytes in use, peak %zu bytes",
+               w->filename, s.nbytes, s.peak);
+    }
+}
+
 static bool widget_init(Widget *w, const char *filename)
 {
     w->L = xnew_lua_state();
     LS_PTH_CHECK(pthread_mutex_init(&w->L_mtx, NULL));
     w->filename = ls_xstrdup(filename);
     w->comm = (Comm) COMM_INITIALIZER;
+    w->own_sepstate_L = NULL;
+    w->evq = NULL;
+    w->gc_idle_step = 0;
+    w->gc_idle_pending = false;
     bool plugin_loaded = false;
 
     DEBUGF("initializing widget '%s'", filename);
 
-    luaL_openlibs(w->L);
-    // w->L: -
     inject_libs(w->L, w); // w->L: -
+
+    LAllocStats s;
+    if (lalloc_stats(w->L, &s)) {
+        DEBUGF("widget '%s': baseline Lua memory: %zu bytes", filename, s.nbytes);
+    }
+
     lua_pushcfunction(w->L, l_error_handler); // w->L: l_error_handler
 
     DEBUGF("running file '%s'", filename);
-    if (!check_lua_call(w->L, luaL_loadfile(w->L, filename))) {
+    if (!check_lua_call(w->L, ls_chunk_cache_loadfile(w->L, filename))) {
         goto error;
     }
     // w->L: l_error_handler chunk
@@ -852,6 +1342,9 @@ static bool widget_init(Widget *w, const char *filename)
     plugin_loaded = true;
     if (!widget_init_inspect_cb(w) ||
         !widget_init_inspect_event(w, filename) ||
+        !widget_init_inspect_coalesce_events(w) ||
+        !widget_init_inspect_memory_limit(w) ||
+        !widget_init_inspect_gc(w) ||
         !widget_init_inspect_push_opts(w))
     {
         goto error;
@@ -864,7 +1357,10 @@ static bool widget_init(Widget *w, const char *filename)
         .map_get = map_get,
     };
 
-    if (w->plugin.iface.init(&w->data, w->L) == LUASTATUS_ERR) {
+    LS_PTH_CHECK(pthread_mutex_lock(&plugin_init_mtx));
+    int init_r = w->plugin.iface.init(&w->data, w->L);
+    LS_PTH_CHECK(pthread_mutex_unlock(&plugin_init_mtx));
+    if (init_r == LUASTATUS_ERR) {
         ERRF("plugin's init() failed");
         goto error;
     }
@@ -872,16 +1368,22 @@ static bool widget_init(Widget *w, const char *filename)
     lua_pop(w->L, 2); // w->L: l_error_handler
 
     DEBUGF("widget successfully initialized");
+    widget_log_memory_stats(w);
     return true;
 
 error:
-    lua_close(w->L);
+    lalloc_close(w->L);
     LS_PTH_CHECK(pthread_mutex_destroy(&w->L_mtx));
     free(w->filename);
     if (plugin_loaded) {
         plugin_unload(&w->plugin);
     }
     comm_destroy(&w->comm);
+    own_sepstate_maybe_destroy(w);
+    if (w->evq) {
+        evq_destroy(w->evq);
+        free(w->evq);
+    }
     return false;
 }
 
@@ -891,6 +1393,8 @@ static void widget_init_stillborn(Widget *w)
     w->L = NULL;
     w->lref_event = LUA_REFNIL;
     w->sepstate_event = true;
+    w->own_sepstate_L = NULL;
+    w->evq = NULL;
 }
 
 static inline bool widget_is_stillborn(Widget *w)
@@ -901,6 +1405,9 @@ static inline bool widget_is_stillborn(Widget *w)
 // Returns the Lua interpreter instance for the /widget.event/ function of a widget /w/.
 static inline lua_State *widget_event_lua_state(Widget *w)
 {
+    if (w->own_sepstate_L) {
+        return w->own_sepstate_L;
+    }
     return w->sepstate_event ? sepstate.L : w->L;
 }
 
@@ -908,6 +1415,9 @@ static inline lua_State *widget_event_lua_state(Widget *w)
 // function of a widget /w/.
 static inline pthread_mutex_t *widget_event_L_mtx(Widget *w)
 {
+    if (w->own_sepstate_L) {
+        return &w->own_sepstate_L_mtx;
+    }
     return w->sepstate_event ? &sepstate.L_mtx : &w->L_mtx;
 }
 
@@ -921,10 +1431,16 @@ static void widget_destroy(Widget *w)
     if (!widget_is_stillborn(w)) {
         w->plugin.iface.destroy(&w->data);
         plugin_unload(&w->plugin);
-        lua_close(w->L);
+        widget_log_memory_stats(w);
+        lalloc_close(w->L);
         LS_PTH_CHECK(pthread_mutex_destroy(&w->L_mtx));
         free(w->filename);
         comm_destroy(&w->comm);
+        own_sepstate_maybe_destroy(w);
+        if (w->evq) {
+            evq_destroy(w->evq);
+            free(w->evq);
+        }
     }
 }
 
@@ -969,19 +1485,91 @@ done:
     lua_pop(L, 1); // L: ?
 }
 
+// Initializes the /i/-th widget from file /filename/, or makes it stillborn if that fails.
+static void widgets_init_one(size_t i, const char *filename)
+{
+    if (!widget_init(&widgets[i], filename)) {
+        ERRF("cannot load widget '%s'", filename);
+        widget_init_stillborn(&widgets[i]);
+    }
+}
+
+typedef struct {
+    char *const *filenames;
+
+    // Guards /next/ and writing of the log output to stderr.
+    pthread_mutex_t mtx;
+
+    // Index of the next widget to initialize.
+    size_t next;
+} InitPool;
+
+static void *init_thread(void *arg)
+{
+    InitPool *pool = arg;
+    for (;;) {
+        LS_PTH_CHECK(pthread_mutex_lock(&pool->mtx));
+        size_t i = pool->next;
+        if (i < nwidgets) {
+            ++pool->next;
+        }
+        LS_PTH_CHECK(pthread_mutex_unlock(&pool->mtx));
+
+        if (i == nwidgets) {
+            return NULL;
+        }
+
+        LS_String log = ls_string_new();
+        tls_log_buf = &log;
+        widgets_init_one(i, pool->filenames[i]);
+        tls_log_buf = NULL;
+
+        if (log.size) {
+            LS_PTH_CHECK(pthread_mutex_lock(&pool->mtx));
+            fwrite(log.data, 1, log.size, stderr);
+            LS_PTH_CHECK(pthread_mutex_unlock(&pool->mtx));
+        }
+        ls_string_free(log);
+    }
+}
+
 // Initializes the /widgets/ and /nwidgets/ global variables from the given list of file names:
 // sets /nwidgets/, allocates /widgets/, initialized all the widgets, and makes ones whose
 // initialization failed stillborn.
+//
+// If /parallel_init/ is set, the widgets are initialized in parallel by up to /INIT_MAX_THREADS/
+// threads. The log output of each widget's initialization is then buffered and written out as soon
+// as that widget is initialized, so messages of different widgets never interleave (but they come
+// out in the order the widgets finish initializing in).
 static void widgets_init(char *const *filenames, size_t nfilenames)
 {
     nwidgets = nfilenames;
     widgets = LS_XNEW(Widget, nwidgets);
-    for (size_t i = 0; i < nwidgets; ++i) {
-        if (!widget_init(&widgets[i], filenames[i])) {
-            ERRF("cannot load widget '%s'", filenames[i]);
-            widget_init_stillborn(&widgets[i]);
+
+    size_t nthreads = nwidgets < INIT_MAX_THREADS ? nwidgets : INIT_MAX_THREADS;
+    if (!parallel_init || nthreads <= 1) {
+        for (size_t i = 0; i < nwidgets; ++i) {
+            widgets_init_one(i, filenames[i]);
         }
+        return;
+    }
+
+    InitPool pool = {
+        .filenames = filenames,
+        .next = 0,
+    };
+    LS_PTH_CHECK(pthread_mutex_init(&pool.mtx, NULL));
+
+    pthread_t *threads = LS_XNEW(pthread_t, nthreads);
+    for (size_t i = 0; i < nthreads; ++i) {
+        LS_PTH_CHECK(pthread_create(&threads[i], NULL, init_thread, &pool));
+    }
+    for (size_t i = 0; i < nthreads; ++i) {
+        LS_PTH_CHECK(pthread_join(threads[i], NULL));
     }
+    free(threads);
+
+    LS_PTH_CHECK(pthread_mutex_destroy(&pool.mtx));
 }
 
 static void widgets_destroy(void)
@@ -1034,6 +1622,7 @@ static void plugin_call_end(void *userdata)
     lua_State *L = w->L;
     LS_ASSERT(lua_gettop(L) == 3); // L: l_error_handler cb data
     bool r = do_lua_call(L, 1, 1);
+    w->gc_idle_pending = true;
     LOCK_B();
     size_t widget_idx = widget_index(w);
     if (r) {
@@ -1070,20 +1659,225 @@ static void plugin_call_cancel(void *userdata)
     UNLOCK_L(w);
 }
 
+// Performs a single garbage collection step of /widget.gc.idle_step/ kilobytes on /L/; the widget
+// is passed as a light user data. Pushes a boolean indicating whether the step has completed a
+// cycle.
+//
+// Must be called in protected mode, as a /__gc/ metamethod may raise an error.
+static int l_gc_step(lua_State *L)
+{
+    Widget *w = lua_touserdata(L, 1);
+#if defined(LUA_GCPARAM)
+    // Lua 5.5+: the argument is a /size_t/ number of bytes.
+    size_t step = (size_t) w->gc_idle_step * 1024;
+#else
+    int step = w->gc_idle_step;
+#endif
+    lua_pushboolean(L, lua_gc(L, LUA_GCSTEP, step));
+    return 1;
+}
+
+// Performs a single garbage collection step of /widget.gc.idle_step/ kilobytes, unless the last one
+// has completed a cycle and /cb/ has not been called since.
+static void plugin_call_idle(void *userdata)
+{
+    TRACEF("plugin_call_idle(userdata=%p)", userdata);
+
+    Widget *w = userdata;
+    if (!w->gc_idle_step) {
+        return;
+    }
+    LOCK_L(w);
+    if (w->gc_idle_pending) {
+        lua_State *L = w->L;
+        LS_ASSERT(lua_gettop(L) == 1); // L: l_error_handler
+        lua_pushcfunction(L, l_gc_step); // L: l_error_handler l_gc_step
+        lua_pushlightuserdata(L, w); // L: l_error_handler l_gc_step w
+        if (do_lua_call(L, 1, 1)) {
+            // L: l_error_handler result
+            if (lua_toboolean(L, -1)) {
+                w->gc_idle_pending = false;
+            }
+            lua_pop(L, 1); // L: l_error_handler
+        } else {
+            // L: l_error_handler
+            LOCK_B();
+            set_error_unlocked(widget_index(w));
+            UNLOCK_B();
+        }
+    }
+    UNLOCK_L(w);
+}
+
 static inline void possibly_sepstate_call_begin(Widget *w)
 {
-    if (w->sepstate_event) {
+    if (w->sepstate_event && !w->own_sepstate_L) {
         sepstate.cur_w = w;
     }
 }
 
 static inline void possibly_sepstate_call_end(Widget *w)
 {
-    if (w->sepstate_event) {
+    if (w->sepstate_event && !w->own_sepstate_L) {
         sepstate.cur_w = NULL;
     }
 }
 
+// Calls /w/'s /widget.event/ function; /L/ is its Lua interpreter instance (as returned by
+// /widget_event_lua_state()/), with the function and /nargs/ arguments on top of the stack.
+//
+// Invokes /barlib/'s /set_error()/ method on /w/ if the call fails.
+static void run_event_func(Widget *w, lua_State *L, int nargs)
+{
+    if (!do_lua_call(L, nargs, 0)) {
+        // L: l_error_handler
+        LOCK_B();
+        set_error_unlocked(widget_index(w));
+        UNLOCK_B();
+    }
+    // L: l_error_handler
+}
+
+// Appends /w/ to the /evpool.ready/ list unless it is already scheduled.
+//
+// Does not do any locking/unlocking.
+static void evpool_schedule_unlocked(Widget *w)
+{
+    if (w->evq_scheduled) {
+        return;
+    }
+    w->evq_scheduled = true;
+    evpool.ready[(evpool.ready_head + evpool.ready_size++) % nwidgets] = w;
+    LS_PTH_CHECK(pthread_cond_signal(&evpool.cond));
+}
+
+// Should be called after an event has been pushed to /w->evq/.
+static void evpool_schedule(Widget *w)
+{
+    LS_PTH_CHECK(pthread_mutex_lock(&evpool.mtx));
+    evpool_schedule_unlocked(w);
+    LS_PTH_CHECK(pthread_mutex_unlock(&evpool.mtx));
+}
+
+// Takes the oldest event from /w->evq/ and calls /w/'s /widget.event/ function with it.
+static void evpool_process_one(Widget *w)
+{
+    LOCK_E(w);
+
+    possibly_sepstate_call_begin(w);
+
+    lua_State *L = widget_event_lua_state(w);
+    LS_ASSERT(lua_gettop(L) == 1); // L: l_error_handler
+    lua_rawgeti(L, LUA_REGISTRYINDEX, w->lref_event); // L: l_error_handler event
+    size_t count;
+    if (!check_lua_call(L, evq_pop(w->evq, L, &count))) {
+        // L: l_error_handler event
+        lua_pop(L, 1); // L: l_error_handler
+        LOCK_B();
+        set_error_unlocked(widget_index(w));
+        UNLOCK_B();
+    } else if (w->evq->coalesce) {
+        // L: l_error_handler event arg
+        lua_pushinteger(L, count < (size_t) LS_LUA_MAXI ? count : LS_LUA_MAXI);
+        // L: l_error_handler event arg count
+        run_event_func(w, L, 2); // L: l_error_handler
+    } else {
+        run_event_func(w, L, 1); // L: l_error_handler
+    }
+
+    possibly_sepstate_call_end(w);
+
+    UNLOCK_E(w);
+}
+
+// Each event pool thread runs this function.
+static void *evpool_thread(void *arg)
+{
+    (void) arg;
+
+    LS_PTH_CHECK(pthread_mutex_lock(&evpool.mtx));
+    for (;;) {
+        while (!evpool.ready_size && !evpool.closed) {
+            LS_PTH_CHECK(pthread_cond_wait(&evpool.cond, &evpool.mtx));
+        }
+        if (!evpool.ready_size) {
+            break;
+        }
+        Widget *w = evpool.ready[evpool.ready_head];
+        evpool.ready_head = (evpool.ready_head + 1) % nwidgets;
+        --evpool.ready_size;
+        LS_PTH_CHECK(pthread_mutex_unlock(&evpool.mtx));
+
+        // Process one event at a time, so that a widget with a lot of events does not starve the
+        // others.
+        evpool_process_one(w);
+
+        LS_PTH_CHECK(pthread_mutex_lock(&evpool.mtx));
+        w->evq_scheduled = false;
+        if (!evq_is_empty(w->evq)) {
+            evpool_schedule_unlocked(w);
+        }
+    }
+    LS_PTH_CHECK(pthread_mutex_unlock(&evpool.mtx));
+    return NULL;
+}
+
+// Starts the event pool if there is at least one widget with an event queue.
+static void evpool_maybe_start(void)
+{
+    size_t nqueues = 0;
+    for (size_t i = 0; i < nwidgets; ++i) {
+        if (widgets[i].evq) {
+            widgets[i].evq_scheduled = false;
+            ++nqueues;
+        }
+    }
+    if (!nqueues) {
+        return;
+    }
+
+    LS_PTH_CHECK(pthread_mutex_init(&evpool.mtx, NULL));
+    LS_PTH_CHECK(pthread_cond_init(&evpool.cond, NULL));
+    evpool.ready = LS_XNEW(Widget *, nwidgets);
+    evpool.ready_head = 0;
+    evpool.ready_size = 0;
+    evpool.closed = false;
+
+    // Without /-j/, only widgets with /widget.coalesce_events/ have event queues, and each of them
+    // gets its own thread, as it would have with no event pool at all.
+    evpool.nthreads = evpool_nthreads_opt ? (size_t) evpool_nthreads_opt : nqueues;
+    evpool.threads = LS_XNEW(pthread_t, evpool.nthreads);
+
+    DEBUGF("starting %zu event pool thread(s)", evpool.nthreads);
+    for (size_t i = 0; i < evpool.nthreads; ++i) {
+        LS_PTH_CHECK(pthread_create(&evpool.threads[i], NULL, evpool_thread, NULL));
+    }
+}
+
+// Lets the event pool threads process all the pending events, and joins them.
+static void evpool_maybe_stop(void)
+{
+    if (!evpool.threads) {
+        // hasn't been started
+        return;
+    }
+
+    LS_PTH_CHECK(pthread_mutex_lock(&evpool.mtx));
+    evpool.closed = true;
+    LS_PTH_CHECK(pthread_cond_broadcast(&evpool.cond));
+    LS_PTH_CHECK(pthread_mutex_unlock(&evpool.mtx));
+
+    for (size_t i = 0; i < evpool.nthreads; ++i) {
+        LS_PTH_CHECK(pthread_join(evpool.threads[i], NULL));
+    }
+
+    LS_PTH_CHECK(pthread_mutex_destroy(&evpool.mtx));
+    LS_PTH_CHECK(pthread_cond_destroy(&evpool.cond));
+    free(evpool.ready);
+    free(evpool.threads);
+    evpool.threads = NULL;
+}
+
 static lua_State *ew_call_begin(void *userdata, size_t widget_idx)
 {
     TRACEF("ew_call_begin(userdata=%p, widget_idx=%zu)", userdata, widget_idx);
@@ -1091,6 +1885,10 @@ static lua_State *ew_call_begin(void *userdata, size_t widget_idx)
     LS_ASSERT(widget_idx < nwidgets);
 
     Widget *w = &widgets[widget_idx];
+    if (w->evq) {
+        return evq_push_begin(w->evq);
+    }
+
     LOCK_E(w);
 
     possibly_sepstate_call_begin(w);
@@ -1108,18 +1906,21 @@ static void ew_call_end(void *userdata, size_t widget_idx)
     LS_ASSERT(widget_idx < nwidgets);
 
     Widget *w = &widgets[widget_idx];
+    if (w->evq) {
+        if (!evq_push_end(w->evq)) {
+            WARNF("widget '%s': coalesced event queue is full, dropping the oldest event",
+                  w->filename);
+        }
+        evpool_schedule(w);
+        return;
+    }
+
     lua_State *L = widget_event_lua_state(w);
     LS_ASSERT(lua_gettop(L) == 3); // L: l_error_handler event arg
     if (w->lref_event == LUA_REFNIL) {
         lua_pop(L, 2); // L: l_error_handler
     } else {
-        if (!do_lua_call(L, 1, 0)) {
-            // L: l_error_handler
-            LOCK_B();
-            set_error_unlocked(widget_idx);
-            UNLOCK_B();
-        }
-        // L: l_error_handler
+        run_event_func(w, L, 1); // L: l_error_handler
     }
 
     possibly_sepstate_call_end(w);
@@ -1134,6 +1935,11 @@ static void ew_call_cancel(void *userdata, size_t widget_idx)
     LS_ASSERT(widget_idx < nwidgets);
 
     Widget *w = &widgets[widget_idx];
+    if (w->evq) {
+        evq_push_cancel(w->evq);
+        return;
+    }
+
     lua_State *L = widget_event_lua_state(w);
     lua_settop(L, 1); // L: l_error_handler
 
@@ -1148,11 +1954,20 @@ static void *widget_thread(void *arg)
     Widget *w = arg;
     DEBUGF("thread for widget '%s' is running", w->filename);
 
-    w->plugin.iface.run(&w->data, (LuastatusPluginRunFuncs_v1) {
-        .call_begin  = plugin_call_begin,
-        .call_end    = plugin_call_end,
-        .call_cancel = plugin_call_cancel,
-    });
+    if (w->plugin.run_v1) {
+        w->plugin.run_v1(&w->data, (LuastatusPluginRunFuncs_v1) {
+            .call_begin  = plugin_call_begin,
+            .call_end    = plugin_call_end,
+            .call_cancel = plugin_call_cancel,
+        });
+    } else {
+        w->plugin.iface.run(&w->data, (LuastatusPluginRunFuncs_v2) {
+            .call_begin  = plugin_call_begin,
+            .call_end    = plugin_call_end,
+            .call_cancel = plugin_call_cancel,
+            .call_idle   = plugin_call_idle,
+        });
+    }
     WARNF("plugin's run() for widget '%s' has returned", w->filename);
 
     LOCK_B();
@@ -1175,7 +1990,7 @@ static void prepare_signals(void)
 static void print_usage(void)
 {
     fprintf(stderr, "USAGE: luastatus -b barlib [-B barlib_option [-B ...]] [-l loglevel] [-e] "
-                    "widget.lua [widget2.lua ...]\n"
+                    "[-j nthreads] [-p] widget.lua [widget2.lua ...]\n"
                     "       luastatus -v\n"
                     "See luastatus(1) for more information.\n");
 }
@@ -1215,7 +2030,7 @@ int main(int argc, char **argv)
 
     // Parse the arguments.
 
-    for (int c; (c = getopt(argc, argv, "b:B:l:ev")) != -1;) {
+    for (int c; (c = getopt(argc, argv, "b:B:l:ej:pv")) != -1;) {
         switch (c) {
         case 'b':
             barlib_name = optarg;
@@ -1233,6 +2048,16 @@ int main(int argc, char **argv)
         case 'e':
             eflag = true;
             break;
+        case 'j':
+            if ((evpool_nthreads_opt = ls_full_strtou(optarg)) <= 0) {
+                fprintf(stderr, "Invalid number of event pool threads '%s'.\n", optarg);
+                print_usage();
+                goto cleanup;
+            }
+            break;
+        case 'p':
+            parallel_init = true;
+            break;
         case 'v':
             fprintf(stderr, "This is luastatus %s.\n", LUASTATUS_VERSION);
             goto cleanup;
@@ -1296,10 +2121,17 @@ int main(int argc, char **argv)
             UNLOCK_B();
         } else {
             register_funcs(w->L, w);
+            if (w->own_sepstate_L) {
+                register_funcs(w->own_sepstate_L, NULL);
+            }
             LS_PTH_CHECK(pthread_create(&threads[i], NULL, widget_thread, w));
         }
     }
 
+    // Start the event pool, if needed.
+
+    evpool_maybe_start();
+
     // Run /barlib/'s event watcher, if present.
 
     if (barlib.iface.event_watcher) {
@@ -1323,6 +2155,11 @@ int main(int argc, char **argv)
         }
     }
 
+    // Let the event pool process the pending events, and join its threads.
+
+    DEBUGF("stopping the event pool");
+    evpool_maybe_stop();
+
     // Either hang or exit.
 
     WARNF("all plugins' run() and barlib's event_watcher() have returned");
@@ -1347,5 +2184,6 @@ cleanup:
     sepstate_maybe_destroy();
     map_destroy();
     comm_global_deinit();
+    ls_chunk_cache_clear();
     return ret;
 }
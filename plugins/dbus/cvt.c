@@ -19,16 +19,12 @@
 
 #include "cvt.h"
 
-#include <stdio.h>
-#include <stdarg.h>
 #include <stdint.h>
-#include <inttypes.h>
 #include <limits.h>
 #include <string.h>
 #include <stdbool.h>
 #include <glib/gtypes.h>
 #include <lua.h>
-#include "libls/ls_compdep.h"
 #include "libls/ls_panic.h"
 #include "libls/ls_lua_compat.h"
 
@@ -60,7 +56,7 @@ static void push_special_object(lua_State *L, const char *s, size_t ns, bool is_
 }
 
 // forward declaration
-static void push_gvariant(lua_State *L, GVariant *var, unsigned recurlim);
+static void push_gvariant(lua_State *L, GVariant *var, unsigned recurlim, bool native_ints);
 
 static void on_recur_lim(lua_State *L)
 {
@@ -74,7 +70,11 @@ static inline void push_gvariant_strlike(lua_State *L, GVariant *var)
     lua_pushlstring(L, s, ns);
 }
 
-static void push_gvariant_iterable(lua_State *L, GVariant *var, unsigned recurlim)
+static void push_gvariant_iterable(
+        lua_State *L,
+        GVariant *var,
+        unsigned recurlim,
+        bool native_ints)
 {
     if (!recurlim--) {
         on_recur_lim(L);
@@ -93,24 +93,70 @@ static void push_gvariant_iterable(lua_State *L, GVariant *var, unsigned recurli
 
     GVariant *elem;
     for (size_t i = 1; (elem = g_variant_iter_next_value(&iter)); ++i) {
-        push_gvariant(L, elem, recurlim); // L: table value
+        push_gvariant(L, elem, recurlim, native_ints); // L: table value
         g_variant_unref(elem);
         lua_rawseti(L, -2, i); // L: table
     }
 }
 
-static inline LS_ATTR_PRINTF(2, 3)
-void push_small_fstr(lua_State *L, const char *fmt, ...)
+// Pushes the decimal representation of /is_neg ? -abs_value : abs_value/.
+static void push_int_str(lua_State *L, uint64_t abs_value, bool is_neg)
 {
-    char buf[32];
-    va_list vl;
-    va_start(vl, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, vl);
-    va_end(vl);
-    lua_pushstring(L, buf);
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *ptr = end;
+    do {
+        *--ptr = '0' + (abs_value % 10);
+        abs_value /= 10;
+    } while (abs_value);
+    if (is_neg) {
+        *--ptr = '-';
+    }
+    lua_pushlstring(L, ptr, end - ptr);
+}
+
+// Largest magnitude of an integer that is exactly representable as a Lua number; only used if
+// there is no native integer type (Lua 5.1 and 5.2).
+#define MAX_EXACT_NUM (((uint64_t) 1) << 53)
+
+static void push_signed(lua_State *L, int64_t value, bool native_ints)
+{
+    uint64_t abs_value = value < 0 ? -(uint64_t) value : (uint64_t) value;
+    if (native_ints) {
+#if LUA_VERSION_NUM >= 503
+        if (value >= LUA_MININTEGER && value <= LUA_MAXINTEGER) {
+            lua_pushinteger(L, value);
+            return;
+        }
+#else
+        if (abs_value <= MAX_EXACT_NUM) {
+            lua_pushnumber(L, value);
+            return;
+        }
+#endif
+    }
+    push_int_str(L, abs_value, value < 0);
+}
+
+static void push_unsigned(lua_State *L, uint64_t value, bool native_ints)
+{
+    if (native_ints) {
+#if LUA_VERSION_NUM >= 503
+        if (value <= (uint64_t) LUA_MAXINTEGER) {
+            lua_pushinteger(L, value);
+            return;
+        }
+#else
+        if (value <= MAX_EXACT_NUM) {
+            lua_pushnumber(L, value);
+            return;
+        }
+#endif
+    }
+    push_int_str(L, value, false);
 }
 
-static void push_gvariant(lua_State *L, GVariant *var, unsigned recurlim)
+static void push_gvariant(lua_State *L, GVariant *var, unsigned recurlim, bool native_ints)
 {
     LS_ASSERT(var != NULL);
 
@@ -125,31 +171,31 @@ static void push_gvariant(lua_State *L, GVariant *var, unsigned recurlim)
         break;
 
     case G_VARIANT_CLASS_BYTE:
-        push_small_fstr(L, "%" PRIu8, (uint8_t) g_variant_get_byte(var));
+        push_unsigned(L, (uint8_t) g_variant_get_byte(var), native_ints);
         break;
 
     case G_VARIANT_CLASS_INT16:
-        push_small_fstr(L, "%" PRIi16, (int16_t) g_variant_get_int16(var));
+        push_signed(L, (int16_t) g_variant_get_int16(var), native_ints);
         break;
 
     case G_VARIANT_CLASS_UINT16:
-        push_small_fstr(L, "%" PRIu16, (uint16_t) g_variant_get_uint16(var));
+        push_unsigned(L, (uint16_t) g_variant_get_uint16(var), native_ints);
         break;
 
     case G_VARIANT_CLASS_INT32:
-        push_small_fstr(L, "%" PRIi32, (int32_t) g_variant_get_int32(var));
+        push_signed(L, (int32_t) g_variant_get_int32(var), native_ints);
         break;
 
     case G_VARIANT_CLASS_UINT32:
-        push_small_fstr(L, "%" PRIu32, (uint32_t) g_variant_get_uint32(var));
+        push_unsigned(L, (uint32_t) g_variant_get_uint32(var), native_ints);
         break;
 
     case G_VARIANT_CLASS_INT64:
-        push_small_fstr(L, "%" PRIi64, (int64_t) g_variant_get_int64(var));
+        push_signed(L, (int64_t) g_variant_get_int64(var), native_ints);
         break;
 
     case G_VARIANT_CLASS_UINT64:
-        push_small_fstr(L, "%" PRIu64, (uint64_t) g_variant_get_uint64(var));
+        push_unsigned(L, (uint64_t) g_variant_get_uint64(var), native_ints);
         break;
 
     case G_VARIANT_CLASS_DOUBLE:
@@ -165,7 +211,7 @@ static void push_gvariant(lua_State *L, GVariant *var, unsigned recurlim)
     case G_VARIANT_CLASS_VARIANT:
         {
             GVariant *boxed = g_variant_get_variant(var);
-            push_gvariant(L, boxed, recurlim);
+            push_gvariant(L, boxed, recurlim, native_ints);
             g_variant_unref(boxed);
         }
         break;
@@ -173,7 +219,7 @@ static void push_gvariant(lua_State *L, GVariant *var, unsigned recurlim)
     case G_VARIANT_CLASS_ARRAY:
     case G_VARIANT_CLASS_TUPLE:
     case G_VARIANT_CLASS_DICT_ENTRY:
-        push_gvariant_iterable(L, var, recurlim);
+        push_gvariant_iterable(L, var, recurlim, native_ints);
         break;
 
     case G_VARIANT_CLASS_HANDLE:
@@ -188,7 +234,7 @@ static void push_gvariant(lua_State *L, GVariant *var, unsigned recurlim)
     }
 }
 
-void cvt(lua_State *L, GVariant *var)
+void cvt(lua_State *L, GVariant *var, bool native_ints)
 {
     if (!var) {
         lua_pushnil(L);
@@ -196,7 +242,7 @@ void cvt(lua_State *L, GVariant *var)
     }
 
     if (lua_checkstack(L, 210)) {
-        push_gvariant(L, var, 200);
+        push_gvariant(L, var, 200, native_ints);
     } else {
         push_special_object(L, "out of memory", -1, true);
     }
@@ -21,7 +21,11 @@
 
 #include <lua.h>
 #include <glib.h>
+#include <stdbool.h>
 
 // "cvt" means "convert", as in "convert GVariant to Lua value".
 
-void cvt(lua_State *L, GVariant *var);
+// Integers are converted to strings, unless /native_ints/ is true; in that case, they are
+// converted to Lua integers (or, with Lua 5.1 and 5.2, to numbers) if they are representable
+// exactly.
+void cvt(lua_State *L, GVariant *var, bool native_ints);
@@ -38,6 +38,7 @@
 #include "bustype2idx.h"
 #include "cvt.h"
 #include "load_lualib.h"
+#include "prop_cache.h"
 #include "zoo/zoo.h"
 
 typedef struct {
@@ -91,6 +92,8 @@ typedef struct {
     bool greet;
     bool report_when_ready;
     bool no_interactive_funcs;
+    bool native_ints;
+    PropCache *pc;
     Zoo *zoo;
 } Priv;
 
@@ -103,6 +106,7 @@ static void destroy(LuastatusPluginData *pd)
     if (p->zoo) {
         zoo_destroy(p->zoo);
     }
+    prop_cache_destroy(p->pc);
     free(p);
 }
 
@@ -193,6 +197,43 @@ error:
     return -1;
 }
 
+static int parse_property_cache_elem(MoonVisit *mv, void *ud, int kpos, int vpos)
+{
+    mv->where = "'property_cache' element";
+    (void) kpos;
+
+    Priv *p = ud;
+    char *dest = NULL;
+    char *object_path = NULL;
+    char *interface = NULL;
+    int rc = -1;
+
+    if (moon_visit_checktype_at(mv, NULL, vpos, LUA_TTABLE) < 0)
+        goto done;
+
+    GBusType bus_type = G_BUS_TYPE_SESSION;
+    if (moon_visit_str_f(mv, vpos, "bus", parse_bus_str, &bus_type, true) < 0)
+        goto done;
+
+    if (moon_visit_str(mv, vpos, "dest", &dest, NULL, false) < 0)
+        goto done;
+
+    if (moon_visit_str(mv, vpos, "object_path", &object_path, NULL, false) < 0)
+        goto done;
+
+    if (moon_visit_str(mv, vpos, "interface", &interface, NULL, false) < 0)
+        goto done;
+
+    prop_cache_add(p->pc, bus_type, dest, object_path, interface);
+    rc = 1;
+
+done:
+    free(dest);
+    free(object_path);
+    free(interface);
+    return rc;
+}
+
 static int init(LuastatusPluginData *pd, lua_State *L)
 {
     Priv *p = pd->priv = LS_XNEW(Priv, 1);
@@ -202,7 +243,9 @@ static int init(LuastatusPluginData *pd, lua_State *L)
         .greet = false,
         .report_when_ready = false,
         .no_interactive_funcs = false,
-        .zoo = zoo_new(),
+        .native_ints = false,
+        .pc = prop_cache_new(),
+        .zoo = NULL,
     };
     char errbuf[256];
     MoonVisit mv = {.L = L, .errbuf = errbuf, .nerrbuf = sizeof(errbuf)};
@@ -219,6 +262,10 @@ static int init(LuastatusPluginData *pd, lua_State *L)
     if (moon_visit_bool(&mv, -1, "no_interactive_funcs", &p->no_interactive_funcs, true) < 0)
         goto mverror;
 
+    // Parse native_integers
+    if (moon_visit_bool(&mv, -1, "native_integers", &p->native_ints, true) < 0)
+        goto mverror;
+
     // Parse timeout
     if (moon_visit_num(&mv, -1, "timeout", &p->tmo, true) < 0)
         goto mverror;
@@ -227,6 +274,12 @@ static int init(LuastatusPluginData *pd, lua_State *L)
     if (moon_visit_table_f(&mv, -1, "signals", parse_signals_elem, p, false) < 0)
         goto mverror;
 
+    // Parse property_cache
+    if (moon_visit_table_f(&mv, -1, "property_cache", parse_property_cache_elem, p, true) < 0)
+        goto mverror;
+
+    p->zoo = zoo_new(p->native_ints, p->pc);
+
     return LUASTATUS_OK;
 
 mverror:
@@ -251,6 +304,7 @@ typedef struct {
     LuastatusPluginRunFuncs funcs;
     GDBusConnection *cnx_session;
     GDBusConnection *cnx_system;
+    bool native_ints;
     pthread_mutex_t mtx;
 } PluginRunArgs;
 
@@ -293,7 +347,7 @@ static void callback_signal(
     set_str(L, interface_name, "interface");
     set_str(L, signal_name, "signal");
 
-    cvt(L, parameters); // L: table value
+    cvt(L, parameters, args->native_ints); // L: table value
     lua_setfield(L, -2, "parameters"); // L: table
 
     args->funcs.call_end(args->pd->userdata);
@@ -344,7 +398,7 @@ static GDBusConnection *maybe_connect_and_subscribe(
         GError **err)
 {
     SignalList *SL = get_sub(p, bus_type);
-    if (!SL->size) {
+    if (!SL->size && !prop_cache_has_bus(p->pc, bus_type)) {
         return NULL;
     }
 
@@ -355,6 +409,8 @@ static GDBusConnection *maybe_connect_and_subscribe(
 
     LS_ASSERT(cnx != NULL);
 
+    prop_cache_subscribe(p->pc, cnx, bus_type, callback_signal, userdata);
+
     for (size_t i = 0; i < SL->size; ++i) {
         Signal s = SL->data[i];
         g_dbus_connection_signal_subscribe(
@@ -384,7 +440,7 @@ static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
     GSource *source_tmo = NULL;
     GSource *source_idle = NULL;
 
-    PluginRunArgs args = {.pd = pd, .funcs = funcs};
+    PluginRunArgs args = {.pd = pd, .funcs = funcs, .native_ints = p->native_ints};
     LS_PTH_CHECK(pthread_mutex_init(&args.mtx, NULL));
 
     session_bus = maybe_connect_and_subscribe(p, G_BUS_TYPE_SESSION, &args, &err);
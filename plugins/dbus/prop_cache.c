@@ -0,0 +1,564 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "prop_cache.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "libls/ls_alloc_utils.h"
+#include "libls/ls_panic.h"
+
+#define PROPS_IFACE "org.freedesktop.DBus.Properties"
+
+typedef struct {
+    PropCache *pc;
+
+    GBusType bus_type;
+    char *dest;
+    char *object_path;
+    char *interface;
+
+    // Maps property names (owned /gchar */) to their values (owned /GVariant */).
+    GHashTable *props;
+
+    // Set of names (owned /gchar */) of properties that have been invalidated since the entry was
+    // populated.
+    GHashTable *stale;
+
+    bool populated;
+
+    // Incremented whenever the entry is reset or a "PropertiesChanged" signal for it arrives. The
+    // D-Bus calls are made without holding the mutex; their results are only stored into the entry
+    // if this has not changed in the meantime, as otherwise they might be older than what the
+    // signal has told us.
+    uint64_t gen;
+
+    GDBusConnection *cnx;
+    guint sub_props_changed;
+    guint sub_owner_changed;
+} Entry;
+
+struct PropCache {
+    // Entries are allocated separately as their addresses are passed to signal callbacks.
+    Entry **entries;
+    size_t nentries;
+    size_t entries_alloc;
+
+    // Guards the /props/, /stale/, /populated/ and /gen/ fields of all entries. Never held during a
+    // D-Bus call.
+    pthread_mutex_t mtx;
+
+    GDBusSignalCallback notify;
+    gpointer notify_ud;
+};
+
+PropCache *prop_cache_new(void)
+{
+    PropCache *pc = LS_XNEW(PropCache, 1);
+    *pc = (PropCache) {
+        .entries = NULL,
+        .nentries = 0,
+        .entries_alloc = 0,
+        .notify = NULL,
+        .notify_ud = NULL,
+    };
+    LS_PTH_CHECK(pthread_mutex_init(&pc->mtx, NULL));
+    return pc;
+}
+
+void prop_cache_add(
+        PropCache *pc,
+        GBusType bus_type,
+        const char *dest,
+        const char *object_path,
+        const char *interface)
+{
+    Entry *e = LS_XNEW(Entry, 1);
+    *e = (Entry) {
+        .pc = pc,
+        .bus_type = bus_type,
+        .dest = ls_xstrdup(dest),
+        .object_path = ls_xstrdup(object_path),
+        .interface = ls_xstrdup(interface),
+        .props = g_hash_table_new_full(
+            g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref),
+        .stale = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL),
+        .populated = false,
+        .gen = 0,
+        .cnx = NULL,
+    };
+
+    if (pc->nentries == pc->entries_alloc) {
+        pc->entries = LS_M_X2REALLOC(pc->entries, &pc->entries_alloc);
+    }
+    pc->entries[pc->nentries++] = e;
+}
+
+bool prop_cache_has_bus(PropCache *pc, GBusType bus_type)
+{
+    for (size_t i = 0; i < pc->nentries; ++i) {
+        if (pc->entries[i]->bus_type == bus_type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Must be called with /e->pc->mtx/ locked.
+static void entry_reset(Entry *e)
+{
+    g_hash_table_remove_all(e->props);
+    g_hash_table_remove_all(e->stale);
+    e->populated = false;
+    ++e->gen;
+}
+
+static void callback_props_changed(
+    GDBusConnection *cnx,
+    const gchar *sender_name,
+    const gchar *object_path,
+    const gchar *interface_name,
+    const gchar *signal_name,
+    GVariant *parameters,
+    gpointer user_data)
+{
+    Entry *e = user_data;
+
+    if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(sa{sv}as)"))) {
+        return;
+    }
+    const gchar *iface;
+    GVariantIter *changed;
+    GVariantIter *invalidated;
+    g_variant_get(parameters, "(&sa{sv}as)", &iface, &changed, &invalidated);
+
+    LS_PTH_CHECK(pthread_mutex_lock(&e->pc->mtx));
+
+    ++e->gen;
+
+    // If the entry has not been populated yet, it will be populated with fresh values anyway.
+    if (e->populated) {
+        gchar *key;
+        GVariant *value;
+        while (g_variant_iter_next(changed, "{sv}", &key, &value)) {
+            g_hash_table_remove(e->stale, key);
+            // This takes ownership of both /key/ and /value/.
+            g_hash_table_replace(e->props, key, value);
+        }
+        gchar *name;
+        while (g_variant_iter_next(invalidated, "s", &name)) {
+            g_hash_table_remove(e->props, name);
+            // This takes ownership of /name/.
+            g_hash_table_add(e->stale, name);
+        }
+    }
+
+    LS_PTH_CHECK(pthread_mutex_unlock(&e->pc->mtx));
+
+    g_variant_iter_free(changed);
+    g_variant_iter_free(invalidated);
+
+    e->pc->notify(
+        cnx, sender_name, object_path, interface_name, signal_name, parameters,
+        e->pc->notify_ud);
+}
+
+static void callback_owner_changed(
+    GDBusConnection *cnx,
+    const gchar *sender_name,
+    const gchar *object_path,
+    const gchar *interface_name,
+    const gchar *signal_name,
+    GVariant *parameters,
+    gpointer user_data)
+{
+    (void) cnx;
+    (void) sender_name;
+    (void) object_path;
+    (void) interface_name;
+    (void) signal_name;
+    (void) parameters;
+
+    Entry *e = user_data;
+
+    LS_PTH_CHECK(pthread_mutex_lock(&e->pc->mtx));
+    entry_reset(e);
+    LS_PTH_CHECK(pthread_mutex_unlock(&e->pc->mtx));
+}
+
+void prop_cache_subscribe(
+        PropCache *pc,
+        GDBusConnection *cnx,
+        GBusType bus_type,
+        GDBusSignalCallback notify,
+        gpointer notify_ud)
+{
+    pc->notify = notify;
+    pc->notify_ud = notify_ud;
+
+    for (size_t i = 0; i < pc->nentries; ++i) {
+        Entry *e = pc->entries[i];
+        if (e->bus_type != bus_type) {
+            continue;
+        }
+        LS_ASSERT(e->cnx == NULL);
+        e->cnx = g_object_ref(cnx);
+
+        e->sub_props_changed = g_dbus_connection_signal_subscribe(
+            cnx,
+            /*sender=*/ e->dest,
+            /*interface_name=*/ PROPS_IFACE,
+            /*member=*/ "PropertiesChanged",
+            /*object_path=*/ e->object_path,
+            /*arg0=*/ e->interface,
+            /*flags=*/ G_DBUS_SIGNAL_FLAGS_NONE,
+            /*callback=*/ callback_props_changed,
+            /*user_data=*/ e,
+            /*user_data_free_func=*/ NULL);
+
+        e->sub_owner_changed = g_dbus_connection_signal_subscribe(
+            cnx,
+            /*sender=*/ "org.freedesktop.DBus",
+            /*interface_name=*/ "org.freedesktop.DBus",
+            /*member=*/ "NameOwnerChanged",
+            /*object_path=*/ "/org/freedesktop/DBus",
+            /*arg0=*/ e->dest,
+            /*flags=*/ G_DBUS_SIGNAL_FLAGS_NONE,
+            /*callback=*/ callback_owner_changed,
+            /*user_data=*/ e,
+            /*user_data_free_func=*/ NULL);
+
+        // The entry might have been populated before we subscribed; if so, changes made in between
+        // would have been missed.
+        LS_PTH_CHECK(pthread_mutex_lock(&pc->mtx));
+        entry_reset(e);
+        LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+    }
+}
+
+static Entry *find_entry(
+        PropCache *pc,
+        GBusType bus_type,
+        const char *dest,
+        const char *object_path,
+        const char *interface)
+{
+    for (size_t i = 0; i < pc->nentries; ++i) {
+        Entry *e = pc->entries[i];
+        if (e->bus_type == bus_type &&
+            strcmp(e->dest, dest) == 0 &&
+            strcmp(e->object_path, object_path) == 0 &&
+            strcmp(e->interface, interface) == 0)
+        {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+// Calls "GetAll" on /e/. Must be called with /e->pc->mtx/ unlocked.
+//
+// Returns a new reference to a value of type "(a{sv})", or /NULL/ on failure.
+static GVariant *call_get_all(
+        Entry *e,
+        GDBusConnection *cnx,
+        GDBusCallFlags flags,
+        int tmo_ms,
+        GError **err)
+{
+    return g_dbus_connection_call_sync(
+        cnx,
+        /*bus_name=*/ e->dest,
+        /*object_path=*/ e->object_path,
+        /*interface_name=*/ PROPS_IFACE,
+        /*method_name=*/ "GetAll",
+        /*parameters=*/ g_variant_new("(s)", e->interface),
+        /*reply_type=*/ G_VARIANT_TYPE("(a{sv})"),
+        /*flags=*/ flags,
+        /*timeout_ms=*/ tmo_ms,
+        /*cancellable=*/ NULL,
+        /*error=*/ err
+    );
+}
+
+// Calls "Get" on /e/. Must be called with /e->pc->mtx/ unlocked.
+//
+// Returns a new reference to a value of type "(v)", or /NULL/ on failure.
+//
+// Some services (e.g. ones written with dbus-python and an "out_signature" other than "v") reply
+// with the value itself instead of a variant wrapping it; the uncached /get_property()/ accepts
+// that, so we do too, wrapping the value into a variant ourselves.
+static GVariant *call_get(
+        Entry *e,
+        GDBusConnection *cnx,
+        const char *prop_name,
+        GDBusCallFlags flags,
+        int tmo_ms,
+        GError **err)
+{
+    GVariant *res = g_dbus_connection_call_sync(
+        cnx,
+        /*bus_name=*/ e->dest,
+        /*object_path=*/ e->object_path,
+        /*interface_name=*/ PROPS_IFACE,
+        /*method_name=*/ "Get",
+        /*parameters=*/ g_variant_new("(ss)", e->interface, prop_name),
+        /*reply_type=*/ NULL,
+        /*flags=*/ flags,
+        /*timeout_ms=*/ tmo_ms,
+        /*cancellable=*/ NULL,
+        /*error=*/ err
+    );
+    if (!res) {
+        return NULL;
+    }
+    if (g_variant_is_of_type(res, G_VARIANT_TYPE("(v)"))) {
+        return res;
+    }
+    if (g_variant_n_children(res) != 1) {
+        g_set_error(
+            err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+            "Method \"Get\" returned type \"%s\", but expected a single value",
+            g_variant_get_type_string(res));
+        g_variant_unref(res);
+        return NULL;
+    }
+    GVariant *value = g_variant_get_child_value(res, 0);
+    GVariant *r = g_variant_ref_sink(g_variant_new("(v)", value));
+    g_variant_unref(value);
+    g_variant_unref(res);
+    return r;
+}
+
+// Stores the result of "GetAll" (a value of type "(a{sv})") into /e/, replacing its content.
+//
+// Must be called with /e->pc->mtx/ locked.
+static void entry_store_all(Entry *e, GVariant *res)
+{
+    entry_reset(e);
+
+    GVariantIter *iter;
+    g_variant_get(res, "(a{sv})", &iter);
+    gchar *key;
+    GVariant *value;
+    while (g_variant_iter_next(iter, "{sv}", &key, &value)) {
+        // This takes ownership of both /key/ and /value/.
+        g_hash_table_replace(e->props, key, value);
+    }
+    g_variant_iter_free(iter);
+
+    e->populated = true;
+}
+
+// Stores the result of "Get" (a value of type "(v)") of property /prop_name/ into /e/, which must
+// be populated.
+//
+// Must be called with /e->pc->mtx/ locked.
+static void entry_store_one(Entry *e, const char *prop_name, GVariant *res)
+{
+    GVariant *value;
+    g_variant_get(res, "(v)", &value);
+
+    g_hash_table_remove(e->stale, prop_name);
+    // This takes ownership of /value/.
+    g_hash_table_replace(e->props, g_strdup(prop_name), value);
+}
+
+// Builds a value of type "(a{sv})" out of the properties of /e/.
+//
+// Must be called with /e->pc->mtx/ locked.
+static GVariant *entry_build_all(Entry *e)
+{
+    GVariantBuilder b;
+    g_variant_builder_init(&b, G_VARIANT_TYPE("a{sv}"));
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, e->props);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        g_variant_builder_add(&b, "{sv}", (const gchar *) key, (GVariant *) value);
+    }
+    return g_variant_ref_sink(g_variant_new("(a{sv})", &b));
+}
+
+static GVariant *entry_get_one(
+        Entry *e,
+        GDBusConnection *cnx,
+        const char *prop_name,
+        GDBusCallFlags flags,
+        int tmo_ms,
+        GError **err)
+{
+    PropCache *pc = e->pc;
+
+    LS_PTH_CHECK(pthread_mutex_lock(&pc->mtx));
+    bool populated = e->populated;
+    if (populated) {
+        // If the property is not in the entry, it has either been invalidated, or is not returned
+        // by "GetAll" for some reason. In the latter case, "Get" would give us a meaningful error.
+        GVariant *value = g_hash_table_lookup(e->props, prop_name);
+        if (value) {
+            GVariant *r = g_variant_ref_sink(g_variant_new("(v)", value));
+            LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+            return r;
+        }
+    }
+    uint64_t gen = e->gen;
+    LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+
+    if (!populated) {
+        GVariant *res = call_get_all(e, cnx, flags, tmo_ms, err);
+        if (!res) {
+            return NULL;
+        }
+        LS_PTH_CHECK(pthread_mutex_lock(&pc->mtx));
+        if (e->gen == gen) {
+            entry_store_all(e, res);
+        }
+        LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+
+        GVariant *props = g_variant_get_child_value(res, 0);
+        GVariant *value = g_variant_lookup_value(props, prop_name, NULL);
+        g_variant_unref(props);
+        g_variant_unref(res);
+        if (value) {
+            GVariant *r = g_variant_ref_sink(g_variant_new("(v)", value));
+            g_variant_unref(value);
+            return r;
+        }
+        // Not returned by "GetAll"; fall through to "Get".
+        LS_PTH_CHECK(pthread_mutex_lock(&pc->mtx));
+        gen = e->gen;
+        LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+    }
+
+    GVariant *res = call_get(e, cnx, prop_name, flags, tmo_ms, err);
+    if (!res) {
+        return NULL;
+    }
+    LS_PTH_CHECK(pthread_mutex_lock(&pc->mtx));
+    if (e->gen == gen && e->populated) {
+        entry_store_one(e, prop_name, res);
+    }
+    LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+    return res;
+}
+
+static GVariant *entry_get_all(
+        Entry *e,
+        GDBusConnection *cnx,
+        GDBusCallFlags flags,
+        int tmo_ms,
+        GError **err)
+{
+    PropCache *pc = e->pc;
+
+    LS_PTH_CHECK(pthread_mutex_lock(&pc->mtx));
+    if (e->populated && !g_hash_table_size(e->stale)) {
+        GVariant *r = entry_build_all(e);
+        LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+        return r;
+    }
+    uint64_t gen = e->gen;
+    LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+
+    // Either not populated, or some properties have been invalidated: refetch everything with a
+    // single "GetAll".
+    GVariant *res = call_get_all(e, cnx, flags, tmo_ms, err);
+    if (!res) {
+        return NULL;
+    }
+    LS_PTH_CHECK(pthread_mutex_lock(&pc->mtx));
+    if (e->gen == gen) {
+        entry_store_all(e, res);
+    }
+    LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+    return res;
+}
+
+GVariant *prop_cache_get(
+        PropCache *pc,
+        GDBusConnection *cnx,
+        GBusType bus_type,
+        const char *dest,
+        const char *object_path,
+        const char *interface,
+        const char *prop_name,
+        GDBusCallFlags flags,
+        int tmo_ms,
+        bool *found,
+        GError **err)
+{
+    Entry *e = find_entry(pc, bus_type, dest, object_path, interface);
+    if (!e) {
+        *found = false;
+        return NULL;
+    }
+    *found = true;
+
+    return prop_name ?
+        entry_get_one(e, cnx, prop_name, flags, tmo_ms, err) :
+        entry_get_all(e, cnx, flags, tmo_ms, err);
+}
+
+bool prop_cache_invalidate(
+        PropCache *pc,
+        GBusType bus_type,
+        const char *dest,
+        const char *object_path,
+        const char *interface)
+{
+    Entry *e = find_entry(pc, bus_type, dest, object_path, interface);
+    if (!e) {
+        return false;
+    }
+    LS_PTH_CHECK(pthread_mutex_lock(&pc->mtx));
+    entry_reset(e);
+    LS_PTH_CHECK(pthread_mutex_unlock(&pc->mtx));
+    return true;
+}
+
+void prop_cache_destroy(PropCache *pc)
+{
+    for (size_t i = 0; i < pc->nentries; ++i) {
+        Entry *e = pc->entries[i];
+        if (e->cnx) {
+            g_dbus_connection_signal_unsubscribe(e->cnx, e->sub_props_changed);
+            g_dbus_connection_signal_unsubscribe(e->cnx, e->sub_owner_changed);
+            g_object_unref(e->cnx);
+        }
+        g_hash_table_destroy(e->props);
+        g_hash_table_destroy(e->stale);
+        free(e->dest);
+        free(e->object_path);
+        free(e->interface);
+        free(e);
+    }
+    free(pc->entries);
+    LS_PTH_CHECK(pthread_mutex_destroy(&pc->mtx));
+    free(pc);
+}
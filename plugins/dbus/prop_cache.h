@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <glib.h>
+#include <gio/gio.h>
+
+// A property cache keeps the properties of a set of (bus, destination, object path, interface)
+// tuples, called "entries", up to date by listening to "PropertiesChanged" signals.
+//
+// An entry is populated with "GetAll" on first access. After that:
+//   * changed properties are merged into the entry;
+//   * an invalidated property is refetched with "Get" when it is looked up alone, and all of them
+//     with a single "GetAll" when all the properties are looked up;
+//   * if the owner of the destination name changes, the entry is reset.
+//
+// The D-Bus calls are made without holding the cache lock, so that a slow or unresponsive peer
+// does not block the signal callbacks or lookups of other entries. The result of a call is stored
+// into the entry only if neither a "PropertiesChanged" signal for it has arrived nor it has been
+// reset while the call was in flight; otherwise, the result is still returned to the caller, but
+// the newer state of the entry is kept.
+//
+// All the functions, except for /prop_cache_add()/ and /prop_cache_destroy()/, are thread-safe.
+
+struct PropCache;
+typedef struct PropCache PropCache;
+
+PropCache *prop_cache_new(void);
+
+// Adds an entry. Must not be called after /prop_cache_subscribe()/.
+void prop_cache_add(
+        PropCache *pc,
+        GBusType bus_type,
+        const char *dest,
+        const char *object_path,
+        const char *interface);
+
+// Returns true if there are entries on a bus of type /bus_type/.
+bool prop_cache_has_bus(PropCache *pc, GBusType bus_type);
+
+// Subscribes to signals needed to keep the entries on /cnx/ (a connection to a bus of type
+// /bus_type/) up to date. The signal callbacks are invoked in the thread-default main context of
+// the calling thread.
+//
+// Each "PropertiesChanged" signal is passed to /notify(..., notify_ud)/ after the corresponding
+// entry has been updated.
+void prop_cache_subscribe(
+        PropCache *pc,
+        GDBusConnection *cnx,
+        GBusType bus_type,
+        GDBusSignalCallback notify,
+        gpointer notify_ud);
+
+// Looks up the property /prop_name/ of the given entry, or, if /prop_name/ is /NULL/, all the
+// properties of the given entry, populating or refreshing the entry via /cnx/ if needed.
+//
+// Returns a new reference to a value of type "(v)" (if /prop_name/ is not /NULL/) or "(a{sv})"
+// (otherwise), that is, of the same type as the result of "Get"/"GetAll" call.
+//
+// If there is no such entry, sets /*found/ to false and returns /NULL/. Otherwise, sets /*found/ to
+// true; on failure, returns /NULL/ and sets /*err/.
+GVariant *prop_cache_get(
+        PropCache *pc,
+        GDBusConnection *cnx,
+        GBusType bus_type,
+        const char *dest,
+        const char *object_path,
+        const char *interface,
+        const char *prop_name,
+        GDBusCallFlags flags,
+        int tmo_ms,
+        bool *found,
+        GError **err);
+
+// Resets the given entry, so that it is populated again with "GetAll" on next access.
+//
+// Returns false if there is no such entry.
+bool prop_cache_invalidate(
+        PropCache *pc,
+        GBusType bus_type,
+        const char *dest,
+        const char *object_path,
+        const char *interface);
+
+void prop_cache_destroy(PropCache *pc);
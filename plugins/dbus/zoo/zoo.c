@@ -24,19 +24,29 @@
 #include <stdlib.h>
 
 #include <lua.h>
+#include <lauxlib.h>
 
 #include <glib.h>
 #include <glib-object.h>
 #include <gio/gio.h>
 
 #include "libls/ls_alloc_utils.h"
+#include "libls/ls_lua_compat.h"
 #include "libls/ls_panic.h"
 
 #include "zoo_call_params.h"
+#include "zoo_mt.h"
 #include "zoo_uncvt_type.h"
 #include "zoo_uncvt_val.h"
 #include "../cvt.h"
 #include "../bustype2idx.h"
+#include "../prop_cache.h"
+
+struct Zoo {
+    GDBusConnection *conns[2];
+    bool native_ints;
+    PropCache *pc;
+};
 
 static void failure(lua_State *L, GError *err)
 {
@@ -44,10 +54,10 @@ static void failure(lua_State *L, GError *err)
     lua_pushstring(L, err->message);
 }
 
-static void success(lua_State *L, GVariant *res)
+static void success(lua_State *L, Zoo *z, GVariant *res)
 {
     lua_pushboolean(L, 1);
-    cvt(L, res);
+    cvt(L, res, z->native_ints);
 }
 
 static const char *lookupf(Zoo_CallParams *p, const char *key)
@@ -60,9 +70,17 @@ static const char *lookupf(Zoo_CallParams *p, const char *key)
     LS_PANIC("lookupf: cannot find string field");
 }
 
-struct Zoo {
-    GDBusConnection *conns[2];
-};
+
+// Returns the connection to the bus of type /bus_type/, connecting to it if needed. On failure,
+// returns /NULL/ and sets /*err/.
+static GDBusConnection *get_conn(Zoo *z, GBusType bus_type, GError **err)
+{
+    GDBusConnection **pconn = &z->conns[bustype2idx(bus_type)];
+    if (!*pconn) {
+        *pconn = g_bus_get_sync(bus_type, NULL, err);
+    }
+    return *pconn;
+}
 
 static int do_the_bloody_thing(
     lua_State *L,
@@ -74,27 +92,22 @@ static int do_the_bloody_thing(
     const char *method_name,
     GVariant *args)
 {
-    GDBusConnection *conn = z->conns[bustype2idx(p->bus_type)];
+    GError *err = NULL;
+    GDBusConnection *conn = get_conn(z, p->bus_type, &err);
     if (!conn) {
-        GError *err = NULL;
-        conn = g_bus_get_sync(p->bus_type, NULL, &err);
-        if (!conn) {
-            LS_ASSERT(err != NULL);
-            failure(L, err);
-            g_error_free(err);
-
-            // Dispose of /args/.
-            if (g_variant_is_floating(args)) {
-                g_variant_unref(args);
-            }
-
-            return 2;
+        LS_ASSERT(err != NULL);
+        failure(L, err);
+        g_error_free(err);
+
+        // Dispose of /args/.
+        if (g_variant_is_floating(args)) {
+            g_variant_unref(args);
         }
-        LS_ASSERT(err == NULL);
-        z->conns[bustype2idx(p->bus_type)] = conn;
+
+        return 2;
     }
+    LS_ASSERT(err == NULL);
 
-    GError *err = NULL;
     GVariant *res = g_dbus_connection_call_sync(
         conn,
         /*bus_name=*/ dest,
@@ -110,7 +123,7 @@ static int do_the_bloody_thing(
     );
     if (res) {
         LS_ASSERT(err == NULL);
-        success(L, res);
+        success(L, z, res);
         g_variant_unref(res);
     } else {
         LS_ASSERT(err != NULL);
@@ -314,10 +327,372 @@ static int l_set_property(lua_State *L)
     return nret;
 }
 
-Zoo *zoo_new(void)
+// Common part of /l_get_cached_property()/ and /l_get_all_cached_properties()/.
+static int get_cached(lua_State *L, Zoo *z, Zoo_CallParams *p, const char *prop_name)
+{
+    GError *err = NULL;
+    GDBusConnection *conn = get_conn(z, p->bus_type, &err);
+    if (!conn) {
+        LS_ASSERT(err != NULL);
+        failure(L, err);
+        g_error_free(err);
+        return 2;
+    }
+
+    bool found;
+    GVariant *res = prop_cache_get(
+        z->pc, conn, p->bus_type,
+        /*dest=*/ lookupf(p, "dest"),
+        /*object_path=*/ lookupf(p, "object_path"),
+        /*interface=*/ lookupf(p, "interface"),
+        /*prop_name=*/ prop_name,
+        /*flags=*/ p->flags,
+        /*tmo_ms=*/ p->tmo_ms,
+        /*found=*/ &found,
+        /*err=*/ &err
+    );
+    if (!found) {
+        return -1;
+    }
+    if (res) {
+        LS_ASSERT(err == NULL);
+        success(L, z, res);
+        g_variant_unref(res);
+    } else {
+        LS_ASSERT(err != NULL);
+        failure(L, err);
+        g_error_free(err);
+    }
+    return 2;
+}
+
+static int l_get_cached_property(lua_State *L)
+{
+    Zoo *z = lua_touserdata(L, lua_upvalueindex(1));
+
+    Zoo_StrField str_fields[] = {
+        {.key = "dest"},
+        {.key = "object_path"},
+        {.key = "interface"},
+        {.key = "property_name"},
+        {0},
+    };
+    Zoo_CallParams p = {
+        .str_fields = str_fields,
+    };
+    zoo_call_params_parse(L, &p, 1);
+
+    int nret = get_cached(L, z, &p, lookupf(&p, "property_name"));
+    zoo_call_params_free(&p);
+    if (nret < 0) {
+        return luaL_error(L, "no such entry in property cache");
+    }
+    return nret;
+}
+
+static int l_get_all_cached_properties(lua_State *L)
+{
+    Zoo *z = lua_touserdata(L, lua_upvalueindex(1));
+
+    Zoo_StrField str_fields[] = {
+        {.key = "dest"},
+        {.key = "object_path"},
+        {.key = "interface"},
+        {0},
+    };
+    Zoo_CallParams p = {
+        .str_fields = str_fields,
+    };
+    zoo_call_params_parse(L, &p, 1);
+
+    int nret = get_cached(L, z, &p, NULL);
+    zoo_call_params_free(&p);
+    if (nret < 0) {
+        return luaL_error(L, "no such entry in property cache");
+    }
+    return nret;
+}
+
+static int l_invalidate_cached_properties(lua_State *L)
+{
+    Zoo *z = lua_touserdata(L, lua_upvalueindex(1));
+
+    Zoo_StrField str_fields[] = {
+        {.key = "dest"},
+        {.key = "object_path"},
+        {.key = "interface"},
+        {0},
+    };
+    Zoo_CallParams p = {
+        .str_fields = str_fields,
+    };
+    zoo_call_params_parse(L, &p, 1);
+
+    bool found = prop_cache_invalidate(
+        z->pc, p.bus_type,
+        /*dest=*/ lookupf(&p, "dest"),
+        /*object_path=*/ lookupf(&p, "object_path"),
+        /*interface=*/ lookupf(&p, "interface")
+    );
+    zoo_call_params_free(&p);
+    if (!found) {
+        return luaL_error(L, "no such entry in property cache");
+    }
+    return 0;
+}
+
+typedef enum {
+    MANY_CALL_METHOD,
+    MANY_GET_PROPERTY,
+    MANY_GET_ALL_PROPERTIES,
+} ManyKind;
+
+typedef struct {
+    ManyKind kind;
+    Zoo_StrField str_fields[5];
+    Zoo_CallParams p;
+
+    // Either /res/ or /err/ is set once the reply has arrived.
+    GVariant *res;
+    GError *err;
+
+    // Points to the number of calls whose replies have not arrived yet.
+    size_t *npending;
+} ManyCall;
+
+static bool many_parse_kind(lua_State *L, int pos, ManyKind *out)
+{
+    // L: ?
+    lua_getfield(L, pos, "kind"); // L: ? kind
+    bool ok = true;
+    if (lua_isnil(L, -1)) {
+        *out = MANY_CALL_METHOD;
+    } else {
+        const char *s = lua_tostring(L, -1);
+        if (!s) {
+            ok = false;
+        } else if (strcmp(s, "call_method") == 0) {
+            *out = MANY_CALL_METHOD;
+        } else if (strcmp(s, "get_property") == 0) {
+            *out = MANY_GET_PROPERTY;
+        } else if (strcmp(s, "get_all_properties") == 0) {
+            *out = MANY_GET_ALL_PROPERTIES;
+        } else {
+            ok = false;
+        }
+    }
+    lua_pop(L, 1); // L: ?
+    return ok;
+}
+
+static void many_init_params(ManyCall *c)
+{
+    Zoo_StrField *f = c->str_fields;
+    *f++ = (Zoo_StrField) {.key = "dest"};
+    *f++ = (Zoo_StrField) {.key = "object_path"};
+    *f++ = (Zoo_StrField) {.key = "interface"};
+    switch (c->kind) {
+    case MANY_CALL_METHOD:
+        *f++ = (Zoo_StrField) {.key = "method"};
+        break;
+    case MANY_GET_PROPERTY:
+        *f++ = (Zoo_StrField) {.key = "property_name"};
+        break;
+    case MANY_GET_ALL_PROPERTIES:
+        break;
+    }
+    *f = (Zoo_StrField) {0};
+
+    c->p = (Zoo_CallParams) {
+        .str_fields = c->str_fields,
+        .gvalue_field_name = c->kind == MANY_CALL_METHOD ? "args" : NULL,
+        .gvalue_field_must_be_tuple = true,
+    };
+}
+
+static void many_on_reply(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    ManyCall *c = user_data;
+    c->res = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), result, &c->err);
+    --*c->npending;
+}
+
+static void many_dispatch(Zoo *z, ManyCall *c)
+{
+    GDBusConnection *conn = get_conn(z, c->p.bus_type, &c->err);
+    if (!conn) {
+        LS_ASSERT(c->err != NULL);
+        return;
+    }
+
+    Zoo_CallParams *p = &c->p;
+    const char *interface_name;
+    const char *method_name;
+    GVariant *args;
+    switch (c->kind) {
+    case MANY_CALL_METHOD:
+        interface_name = lookupf(p, "interface");
+        method_name = lookupf(p, "method");
+        args = p->gvalue;
+        break;
+    case MANY_GET_PROPERTY:
+        interface_name = "org.freedesktop.DBus.Properties";
+        method_name = "Get";
+        args = g_variant_new("(ss)", lookupf(p, "interface"), lookupf(p, "property_name"));
+        break;
+    case MANY_GET_ALL_PROPERTIES:
+        interface_name = "org.freedesktop.DBus.Properties";
+        method_name = "GetAll";
+        args = g_variant_new("(s)", lookupf(p, "interface"));
+        break;
+    default:
+        LS_MUST_BE_UNREACHABLE();
+    }
+
+    ++*c->npending;
+    g_dbus_connection_call(
+        conn,
+        /*bus_name=*/ lookupf(p, "dest"),
+        /*object_path=*/ lookupf(p, "object_path"),
+        /*interface_name=*/ interface_name,
+        /*method_name=*/ method_name,
+        /*parameters=*/ args,
+        /*reply_type=*/ NULL,
+        /*flags=*/ p->flags,
+        /*timeout_ms=*/ p->tmo_ms,
+        /*cancellable=*/ NULL,
+        /*callback=*/ many_on_reply,
+        /*user_data=*/ c
+    );
+}
+
+static void many_free(ManyCall *calls, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        ManyCall *c = &calls[i];
+        if (c->res) {
+            g_variant_unref(c->res);
+        }
+        if (c->err) {
+            g_error_free(c->err);
+        }
+        zoo_call_params_free(&c->p);
+    }
+    free(calls);
+}
+
+static const char *MANY_BATCH_MT_NAME = "io.shdown.luastatus.plugin.dbus.official.ManyBatch";
+
+// Owns the calls of an /l_call_many()/ invocation. It lives on the Lua stack, so that the calls
+// are freed by /__gc/ if a Lua error (e.g. a memory error while pushing the results) is raised.
+typedef struct {
+    ManyCall *calls;
+    // Number of the leading elements of /calls/ that have been parsed successfully (and thus own
+    // resources to be freed).
+    size_t nparsed;
+} ManyBatch;
+
+static int many_batch_gc(lua_State *L)
+{
+    ManyBatch *b = lua_touserdata(L, 1);
+    if (b->calls) {
+        many_free(b->calls, b->nparsed);
+        b->calls = NULL;
+    }
+    return 0;
+}
+
+static void many_batch_register_mt(lua_State *L)
+{
+    zoo_mt_begin(L, MANY_BATCH_MT_NAME);
+    zoo_mt_add_method(L, "__gc", many_batch_gc);
+    zoo_mt_end(L);
+}
+
+// Takes an array of tables, each describing a call in the same way as the argument of
+// /call_method()/, /get_property()/ or /get_all_properties()/ does (which one is selected by the
+// /kind/ field, /"call_method"/ by default). Issues all the calls at once and waits for all the
+// replies, so that the whole batch takes a single round-trip.
+//
+// Returns an array of /{is_ok, result_or_error}/ pairs, in the order of the calls.
+static int l_call_many(lua_State *L)
+{
+    Zoo *z = lua_touserdata(L, lua_upvalueindex(1));
+
+    luaL_checktype(L, 1, LUA_TTABLE);
+    size_t n = ls_lua_array_len(L, 1);
+
+    ManyBatch *b = lua_newuserdata(L, sizeof(ManyBatch)); // L: ? batch
+    *b = (ManyBatch) {0};
+    luaL_getmetatable(L, MANY_BATCH_MT_NAME); // L: ? batch mt
+    lua_setmetatable(L, -2); // L: ? batch
+
+    ManyCall *calls = b->calls = LS_XNEW0(ManyCall, n);
+    size_t npending = 0;
+
+    // Parse all the calls first, so that an error in any of them means that none is made.
+    for (size_t i = 0; i < n; ++i) {
+        ManyCall *c = &calls[i];
+        c->npending = &npending;
+
+        lua_rawgeti(L, 1, i + 1); // L: ? entry
+        int pos = lua_gettop(L);
+        if (!lua_istable(L, pos)) {
+            return luaL_error(L, "call #%d: expected table, found %s", (int) (i + 1),
+                              luaL_typename(L, pos));
+        }
+        if (!many_parse_kind(L, pos, &c->kind)) {
+            return luaL_error(L, "call #%d: kind: expected either 'call_method', "
+                                 "'get_property' or 'get_all_properties'", (int) (i + 1));
+        }
+        many_init_params(c);
+        if (!zoo_call_params_parse_noerr(L, &c->p, pos)) {
+            // L: ? batch entry error
+            return lua_error(L);
+        }
+        b->nparsed = i + 1;
+        lua_pop(L, 1); // L: ? batch
+    }
+
+    // The replies are delivered to the thread-default main context at the time of the call.
+    GMainContext *ctx = g_main_context_new();
+    g_main_context_push_thread_default(ctx);
+
+    for (size_t i = 0; i < n; ++i) {
+        many_dispatch(z, &calls[i]);
+    }
+    while (npending) {
+        g_main_context_iteration(ctx, TRUE);
+    }
+
+    g_main_context_pop_thread_default(ctx);
+    g_main_context_unref(ctx);
+
+    lua_createtable(L, ls_lua_num_prealloc(n), 0); // L: ? batch result
+    for (size_t i = 0; i < n; ++i) {
+        ManyCall *c = &calls[i];
+        lua_createtable(L, 2, 0); // L: ? batch result pair
+        if (c->res) {
+            success(L, z, c->res); // L: ? batch result pair true value
+        } else {
+            LS_ASSERT(c->err != NULL);
+            failure(L, c->err); // L: ? batch result pair false message
+        }
+        lua_rawseti(L, -3, 2); // L: ? batch result pair true_or_false
+        lua_rawseti(L, -2, 1); // L: ? batch result pair
+        lua_rawseti(L, -2, i + 1); // L: ? batch result
+    }
+
+    // Free the calls right away rather than when the batch is garbage-collected.
+    many_free(calls, n);
+    b->calls = NULL;
+    return 1;
+}
+
+Zoo *zoo_new(bool native_ints, PropCache *pc)
 {
     Zoo *z = LS_XNEW(Zoo, 1);
-    *z = (Zoo) {0};
+    *z = (Zoo) {.native_ints = native_ints, .pc = pc};
     return z;
 }
 
@@ -329,6 +704,8 @@ void zoo_register_funcs(Zoo *z, lua_State *L)
     zoo_uncvt_val_register_mt_and_funcs(L); // L: ? table table
     lua_setfield(L, -2, "dbustypes_lowlevel"); // L: ? table
 
+    many_batch_register_mt(L);
+
 #define REG(Name_, F_) \
     (lua_pushlightuserdata(L, z), \
     lua_pushcclosure(L, (F_), 1), \
@@ -340,6 +717,10 @@ void zoo_register_funcs(Zoo *z, lua_State *L)
     REG("get_all_properties", l_get_all_properties);
     REG("set_property", l_set_property);
     REG("set_property_str", l_set_property_str);
+    REG("call_many", l_call_many);
+    REG("get_cached_property", l_get_cached_property);
+    REG("get_all_cached_properties", l_get_all_cached_properties);
+    REG("invalidate_cached_properties", l_invalidate_cached_properties);
 
 #undef REG
 }
@@ -20,11 +20,17 @@
 #pragma once
 
 #include <lua.h>
+#include <stdbool.h>
+
+#include "../prop_cache.h"
 
 struct Zoo;
 typedef struct Zoo Zoo;
 
-Zoo *zoo_new(void);
+// /native_ints/ is passed to /cvt()/ when converting the results of calls.
+//
+// /pc/ is borrowed and must outlive the returned object.
+Zoo *zoo_new(bool native_ints, PropCache *pc);
 
 void zoo_register_funcs(Zoo *z, lua_State *L);
 
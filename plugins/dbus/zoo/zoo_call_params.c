@@ -179,13 +179,21 @@ void zoo_call_params_free(Zoo_CallParams *p)
     }
 }
 
-void zoo_call_params_parse(lua_State *L, Zoo_CallParams *p, int arg)
+bool zoo_call_params_parse_noerr(lua_State *L, Zoo_CallParams *p, int arg)
 {
-    luaL_checktype(L, arg, LUA_TTABLE);
-
     lua_pushvalue(L, arg);
     if (!zoo_call_prot(L, 1, 0, do_parse_throwable, p)) {
         zoo_call_params_free(p);
+        return false;
+    }
+    return true;
+}
+
+void zoo_call_params_parse(lua_State *L, Zoo_CallParams *p, int arg)
+{
+    luaL_checktype(L, arg, LUA_TTABLE);
+
+    if (!zoo_call_params_parse_noerr(L, p, arg)) {
         lua_error(L);
     }
 }
@@ -44,4 +44,8 @@ typedef struct {
 
 void zoo_call_params_parse(lua_State *L, Zoo_CallParams *p, int arg);
 
+// Like /zoo_call_params_parse()/, but does not throw: on failure, frees /p/, pushes the error
+// object onto /L/'s stack and returns /false/.
+bool zoo_call_params_parse_noerr(lua_State *L, Zoo_CallParams *p, int arg);
+
 void zoo_call_params_free(Zoo_CallParams *p);
@@ -372,7 +372,7 @@ static int l_to_lua(lua_State *L)
     // /v/ is borrowed (STACK).
     GVariant *v = fetch_gvar_borrow(L, 1, "argument #1");
 
-    cvt(L, v);
+    cvt(L, v, lua_toboolean(L, 2));
     return 1;
 }
 
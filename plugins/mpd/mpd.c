@@ -56,6 +56,13 @@ typedef struct {
     char *retry_fifo;
     LS_String idle_str;
 
+    // Commands sent along with /currentsong/ and /status/ in each query.
+    LS_StringArray extra_cmds;
+
+    // The query sent after each idle wakeup: a command list of /currentsong/, /status/ and
+    // /extra_cmds/. Zero-terminated.
+    LS_String query_str;
+
     bool enable_tcp_keepalive;
     char *bind_addr;
     BindAddrFamily bind_addr_family;
@@ -68,6 +75,8 @@ static void destroy(LuastatusPluginData *pd)
     free(p->password);
     free(p->retry_fifo);
     ls_string_free(p->idle_str);
+    ls_strarr_destroy(p->extra_cmds);
+    ls_string_free(p->query_str);
     free(p->bind_addr);
     free(p);
 }
@@ -88,6 +97,37 @@ static int parse_events_elem(MoonVisit *mv, void *ud, int kpos, int vpos)
     return 1;
 }
 
+static int parse_extra_commands_elem(MoonVisit *mv, void *ud, int kpos, int vpos)
+{
+    mv->where = "'extra_commands' element";
+    (void) kpos;
+
+    Priv *p = ud;
+
+    if (moon_visit_checktype_at(mv, NULL, vpos, LUA_TSTRING) < 0)
+        return -1;
+
+    size_t ns;
+    const char *s = lua_tolstring(mv->L, vpos, &ns);
+    if (!ns || memchr(s, '\n', ns) || memchr(s, '\0', ns)) {
+        moon_visit_err(mv, "command is empty or contains a line break or a NUL character");
+        return -1;
+    }
+    ls_strarr_append_s(&p->extra_cmds, s);
+    return 1;
+}
+
+static void build_query_str(Priv *p)
+{
+    ls_string_append_s(&p->query_str, "command_list_ok_begin\ncurrentsong\nstatus\n");
+    size_t n = ls_strarr_size(p->extra_cmds);
+    for (size_t i = 0; i < n; ++i) {
+        ls_string_append_s(&p->query_str, ls_strarr_at(p->extra_cmds, i, NULL));
+        ls_string_append_c(&p->query_str, '\n');
+    }
+    ls_string_append_b(&p->query_str, "command_list_end\n", 18); // append '\n' and '\0'
+}
+
 static int parse_ipver(const char *s)
 {
     if (strcmp(s, "ipv4") == 0) {
@@ -149,6 +189,8 @@ static int init(LuastatusPluginData *pd, lua_State *L)
         .retry_tmo = 10,
         .retry_fifo = NULL,
         .idle_str = ls_string_new_from_s("idle"),
+        .extra_cmds = ls_strarr_new(),
+        .query_str = ls_string_new_reserve(128),
         .enable_tcp_keepalive = false,
         .bind_addr = NULL,
         .bind_addr_family = FAMILY_NONE,
@@ -208,6 +250,11 @@ static int init(LuastatusPluginData *pd, lua_State *L)
     }
     ls_string_append_b(&p->idle_str, "\n", 2); // append '\n' and '\0'
 
+    // Parse extra_commands
+    if (moon_visit_table_f(&mv, -1, "extra_commands", parse_extra_commands_elem, p, true) < 0)
+        goto mverror;
+    build_query_str(p);
+
     return LUASTATUS_OK;
 
 mverror:
@@ -278,8 +325,7 @@ static void log_bad_response(
 
 static int loop_until_ok(
         LuastatusPluginData *pd,
-        Context *ctx,
-        LS_StringArray *kv)
+        Context *ctx)
 {
     for (;;) {
         if (read_line(ctx) < 0) {
@@ -292,10 +338,51 @@ static int loop_until_ok(
         case RESP_ACK:
             log_bad_response(pd, ctx, "in loop");
             return -1;
+        case RESP_LIST_OK:
+        case RESP_OTHER:
+            break;
+        }
+    }
+}
+
+// Reads the response to a command list of /nkvs/ commands sent with /command_list_ok_begin/, in a
+// single pass: the data of the response to the /i/-th command is appended to /kvs[i]/.
+static int read_command_list_response(
+        LuastatusPluginData *pd,
+        Context *ctx,
+        LS_StringArray *kvs,
+        size_t nkvs)
+{
+    size_t i = 0;
+    for (;;) {
+        if (read_line(ctx) < 0) {
+            log_io_error(pd, ctx);
+            return -1;
+        }
+        switch (response_type(ctx->line_v)) {
+        case RESP_OK:
+            if (i != nkvs) {
+                log_bad_response(pd, ctx, "premature end of command list");
+                return -1;
+            }
+            return 0;
+        case RESP_ACK:
+            log_bad_response(pd, ctx, "to command list");
+            return -1;
+        case RESP_LIST_OK:
+            if (i == nkvs) {
+                log_bad_response(pd, ctx, "excess list_OK");
+                return -1;
+            }
+            ++i;
+            break;
         case RESP_OTHER:
-            if (kv) {
-                append_line_to_kv_strarr(kv, ctx->line_v);
+            if (i == nkvs) {
+                log_bad_response(pd, ctx, "after the last list_OK");
+                return -1;
             }
+            append_line_to_kv_strarr(&kvs[i], ctx->line_v);
+            break;
         }
     }
 }
@@ -312,8 +399,13 @@ static void interact(
         .LR = line_reader_new(1024),
         .line_v = SAFEV_new_empty(),
     };
-    LS_StringArray kv_song   = ls_strarr_new();
-    LS_StringArray kv_status = ls_strarr_new();
+    // /kvs[0]/ is for /currentsong/, /kvs[1]/ is for /status/, the rest are for /p->extra_cmds/.
+    size_t nextra = ls_strarr_size(p->extra_cmds);
+    size_t nkvs = 2 + nextra;
+    LS_StringArray *kvs = LS_XNEW(LS_StringArray, nkvs);
+    for (size_t i = 0; i < nkvs; ++i) {
+        kvs[i] = ls_strarr_new();
+    }
     int fd_to_close = fd;
 
     if (!(ctx.f = fdopen(fd, "r+"))) {
@@ -358,48 +450,47 @@ static void interact(
     LS_TimeDelta tmo = ls_double_to_TD(p->tmo, LS_TD_FOREVER);
 
     for (;;) {
-        // write "currentsong\n"
-        fputs("currentsong\n", ctx.f);
-        fflush(ctx.f);
-        if (ferror(ctx.f)) {
-            log_io_error(pd, &ctx);
-            goto done;
-        }
-
-        // until OK, append data to 'kv_song'
-        if (loop_until_ok(pd, &ctx, &kv_song) < 0)
-            goto done;
-
-        // write "status\n"
-        fputs("status\n", ctx.f);
+        // write the query (a command list of "currentsong", "status" and extra commands), so that
+        // all of them take a single round-trip
+        fputs(p->query_str.data, ctx.f);
         fflush(ctx.f);
         if (ferror(ctx.f)) {
             log_io_error(pd, &ctx);
             goto done;
         }
 
-        // until OK, append data to 'kv_status'
-        if (loop_until_ok(pd, &ctx, &kv_status) < 0)
+        // until OK, append data to 'kvs'
+        if (read_command_list_response(pd, &ctx, kvs, nkvs) < 0)
             goto done;
 
         // make a call
         lua_State *L = funcs.call_begin(pd->userdata);
-        lua_createtable(L, 0, 3); // L: table
+        lua_createtable(L, 0, 4); // L: table
 
         lua_pushstring(L, "update"); // L: table "update"
         lua_setfield(L, -2, "what"); // L: table
 
-        kv_strarr_table_push(kv_song, L); // L: table table
+        kv_strarr_table_push(kvs[0], L); // L: table table
         lua_setfield(L, -2, "song"); // L: table
 
-        kv_strarr_table_push(kv_status, L); // L: table table
+        kv_strarr_table_push(kvs[1], L); // L: table table
         lua_setfield(L, -2, "status"); // L: table
 
+        if (nextra) {
+            lua_createtable(L, 0, nextra); // L: table extra
+            for (size_t i = 0; i < nextra; ++i) {
+                kv_strarr_table_push(kvs[2 + i], L); // L: table extra table
+                lua_setfield(L, -2, ls_strarr_at(p->extra_cmds, i, NULL)); // L: table extra
+            }
+            lua_setfield(L, -2, "extra"); // L: table
+        }
+
         funcs.call_end(pd->userdata);
 
         // clear the arrays
-        ls_strarr_clear(&kv_status);
-        ls_strarr_clear(&kv_song);
+        for (size_t i = 0; i < nkvs; ++i) {
+            ls_strarr_clear(&kvs[i]);
+        }
 
         // write the idle string ("idle <...list of events...>\n")
         fputs(p->idle_str.data, ctx.f);
@@ -425,7 +516,7 @@ static void interact(
         }
 
         // wait for an OK
-        if (loop_until_ok(pd, &ctx, NULL) < 0)
+        if (loop_until_ok(pd, &ctx) < 0)
             goto done;
     }
 
@@ -435,8 +526,10 @@ done:
     }
     ls_close(fd_to_close);
     line_reader_destroy(&ctx.LR);
-    ls_strarr_destroy(kv_song);
-    ls_strarr_destroy(kv_status);
+    for (size_t i = 0; i < nkvs; ++i) {
+        ls_strarr_destroy(kvs[i]);
+    }
+    free(kvs);
 }
 
 static void do_enable_tcp_keepalive(LuastatusPluginData *pd, int fd)
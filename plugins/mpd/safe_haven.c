@@ -35,6 +35,9 @@ ResponseType response_type(SAFEV v)
     if (SAFEV_equals(v, LIT("OK"))) {
         return RESP_OK;
     }
+    if (SAFEV_equals(v, LIT("list_OK"))) {
+        return RESP_LIST_OK;
+    }
     if (SAFEV_starts_with(v, LIT("ACK "))) {
         return RESP_ACK;
     }
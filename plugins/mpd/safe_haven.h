@@ -26,6 +26,7 @@
 
 typedef enum {
     RESP_OK,
+    RESP_LIST_OK,
     RESP_ACK,
     RESP_OTHER,
 } ResponseType;
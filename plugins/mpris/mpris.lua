@@ -41,16 +41,23 @@ local function print_warning(what)
     print(string.format('WARNING: luastatus: mpris plugin: %s', what))
 end
 
-local function storage_requery(storage)
+local function storage_requery(storage, forced)
     storage.current_data = {}
 
-    local is_ok, res_raw = luastatus.plugin.get_all_properties({
+    local params = {
         bus = 'session',
         flag_no_autostart = true,
         dest = 'org.mpris.MediaPlayer2.' .. storage.player,
         object_path = '/org/mpris/MediaPlayer2',
         interface = 'org.mpris.MediaPlayer2.Player',
-    })
+    }
+
+    if forced then
+        -- Some properties (e.g. 'Position') change without 'PropertiesChanged' being emitted.
+        luastatus.plugin.invalidate_cached_properties(params)
+    end
+
+    local is_ok, res_raw = luastatus.plugin.get_all_cached_properties(params)
     if not is_ok then
         print_warning(string.format('cannot get properties: %s', res_raw))
         return
@@ -59,18 +66,6 @@ local function storage_requery(storage)
     mix_into(storage.current_data, unwrap1_into_table(res_raw), true)
 end
 
-local function storage_handle_update(storage, parameters)
-    local changed_props = parameters[2]
-    local invalidated_props = parameters[3]
-
-    if #invalidated_props > 0 then
-        storage_requery(storage)
-        return
-    end
-
-    mix_into(storage.current_data, changed_props, true)
-end
-
 local P = {}
 
 function P.widget(tbl)
@@ -84,26 +79,20 @@ function P.widget(tbl)
     return {
         plugin = 'dbus',
         opts = {
-            signals = {
+            signals = {},
+            property_cache = {
                 {
                     bus = 'session',
-                    sender = 'org.mpris.MediaPlayer2.' .. tbl.player,
-                    interface = 'org.freedesktop.DBus.Properties',
-                    signal = 'PropertiesChanged',
+                    dest = 'org.mpris.MediaPlayer2.' .. tbl.player,
                     object_path = '/org/mpris/MediaPlayer2',
-                    arg0 = 'org.mpris.MediaPlayer2.Player',
+                    interface = 'org.mpris.MediaPlayer2.Player',
                 },
             },
             timeout = tbl.forced_refresh_interval or 30,
             report_when_ready = true,
         },
         cb = function(t)
-            if t.what == 'signal' then
-                storage_handle_update(storage, t.parameters)
-            else
-                storage_requery(storage)
-            end
-
+            storage_requery(storage, t.what == 'timeout')
             return tbl.cb(storage.current_data)
         end,
         event = tbl.event,
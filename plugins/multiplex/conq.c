@@ -20,41 +20,59 @@
 #include "conq.h"
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include <pthread.h>
 
 #include "libls/ls_alloc_utils.h"
 #include "libls/ls_panic.h"
 #include "libls/ls_string.h"
 
+typedef struct {
+    // These are only accessed by the producer of the slot.
+    LS_String last;
+    char last_state;
+    LS_String spare;
+
+    // These are protected by /mtx/.
+    LS_String pending;
+    char pending_state;
+    bool dirty;
+} Slot;
+
 struct Conq {
     pthread_mutex_t mtx;
     pthread_cond_t condvar;
 
-    LS_String *slots;
+    Slot *slots;
     size_t nslots;
 
-    char slot_states[CONQ_MAX_SLOTS];
-
-    CONQ_MASK new_data_mask;
+    // Indices of slots with /dirty/ set; protected by /mtx/.
+    size_t *dirty_idxs;
+    size_t ndirty;
 };
 
 Conq *conq_create(size_t nslots)
 {
-    LS_ASSERT(nslots <= CONQ_MAX_SLOTS);
-
     Conq *q = LS_XNEW(Conq, 1);
 
     LS_PTH_CHECK(pthread_mutex_init(&q->mtx, NULL));
     LS_PTH_CHECK(pthread_cond_init(&q->condvar, NULL));
 
-    q->slots = LS_XNEW(LS_String, nslots);
+    q->slots = LS_XNEW(Slot, nslots);
     for (size_t i = 0; i < nslots; ++i) {
-        q->slots[i] = ls_string_new_reserve(1024);
-        q->slot_states[i] = CONQ_SLOT_STATE_EMPTY;
+        q->slots[i] = (Slot) {
+            .last = ls_string_new_reserve(512),
+            .last_state = CONQ_SLOT_STATE_EMPTY,
+            .spare = ls_string_new_reserve(512),
+            .pending = ls_string_new_reserve(512),
+            .pending_state = CONQ_SLOT_STATE_EMPTY,
+            .dirty = false,
+        };
     }
     q->nslots = nslots;
 
-    q->new_data_mask = 0;
+    q->dirty_idxs = LS_XNEW(size_t, nslots);
+    q->ndirty = 0;
 
     return q;
 }
@@ -67,48 +85,69 @@ void conq_update_slot(
 {
     LS_ASSERT(slot_idx < q->nslots);
 
-    LS_PTH_CHECK(pthread_mutex_lock(&q->mtx));
+    Slot *s = &q->slots[slot_idx];
 
-    LS_String *old = &q->slots[slot_idx];
-    ConqSlotState old_state = q->slot_states[slot_idx];
-    if (ls_string_eq_b(*old, buf, nbuf) && old_state == state) {
-        goto unlock;
+    if (ls_string_eq_b(s->last, buf, nbuf) && s->last_state == (char) state) {
+        return;
     }
-    ls_string_assign_b(old, buf, nbuf);
-    q->slot_states[slot_idx] = state;
+    ls_string_assign_b(&s->last, buf, nbuf);
+    s->last_state = state;
+
+    ls_string_assign_b(&s->spare, buf, nbuf);
 
-    q->new_data_mask |= ((CONQ_MASK) 1) << slot_idx;
+    LS_PTH_CHECK(pthread_mutex_lock(&q->mtx));
+
+    ls_string_swap(&s->spare, &s->pending);
+    s->pending_state = state;
+
+    if (!s->dirty) {
+        s->dirty = true;
+        q->dirty_idxs[q->ndirty++] = slot_idx;
+    }
     LS_PTH_CHECK(pthread_cond_signal(&q->condvar));
 
-unlock:
     LS_PTH_CHECK(pthread_mutex_unlock(&q->mtx));
 }
 
-CONQ_MASK conq_fetch_updates(
+void conq_wait_for_updates(Conq *q)
+{
+    LS_PTH_CHECK(pthread_mutex_lock(&q->mtx));
+
+    while (!q->ndirty) {
+        LS_PTH_CHECK(pthread_cond_wait(&q->condvar, &q->mtx));
+    }
+
+    LS_PTH_CHECK(pthread_mutex_unlock(&q->mtx));
+}
+
+size_t conq_fetch_updates(
     Conq *q,
     LS_String *out,
-    ConqSlotState *out_states)
+    ConqSlotState *out_states,
+    size_t *out_idxs)
 {
     LS_PTH_CHECK(pthread_mutex_lock(&q->mtx));
 
-    CONQ_MASK mask;
-    while (!(mask = q->new_data_mask)) {
+    while (!q->ndirty) {
         LS_PTH_CHECK(pthread_cond_wait(&q->condvar, &q->mtx));
     }
 
-    for (size_t i = 0; i < q->nslots; ++i) {
-        if ((mask >> i) & 1) {
-            LS_String slot = q->slots[i];
-            ls_string_assign_b(&out[i], slot.data, slot.size);
-            out_states[i] = q->slot_states[i];
-        }
-    }
+    size_t n = q->ndirty;
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = q->dirty_idxs[k];
+        Slot *s = &q->slots[i];
+
+        ls_string_swap(&out[i], &s->pending);
+        out_states[i] = s->pending_state;
+        s->dirty = false;
 
-    q->new_data_mask = 0;
+        out_idxs[k] = i;
+    }
+    q->ndirty = 0;
 
     LS_PTH_CHECK(pthread_mutex_unlock(&q->mtx));
 
-    return mask;
+    return n;
 }
 
 void conq_destroy(Conq *q)
@@ -117,10 +156,14 @@ void conq_destroy(Conq *q)
     LS_PTH_CHECK(pthread_cond_destroy(&q->condvar));
 
     for (size_t i = 0; i < q->nslots; ++i) {
-        ls_string_free(q->slots[i]);
+        Slot *s = &q->slots[i];
+        ls_string_free(s->last);
+        ls_string_free(s->spare);
+        ls_string_free(s->pending);
     }
-
     free(q->slots);
 
+    free(q->dirty_idxs);
+
     free(q);
 }
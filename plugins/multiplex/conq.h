@@ -19,20 +19,19 @@
 
 #pragma once
 
-#include <stdint.h>
-#include <stdlib.h>
+#include <stddef.h>
 #include "libls/ls_string.h"
 
 // A concurrent queue.
 //
-// Instead of single value, it maintains a list of /LS_String/s,
+// Instead of single value, it maintains a list of /LS_String/s ("slots"),
 // each of which might get "updated" independently.
 //
-// The size of the list is limited to /CONQ_MAX_SLOTS/.
-
-typedef uint64_t CONQ_MASK;
-
-enum { CONQ_MAX_SLOTS = sizeof(CONQ_MASK) * 8 };
+// Each slot is double-buffered: a producer copies the new value into a spare buffer of the slot
+// without holding the lock, and then only swaps buffers under the lock; the consumer, in turn,
+// swaps the pending buffers with its own ones. Thus the lock is never held while copying data, and
+// is held for a time proportional to the number of slots updated, not to the total number of
+// slots.
 
 // These must be >= 0 and < 128.
 typedef enum {
@@ -50,15 +49,28 @@ typedef struct Conq Conq;
 
 Conq *conq_create(size_t nslots);
 
+// Updates slot /slot_idx/, unless it already has the given value and state.
+//
+// May be called concurrently for different slots, but not for the same slot.
 void conq_update_slot(
     Conq *q,
     size_t slot_idx,
     const char *buf, size_t nbuf,
     ConqSlotState state);
 
-CONQ_MASK conq_fetch_updates(
+// Waits until at least one slot is updated since the last call to /conq_fetch_updates()/.
+void conq_wait_for_updates(Conq *q);
+
+// Waits until at least one slot is updated; then, for each slot /i/ updated since the last call,
+// swaps the contents of /out[i]/ with the new value of the slot (so that the previous contents of
+// /out[i]/ are lost) and sets /out_states[i]/.
+//
+// Writes indices of the updated slots to /out_idxs/ (which must have room for /nslots/ elements)
+// and returns their number.
+size_t conq_fetch_updates(
     Conq *q,
     LS_String *out,
-    ConqSlotState *out_states);
+    ConqSlotState *out_states,
+    size_t *out_idxs);
 
 void conq_destroy(Conq *q);
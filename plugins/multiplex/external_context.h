@@ -19,6 +19,6 @@
 
 #pragma once
 
-#include "include/plugin_data_v1.h"
+#include "include/plugin_data.h"
 
 typedef LuastatusPluginData_v1 *ExternalContext;
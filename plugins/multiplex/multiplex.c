@@ -30,8 +30,10 @@
 #include "libls/ls_tls_ebuf.h"
 #include "libls/ls_alloc_utils.h"
 #include "libls/ls_string.h"
+#include "libls/ls_time_utils.h"
+#include "libls/ls_chunk_cache.h"
 
-#include "include/plugin_v1.h"
+#include "include/plugin_v2.h"
 #include "include/sayf_macros.h"
 
 #include "libmoonvisit/moonvisit.h"
@@ -54,6 +56,9 @@ static void destroy(LuastatusPluginData *pd)
     map_ref_destroy(p->map_ref);
 
     free(p);
+
+    // The runners load derived plugins through this plugin's own copy of the chunk cache.
+    ls_chunk_cache_clear();
 }
 
 static int visit_wspec(MoonVisit *mv, void *ud, int kpos, int vpos)
@@ -87,14 +92,6 @@ static bool check_wspecs(WspecList *x, char *errbuf, size_t nerrbuf)
         snprintf(errbuf, nerrbuf, "data_sources table is empty");
         return false;
     }
-    if (n > CONQ_MAX_SLOTS) {
-        snprintf(
-            errbuf, nerrbuf,
-            "too many data sources (%zu, limit is %d)",
-            n, (int) CONQ_MAX_SLOTS
-        );
-        return false;
-    }
 
     const char *dup = wspec_list_find_duplicates(x);
     if (dup) {
@@ -111,6 +108,9 @@ static int init(LuastatusPluginData *pd, lua_State *L)
     *p = (Priv) {
         .wspecs = wspec_list_new(),
         .greet = false,
+        .lua_states = 0,
+        .min_interval = 0,
+        .max_latency = 0,
         .runners = NULL,
         .map_ref = map_ref_new_empty(),
     };
@@ -133,11 +133,34 @@ static int init(LuastatusPluginData *pd, lua_State *L)
         goto mverror;
     }
 
+    // Parse lua_states
+    if (moon_visit_uint(&mv, -1, "lua_states", &p->lua_states, true) < 0) {
+        goto mverror;
+    }
+
+    // Parse min_interval
+    if (moon_visit_num(&mv, -1, "min_interval", &p->min_interval, true) < 0) {
+        goto mverror;
+    }
+    if (!ls_double_is_good_time_delta(p->min_interval) || p->min_interval > LS_TMO_MAX) {
+        LS_FATALF(pd, "min_interval is invalid");
+        goto error;
+    }
+
+    // Parse max_latency
+    if (moon_visit_num(&mv, -1, "max_latency", &p->max_latency, true) < 0) {
+        goto mverror;
+    }
+    if (!ls_double_is_good_time_delta(p->max_latency) || p->max_latency > LS_TMO_MAX) {
+        LS_FATALF(pd, "max_latency is invalid");
+        goto error;
+    }
+
     return LUASTATUS_OK;
 
 mverror:
     LS_FATALF(pd, "%s", errbuf);
-//error:
+error:
     destroy(pd);
     return LUASTATUS_ERR;
 }
@@ -316,8 +339,8 @@ static void push_update(lua_State *L, const LS_String *buf, ConqSlotState state)
 static void make_call_update(
         LuastatusPluginData *pd,
         LuastatusPluginRunFuncs funcs,
-        size_t n,
-        CONQ_MASK mask,
+        const size_t *idxs,
+        size_t nidxs,
         LS_String *bufs,
         ConqSlotState *states)
 {
@@ -331,12 +354,11 @@ static void make_call_update(
     lua_setfield(L, -2, "what"); // L: table
 
     lua_newtable(L); // L: table table
-    for (size_t i = 0; i < n; ++i) {
-        if ((mask >> i) & 1) {
-            push_update(L, &bufs[i], states[i]); // L: table table value
-            const char *key = wspec_list_get_name(&p->wspecs, i);
-            lua_setfield(L, -2, key); // L: table table
-        }
+    for (size_t k = 0; k < nidxs; ++k) {
+        size_t i = idxs[k];
+        push_update(L, &bufs[i], states[i]); // L: table table value
+        const char *key = wspec_list_get_name(&p->wspecs, i);
+        lua_setfield(L, -2, key); // L: table table
     }
 
     lua_setfield(L, -2, "updates"); // L: table
@@ -344,6 +366,24 @@ static void make_call_update(
     funcs.call_end(pd->userdata);
 }
 
+// Called when there are new updates; sleeps so that the updates arriving meanwhile get batched
+// with them: for /max_latency/, and also until /min_interval/ has passed since /last_call/ (unless
+// it is bad).
+static void wait_for_more_updates(Priv *p, LS_TimeStamp last_call)
+{
+    double wait = p->max_latency;
+    if (!ls_TS_is_bad(last_call)) {
+        LS_TimeDelta since_last_call = ls_TS_minus_TS_nonneg(ls_now(), last_call);
+        double until_allowed = p->min_interval - since_last_call.delta;
+        if (until_allowed > wait) {
+            wait = until_allowed;
+        }
+    }
+    if (wait > 0) {
+        ls_sleep(ls_double_to_TD_or_die(wait));
+    }
+}
+
 static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
 {
     Priv *p = pd->priv;
@@ -352,6 +392,12 @@ static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
 
     runtime_data_init(&p->rtdata, pd, n);
 
+    size_t nstates = p->lua_states < n ? p->lua_states : n;
+    RunnerLuaState **lua_states = LS_XNEW(RunnerLuaState *, nstates);
+    for (size_t i = 0; i < nstates; ++i) {
+        lua_states[i] = runner_lua_state_new();
+    }
+
     map_ref_lock_mtx(p->map_ref);
 
     for (size_t i = 0; i < n; ++i) {
@@ -362,6 +408,7 @@ static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
             name,
             code,
             pd,
+            nstates ? lua_states[i % nstates] : NULL,
             recv_callback,
             &p->rtdata.u_uds[i]
         );
@@ -372,6 +419,12 @@ static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
 
     map_ref_unlock_mtx(p->map_ref);
 
+    // Now only the runners hold references to the shared instances.
+    for (size_t i = 0; i < nstates; ++i) {
+        runner_lua_state_unref(lua_states[i]);
+    }
+    free(lua_states);
+
     LS_PTH_CHECK(pthread_mutex_lock(&p->runners_mtx));
     p->runners = p->rtdata.runners;
     LS_PTH_CHECK(pthread_mutex_unlock(&p->runners_mtx));
@@ -399,13 +452,24 @@ static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
     Conq *cq = p->rtdata.cq;
     LS_String *bufs = p->rtdata.bufs;
     ConqSlotState *states = p->rtdata.states;
+    size_t *idxs = p->rtdata.idxs;
+    bool throttle = p->min_interval > 0 || p->max_latency > 0;
+    LS_TimeStamp last_call = LS_TS_BAD;
     for (;;) {
-        CONQ_MASK mask = conq_fetch_updates(cq, bufs, states);
-        make_call_update(pd, funcs, n, mask, bufs, states);
+        funcs.call_idle(pd->userdata);
+        if (throttle) {
+            conq_wait_for_updates(cq);
+            wait_for_more_updates(p, last_call);
+        }
+        size_t nidxs = conq_fetch_updates(cq, bufs, states, idxs);
+        make_call_update(pd, funcs, idxs, nidxs, bufs, states);
+        if (throttle) {
+            last_call = ls_now();
+        }
     }
 }
 
-LuastatusPluginIface luastatus_plugin_iface_v1 = {
+LuastatusPluginIface luastatus_plugin_iface_v2 = {
     .init = init,
     .register_funcs = register_funcs,
     .run = run,
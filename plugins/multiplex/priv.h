@@ -20,6 +20,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <pthread.h>
 #include "wspec_list.h"
 #include "runtime_data.h"
@@ -29,6 +30,9 @@
 typedef struct {
     WspecList wspecs;
     bool greet;
+    uint64_t lua_states;
+    double min_interval;
+    double max_latency;
 
     pthread_mutex_t runners_mtx;
     Runner **runners;
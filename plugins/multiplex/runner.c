@@ -30,13 +30,14 @@
 #include <unistd.h>
 #include <dlfcn.h>
 
-#include "include/plugin_data_v1.h"
+#include "include/plugin_data.h"
 
 #include "libls/ls_panic.h"
 #include "libls/ls_xallocf.h"
 #include "libls/ls_alloc_utils.h"
 #include "libls/ls_getenv_r.h"
 #include "libls/ls_lua_compat.h"
+#include "libls/ls_chunk_cache.h"
 
 #include "librunshell/runshell.h"
 #include "libwidechar/libwidechar.h"
@@ -55,14 +56,28 @@
 #define DEBUGF(Runner_, ...)    my_sayf(Runner_, LUASTATUS_LOG_DEBUG,    __VA_ARGS__)
 #define TRACEF(Runner_, ...)    my_sayf(Runner_, LUASTATUS_LOG_TRACE,    __VA_ARGS__)
 
-#define LOCK_L(W_)   LS_PTH_CHECK(pthread_mutex_lock(&(W_)->L_mtx))
-#define UNLOCK_L(W_) LS_PTH_CHECK(pthread_mutex_unlock(&(W_)->L_mtx))
+#define LOCK_L(W_)   LS_PTH_CHECK(pthread_mutex_lock(&(W_)->S->mtx))
+#define UNLOCK_L(W_) LS_PTH_CHECK(pthread_mutex_unlock(&(W_)->S->mtx))
 
 enum { SAYF_BUF_SIZE = 1024 };
 
+struct RunnerLuaState {
+    // The Lua interpreter instance. The bottom of its stack is always occupied by
+    // /l_error_handler/.
+    lua_State *L;
+
+    // A mutex guarding /L/.
+    pthread_mutex_t mtx;
+
+    // Number of references to this object.
+    size_t nrefs;
+};
+
 typedef struct {
-    // The interface loaded from this plugin's .so file.
-    LuastatusPluginIface_v1 iface;
+    // The interface loaded from this plugin's .so file. For a plugin that only provides the first
+    // version of the interface, /iface.run/ is /NULL/, and /run_v1/ is set instead.
+    LuastatusPluginIface_v2 iface;
+    void (*run_v1)(LuastatusPluginData_v1 *pd, LuastatusPluginRunFuncs_v1 funcs);
 
     // An allocated zero-terminated string with plugin name, as specified in widget's
     // /widget.plugin/ string.
@@ -79,11 +94,16 @@ typedef struct {
     // /plugin/'s data for this widget.
     LuastatusPluginData_v1 data;
 
-    // This widget's Lua interpreter instance.
+    // This widget's Lua interpreter instance, possibly shared with other widgets.
+    RunnerLuaState *S;
+
+    // Same as /S->L/.
     lua_State *L;
 
-    // A mutex guarding /L/.
-    pthread_mutex_t L_mtx;
+    // Lua reference (in /L/'s registry) to this widget's environment table, if /S/ is shared;
+    // otherwise, /LUA_NOREF/, and this widget's code is run with /L/'s global table as the
+    // environment.
+    int lref_env;
 
     // Lua reference (in /L/'s registry) to this widget's /widget.cb/ function.
     int lref_cb;
@@ -184,12 +204,24 @@ static bool plugin_load(Runner *runner, Plugin *p, const char *filename, const c
              filename, *p_lua_ver, LUA_VERSION_NUM);
         goto error;
     }
-    LuastatusPluginIface_v1 *p_iface = dlsym(p->dlhandle, "luastatus_plugin_iface_v1");
-    if (!p_iface) {
-        ERRF(runner, "dlsym: luastatus_plugin_iface_v1: %s", safe_dlerror());
-        goto error;
+    LuastatusPluginIface_v2 *p_iface_v2 = dlsym(p->dlhandle, "luastatus_plugin_iface_v2");
+    if (p_iface_v2) {
+        p->iface = *p_iface_v2;
+        p->run_v1 = NULL;
+    } else {
+        LuastatusPluginIface_v1 *p_iface = dlsym(p->dlhandle, "luastatus_plugin_iface_v1");
+        if (!p_iface) {
+            ERRF(runner, "dlsym: luastatus_plugin_iface_v1: %s", safe_dlerror());
+            goto error;
+        }
+        p->iface = (LuastatusPluginIface_v2) {
+            .init = p_iface->init,
+            .register_funcs = p_iface->register_funcs,
+            .run = NULL,
+            .destroy = p_iface->destroy,
+        };
+        p->run_v1 = p_iface->run;
     }
-    p->iface = *p_iface;
     DEBUGF(runner, "plugin successfully loaded");
     return true;
 
@@ -323,8 +355,9 @@ static int l_os_setlocale(lua_State *L)
     return 1;
 }
 
-// Implementation of /luastatus.require_plugin()/. Expects a single upvalue: an initially empty
-// table that will be used as a registry of loaded Lua plugins.
+// Implementation of /luastatus.require_plugin()/. Expects an upvalue: an initially empty table
+// that will be used as a registry of loaded Lua plugins; and, optionally, another upvalue: the
+// environment table to load the plugins in.
 static int l_require_plugin(lua_State *L)
 {
     const char *arg = luaL_checkstring(L, 1);
@@ -339,13 +372,17 @@ static int l_require_plugin(lua_State *L)
     lua_pop(L, 1); // L: ? table
 
     char *filename = ls_xallocf("%s/%s.lua", LUASTATUS_LUA_PLUGINS_DIR, arg);
-    int r = luaL_loadfile(L, filename);
+    int r = ls_chunk_cache_loadfile(L, filename);
     free(filename);
     if (r != 0) {
         return lua_error(L);
     }
 
     // L: ? table chunk
+    if (lua_istable(L, lua_upvalueindex(2))) {
+        lua_pushvalue(L, lua_upvalueindex(2)); // L: ? table chunk env
+        ls_lua_setchunkenv(L, -2); // L: ? table chunk
+    }
     lua_call(L, 0, 1); // L: ? table result
     lua_pushvalue(L, -1); // L: ? table result result
     lua_setfield(L, -3, arg); // L: ? table result
@@ -378,34 +415,117 @@ static void inject_libs_replacements(lua_State *L)
     lua_pop(L, 1); // L: ?
 }
 
-static void inject_luastatus_module(lua_State *L)
+// Pushes the /luastatus/ module, except for the /luastatus.plugin/ and /luastatus.barlib/
+// submodules (created later).
+//
+// If /env_pos/ is not zero, it is the (absolute) stack position of the environment table that the
+// Lua plugins loaded with /luastatus.require_plugin()/ are to be run in.
+static void push_luastatus_module(lua_State *L, int env_pos)
 {
-    lua_createtable(L, 0, 4); // L: ? table
+    lua_createtable(L, 0, 5); // L: ? table
 
     // ========== require_plugin ==========
     lua_newtable(L); // L: ? table table
-    lua_pushcclosure(L, l_require_plugin, 1); // L: ? table l_require_plugin
+    if (env_pos) {
+        lua_pushvalue(L, env_pos); // L: ? table table env
+        lua_pushcclosure(L, l_require_plugin, 2); // L: ? table l_require_plugin
+    } else {
+        lua_pushcclosure(L, l_require_plugin, 1); // L: ? table l_require_plugin
+    }
     lua_setfield(L, -2, "require_plugin"); // L: ? table
 
     // ========== execute ==========
-    lua_pushcfunction(L, runshell_l_os_execute); // L: ? table cfunction
+    lua_pushcfunction(L, runshell_l_execute); // L: ? table cfunction
     lua_setfield(L, -2, "execute"); // L: ? table
 
+    // ========== spawn ==========
+    lua_pushcfunction(L, runshell_l_spawn); // L: ? table cfunction
+    lua_setfield(L, -2, "spawn"); // L: ? table
+
     // ========== libwidechar ==========
     lua_newtable(L); // L: ? table table
     libwidechar_register_lua_funcs(L); // L: ? table table
     lua_setfield(L, -2, "libwidechar"); // L: ? table
+}
+
+RunnerLuaState *runner_lua_state_new(void)
+{
+    RunnerLuaState *S = LS_XNEW(RunnerLuaState, 1);
+    S->L = xnew_lua_state();
+    LS_PTH_CHECK(pthread_mutex_init(&S->mtx, NULL));
+    S->nrefs = 1;
+
+    luaL_openlibs(S->L);
+    // S->L: -
+    inject_libs_replacements(S->L); // S->L: -
+    lua_pushcfunction(S->L, l_error_handler); // S->L: l_error_handler
+
+    return S;
+}
 
-    lua_setglobal(L, "luastatus"); // L: ?
+void runner_lua_state_unref(RunnerLuaState *S)
+{
+    LS_ASSERT(S->nrefs != 0);
+    if (--S->nrefs) {
+        return;
+    }
+    lua_close(S->L);
+    LS_PTH_CHECK(pthread_mutex_destroy(&S->mtx));
+    free(S);
+}
+
+// Pushes the value of the global variable /name/, as seen by /w/'s code, onto /w->L/'s stack.
+static void widget_push_global(Widget *w, const char *name)
+{
+    lua_State *L = w->L;
+    if (w->lref_env == LUA_NOREF) {
+        lua_getglobal(L, name); // L: ? value
+    } else {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, w->lref_env); // L: ? env
+        lua_getfield(L, -1, name); // L: ? env value
+        lua_remove(L, -2); // L: ? value
+    }
 }
 
-// 1. Replaces some of the functions in the standard library with our thread-safe counterparts.
-// 2. Registers the /luastatus/ module (just creates a global table actually) except for the
-//    /luastatus.plugin/ and /luastatus.barlib/ submodules (created later).
-static void inject_libs(lua_State *L)
+// Sets up the environment for /w/'s code. Expects /w->S/ to be locked.
+//
+// If /shared/ is false, registers the /luastatus/ module (just creates a global table actually).
+//
+// Otherwise, creates a new environment table with its own /luastatus/ module and with global table
+// as the fallback for reading (via the /__index/ metamethod), so that the global variables that
+// /w/'s code defines do not clash with those of other widgets sharing /w->L/.
+static void widget_init_env(Widget *w, bool shared)
 {
-    inject_libs_replacements(L);
-    inject_luastatus_module(L);
+    lua_State *L = w->L;
+    // L: ?
+    if (!shared) {
+        push_luastatus_module(L, 0); // L: ? luastatus
+        lua_setglobal(L, "luastatus"); // L: ?
+        w->lref_env = LUA_NOREF;
+        return;
+    }
+    lua_newtable(L); // L: ? env
+    lua_createtable(L, 0, 1); // L: ? env mt
+    ls_lua_pushglobaltable(L); // L: ? env mt _G
+    lua_setfield(L, -2, "__index"); // L: ? env mt
+    lua_setmetatable(L, -2); // L: ? env
+    push_luastatus_module(L, lua_gettop(L)); // L: ? env luastatus
+    lua_setfield(L, -2, "luastatus"); // L: ? env
+    w->lref_env = luaL_ref(L, LUA_REGISTRYINDEX); // L: ?
+}
+
+// Releases /w/'s references to its Lua interpreter instance. Expects /w->S/ to be locked; unlocks
+// it.
+static void widget_release_lua_state(Widget *w)
+{
+    if (w->lref_env != LUA_NOREF) {
+        // Other widgets may still use /w->L/, so make our stuff collectable.
+        luaL_unref(w->L, LUA_REGISTRYINDEX, w->lref_cb);
+        luaL_unref(w->L, LUA_REGISTRYINDEX, w->lref_event);
+        luaL_unref(w->L, LUA_REGISTRYINDEX, w->lref_env);
+    }
+    UNLOCK_L(w);
+    runner_lua_state_unref(w->S);
 }
 
 // Inspects the 'plugin' field of /w/'s /widget/ table; the /widget/ table is assumed to be on top
@@ -485,20 +605,31 @@ static bool widget_init_inspect_push_opts(Runner *runner)
     }
 }
 
-static bool widget_init(Runner *runner, const char *name, const char *code)
+static bool widget_init(
+        Runner *runner,
+        const char *name,
+        const char *code,
+        RunnerLuaState *shared)
 {
     Widget *w = &runner->widget;
-    w->L = xnew_lua_state();
-    LS_PTH_CHECK(pthread_mutex_init(&w->L_mtx, NULL));
+    if (shared) {
+        w->S = shared;
+        ++shared->nrefs;
+    } else {
+        w->S = runner_lua_state_new();
+    }
+    w->L = w->S->L;
+    w->lref_cb = LUA_NOREF;
+    w->lref_event = LUA_NOREF;
     w->name = ls_xstrdup(name);
     bool plugin_loaded = false;
 
     DEBUGF(runner, "initializing widget [%s]", name);
 
-    luaL_openlibs(w->L);
-    // w->L: -
-    inject_libs(w->L); // w->L: -
-    lua_pushcfunction(w->L, l_error_handler); // w->L: l_error_handler
+    LOCK_L(w);
+
+    LS_ASSERT(lua_gettop(w->L) == 1); // w->L: l_error_handler
+    widget_init_env(w, shared != NULL); // w->L: l_error_handler
 
     DEBUGF(runner, "running widget [%s]", name);
 
@@ -512,12 +643,16 @@ static bool widget_init(Runner *runner, const char *name, const char *code)
         goto error;
     }
     // w->L: l_error_handler chunk
+    if (w->lref_env != LUA_NOREF) {
+        lua_rawgeti(w->L, LUA_REGISTRYINDEX, w->lref_env); // w->L: l_error_handler chunk env
+        ls_lua_setchunkenv(w->L, -2); // w->L: l_error_handler chunk
+    }
     if (!do_lua_call(runner, w->L, 0, 0)) {
         goto error;
     }
     // w->L: l_error_handler
 
-    lua_getglobal(w->L, "widget"); // w->L: l_error_handler widget
+    widget_push_global(w, "widget"); // w->L: l_error_handler widget
     if (!lua_istable(w->L, -1)) {
         ERRF(runner, "'widget': expected table, found %s", luaL_typename(w->L, -1));
         goto error;
@@ -548,12 +683,14 @@ static bool widget_init(Runner *runner, const char *name, const char *code)
     LS_ASSERT(lua_gettop(w->L) == 3); // w->L: l_error_handler widget opts
     lua_pop(w->L, 2); // w->L: l_error_handler
 
+    UNLOCK_L(w);
+
     DEBUGF(runner, "widget successfully initialized");
     return true;
 
 error:
-    lua_close(w->L);
-    LS_PTH_CHECK(pthread_mutex_destroy(&w->L_mtx));
+    lua_settop(w->L, 1); // w->L: l_error_handler
+    widget_release_lua_state(w);
     free(w->name);
     if (plugin_loaded) {
         plugin_unload(&w->plugin);
@@ -565,8 +702,8 @@ static void widget_destroy(Widget *w)
 {
     w->plugin.iface.destroy(&w->data);
     plugin_unload(&w->plugin);
-    lua_close(w->L);
-    LS_PTH_CHECK(pthread_mutex_destroy(&w->L_mtx));
+    LOCK_L(w);
+    widget_release_lua_state(w);
     free(w->name);
 }
 
@@ -575,8 +712,10 @@ static void register_funcs(Runner *runner)
     Widget *w = &runner->widget;
     lua_State *L = w->L;
 
+    LOCK_L(w);
+
     // L: ?
-    lua_getglobal(L, "luastatus"); // L: ? luastatus
+    widget_push_global(w, "luastatus"); // L: ? luastatus
 
     if (!lua_istable(L, -1)) {
         WARNF(
@@ -599,6 +738,8 @@ static void register_funcs(Runner *runner)
 
 done:
     lua_pop(L, 1); // L: ?
+
+    UNLOCK_L(w);
 }
 
 static lua_State *plugin_call_begin(void *userdata)
@@ -646,6 +787,12 @@ static void plugin_call_cancel(void *userdata)
     UNLOCK_L(w);
 }
 
+static void plugin_call_idle(void *userdata)
+{
+    // Data sources have no garbage collector settings of their own.
+    (void) userdata;
+}
+
 lua_State *runner_event_begin(Runner *runner)
 {
     Widget *w = &runner->widget;
@@ -687,11 +834,20 @@ void runner_run(Runner *runner)
 
     DEBUGF(runner, "widget [%s] is now running", w->name);
 
-    w->plugin.iface.run(&w->data, (LuastatusPluginRunFuncs_v1) {
-        .call_begin  = plugin_call_begin,
-        .call_end    = plugin_call_end,
-        .call_cancel = plugin_call_cancel,
-    });
+    if (w->plugin.run_v1) {
+        w->plugin.run_v1(&w->data, (LuastatusPluginRunFuncs_v1) {
+            .call_begin  = plugin_call_begin,
+            .call_end    = plugin_call_end,
+            .call_cancel = plugin_call_cancel,
+        });
+    } else {
+        w->plugin.iface.run(&w->data, (LuastatusPluginRunFuncs_v2) {
+            .call_begin  = plugin_call_begin,
+            .call_end    = plugin_call_end,
+            .call_cancel = plugin_call_cancel,
+            .call_idle   = plugin_call_idle,
+        });
+    }
     WARNF(runner, "plugin's run() for widget [%s] has returned", w->name);
 
     runner->callback(runner->callback_ud, REASON_PLUGIN_EXITED, NULL);
@@ -701,6 +857,7 @@ Runner *runner_new(
     const char *name,
     const char *code,
     ExternalContext ectx,
+    RunnerLuaState *shared,
     RunnerCallback callback,
     void *callback_ud)
 {
@@ -710,7 +867,7 @@ Runner *runner_new(
         .callback = callback,
         .callback_ud = callback_ud,
     };
-    if (!widget_init(runner, name, code)) {
+    if (!widget_init(runner, name, code, shared)) {
         free(runner);
         return NULL;
     }
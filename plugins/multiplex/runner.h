@@ -39,13 +39,32 @@ typedef enum {
     EVT_RESULT_NO_HANDLER,
 } RunnerEventResult;
 
+// A Lua interpreter instance that can be shared by several runners.
+//
+// Each runner sharing an instance runs its code with its own environment table, so that global
+// variables of different runners do not clash.
+struct RunnerLuaState;
+typedef struct RunnerLuaState RunnerLuaState;
+
 struct Runner;
 typedef struct Runner Runner;
 
+// Creates a new instance with one reference, owned by the caller.
+RunnerLuaState *runner_lua_state_new(void);
+
+// Drops a reference; destroys the instance when the last one is dropped.
+//
+// Taking and dropping of references (with this function, /runner_new()/ and /runner_destroy()/)
+// must not happen concurrently for the same instance.
+void runner_lua_state_unref(RunnerLuaState *S);
+
+// If /shared/ is not /NULL/, the runner takes a reference to /shared/ and uses it as its Lua
+// interpreter instance; otherwise, creates its own instance.
 Runner *runner_new(
     const char *name,
     const char *code,
     ExternalContext ectx,
+    RunnerLuaState *shared,
     RunnerCallback callback,
     void *callback_ud);
 
@@ -45,6 +45,8 @@ void runtime_data_init(RuntimeData *x, ExternalContext ectx, size_t n)
         x->states[i] = CONQ_SLOT_STATE_EMPTY;
     }
 
+    x->idxs = LS_XNEW(size_t, n);
+
     x->u_uds = LS_XNEW(UniversalUserdata, n);
     for (size_t i = 0; i < n; ++i) {
         x->u_uds[i] = (UniversalUserdata) {
@@ -35,6 +35,7 @@ typedef struct {
     Conq *cq;
     LS_String *bufs;
     ConqSlotState *states;
+    size_t *idxs;
     UniversalUserdata *u_uds;
     ExternalContext ectx;
 } RuntimeData;
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "iface_filter.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <fnmatch.h>
+
+#include "strset.h"
+
+static IfacePatterns patterns_new(void)
+{
+    return (IfacePatterns) {.names = strset_new(), .globs = strset_new()};
+}
+
+static void patterns_add(IfacePatterns *x, const char *pattern)
+{
+    if (strpbrk(pattern, "*?[\\")) {
+        strset_add(&x->globs, pattern);
+    } else {
+        strset_add(&x->names, pattern);
+    }
+}
+
+static bool patterns_match(IfacePatterns *x, const char *name)
+{
+    if (strset_contains(&x->names, name)) {
+        return true;
+    }
+    for (size_t i = 0; i < x->globs.size; ++i) {
+        if (fnmatch(x->globs.data[i], name, 0) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void patterns_destroy(IfacePatterns x)
+{
+    strset_destroy(x.names);
+    strset_destroy(x.globs);
+}
+
+IfaceFilter iface_filter_new(void)
+{
+    return (IfaceFilter) {
+        .has_only = false,
+        .only = patterns_new(),
+        .except = patterns_new(),
+    };
+}
+
+void iface_filter_add_only(IfaceFilter *f, const char *pattern)
+{
+    f->has_only = true;
+    patterns_add(&f->only, pattern);
+}
+
+void iface_filter_add_except(IfaceFilter *f, const char *pattern)
+{
+    patterns_add(&f->except, pattern);
+}
+
+void iface_filter_freeze(IfaceFilter *f)
+{
+    strset_freeze(&f->only.names);
+    strset_freeze(&f->except.names);
+}
+
+bool iface_filter_allows(IfaceFilter *f, const char *name)
+{
+    if (f->has_only && !patterns_match(&f->only, name)) {
+        return false;
+    }
+    return !patterns_match(&f->except, name);
+}
+
+void iface_filter_destroy(IfaceFilter f)
+{
+    patterns_destroy(f.only);
+    patterns_destroy(f.except);
+}
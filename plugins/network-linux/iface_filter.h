@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "strset.h"
+
+typedef struct {
+    // Patterns without glob metacharacters; looked up with binary search.
+    Strset names;
+
+    // Patterns with glob metacharacters (e.g. "veth*"); matched with /fnmatch()/ one by one.
+    Strset globs;
+} IfacePatterns;
+
+// A filter on interface names, built from /iface_only/ and /iface_except/ options.
+typedef struct {
+    // Whether any /only/ pattern has been added; if not, /only/ does not restrict anything.
+    bool has_only;
+    IfacePatterns only;
+    IfacePatterns except;
+} IfaceFilter;
+
+IfaceFilter iface_filter_new(void);
+
+void iface_filter_add_only(IfaceFilter *f, const char *pattern);
+
+void iface_filter_add_except(IfaceFilter *f, const char *pattern);
+
+// Must be called after all the patterns have been added, and before any /iface_filter_allows()/
+// call.
+void iface_filter_freeze(IfaceFilter *f);
+
+bool iface_filter_allows(IfaceFilter *f, const char *name);
+
+void iface_filter_destroy(IfaceFilter f);
@@ -0,0 +1,461 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "iface_table.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <linux/if_addr.h>
+
+#include "libls/ls_alloc_utils.h"
+#include "libls/ls_io_utils.h"
+#include "libls/ls_osdep.h"
+
+#include "iface_type.h"
+
+IfaceTable iface_table_new(IfaceFilter *filter)
+{
+    return (IfaceTable) {
+        .data = NULL,
+        .size = 0,
+        .capacity = 0,
+        .filter = filter,
+        .ignored = NULL,
+        .nignored = 0,
+        .ignored_capacity = 0,
+        .stale = false,
+    };
+}
+
+static void clear(IfaceTable *t)
+{
+    for (size_t i = 0; i < t->size; ++i) {
+        free(t->data[i].addrs);
+    }
+    t->size = 0;
+    t->nignored = 0;
+    t->stale = false;
+}
+
+static bool allowed(IfaceTable *t, const char *name)
+{
+    return !t->filter || iface_filter_allows(t->filter, name);
+}
+
+// Returns the position of /index/ in /t->ignored/, or /t->nignored/ if it is not there.
+static size_t find_ignored(IfaceTable *t, int index)
+{
+    size_t i = 0;
+    for (; i < t->nignored; ++i) {
+        if (t->ignored[i] == index) {
+            break;
+        }
+    }
+    return i;
+}
+
+static void add_ignored(IfaceTable *t, int index)
+{
+    if (find_ignored(t, index) != t->nignored) {
+        return;
+    }
+    if (t->nignored == t->ignored_capacity) {
+        t->ignored = LS_M_X2REALLOC(t->ignored, &t->ignored_capacity);
+    }
+    t->ignored[t->nignored++] = index;
+}
+
+static bool remove_ignored(IfaceTable *t, int index)
+{
+    size_t i = find_ignored(t, index);
+    if (i == t->nignored) {
+        return false;
+    }
+    t->ignored[i] = t->ignored[--t->nignored];
+    return true;
+}
+
+static Iface *find_iface(IfaceTable *t, int index)
+{
+    for (size_t i = 0; i < t->size; ++i) {
+        if (t->data[i].index == index) {
+            return &t->data[i];
+        }
+    }
+    return NULL;
+}
+
+static void copy_name(char dst[IF_NAMESIZE], const struct rtattr *rta)
+{
+    size_t n = RTA_PAYLOAD(rta);
+    const char *s = RTA_DATA(rta);
+    // The attribute normally includes the terminating NUL, but let's not count on it.
+    size_t len = strnlen(s, n);
+    if (len > IF_NAMESIZE - 1) {
+        len = IF_NAMESIZE - 1;
+    }
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+}
+
+static bool apply_link(IfaceTable *t, const struct nlmsghdr *nh, bool probe_wlan)
+{
+    if (nh->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg))) {
+        return false;
+    }
+    const struct ifinfomsg *ifi = NLMSG_DATA(nh);
+    Iface *iface = find_iface(t, ifi->ifi_index);
+
+    if (nh->nlmsg_type == RTM_DELLINK) {
+        if (!iface) {
+            remove_ignored(t, ifi->ifi_index);
+            return false;
+        }
+        free(iface->addrs);
+        *iface = t->data[--t->size];
+        return true;
+    }
+
+    char name[IF_NAMESIZE] = {0};
+    bool has_name = false;
+    size_t len = IFLA_PAYLOAD(nh);
+    for (
+        const struct rtattr *rta = IFLA_RTA(ifi);
+        RTA_OK(rta, len);
+        rta = RTA_NEXT(rta, len))
+    {
+        if (rta->rta_type == IFLA_IFNAME) {
+            copy_name(name, rta);
+            has_name = true;
+        }
+    }
+
+    if (!iface) {
+        if (!has_name) {
+            return false;
+        }
+        if (!allowed(t, name)) {
+            add_ignored(t, ifi->ifi_index);
+            return false;
+        }
+        if (remove_ignored(t, ifi->ifi_index)) {
+            // Renamed from a filtered-out name.
+            t->stale = true;
+        }
+        if (t->size == t->capacity) {
+            t->data = LS_M_X2REALLOC(t->data, &t->capacity);
+        }
+        iface = &t->data[t->size++];
+        *iface = (Iface) {
+            .index = ifi->ifi_index,
+            .flags = ifi->ifi_flags,
+            .addrs = NULL,
+            .naddrs = 0,
+            .addrs_capacity = 0,
+        };
+        memcpy(iface->name, name, sizeof(name));
+        iface->is_wlan = probe_wlan && is_wlan_iface(name);
+        return true;
+    }
+
+    bool changed = false;
+    if (has_name && strcmp(iface->name, name) != 0) {
+        if (!allowed(t, name)) {
+            free(iface->addrs);
+            *iface = t->data[--t->size];
+            add_ignored(t, ifi->ifi_index);
+            return true;
+        }
+        memcpy(iface->name, name, sizeof(name));
+        iface->is_wlan = probe_wlan && is_wlan_iface(name);
+        changed = true;
+    }
+    if (iface->flags != ifi->ifi_flags) {
+        iface->flags = ifi->ifi_flags;
+        changed = true;
+    }
+    return changed;
+}
+
+static bool format_addr(IfaceAddr *a, int index)
+{
+    union {
+        struct sockaddr sa;
+        struct sockaddr_in sin;
+        struct sockaddr_in6 sin6;
+    } u;
+    memset(&u, 0, sizeof(u));
+    socklen_t nsa;
+
+    if (a->family == AF_INET) {
+        u.sin.sin_family = AF_INET;
+        memcpy(&u.sin.sin_addr, a->raw, 4);
+        nsa = sizeof(struct sockaddr_in);
+    } else {
+        u.sin6.sin6_family = AF_INET6;
+        memcpy(&u.sin6.sin6_addr, a->raw, 16);
+        // This is what /getifaddrs()/ does, so that /getnameinfo()/ appends "%<iface>".
+        if (IN6_IS_ADDR_LINKLOCAL(&u.sin6.sin6_addr) ||
+            IN6_IS_ADDR_MC_LINKLOCAL(&u.sin6.sin6_addr))
+        {
+            u.sin6.sin6_scope_id = index;
+        }
+        nsa = sizeof(struct sockaddr_in6);
+    }
+    return getnameinfo(&u.sa, nsa, a->host, sizeof(a->host), NULL, 0, NI_NUMERICHOST) == 0;
+}
+
+static bool apply_addr(IfaceTable *t, const struct nlmsghdr *nh)
+{
+    if (nh->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifaddrmsg))) {
+        return false;
+    }
+    const struct ifaddrmsg *ifa = NLMSG_DATA(nh);
+
+    size_t nraw;
+    switch (ifa->ifa_family) {
+    case AF_INET:
+        nraw = 4;
+        break;
+    case AF_INET6:
+        nraw = 16;
+        break;
+    default:
+        return false;
+    }
+
+    Iface *iface = find_iface(t, ifa->ifa_index);
+    if (!iface) {
+        return false;
+    }
+
+    // Like /getifaddrs()/, we prefer /IFA_LOCAL/ over /IFA_ADDRESS/: for point-to-point
+    // interfaces, the latter is the address of the other end.
+    const struct rtattr *rta_local = NULL;
+    const struct rtattr *rta_address = NULL;
+    const struct rtattr *rta_label = NULL;
+    size_t len = IFA_PAYLOAD(nh);
+    for (
+        const struct rtattr *rta = IFA_RTA(ifa);
+        RTA_OK(rta, len);
+        rta = RTA_NEXT(rta, len))
+    {
+        switch (rta->rta_type) {
+        case IFA_LOCAL:
+            rta_local = rta;
+            break;
+        case IFA_ADDRESS:
+            rta_address = rta;
+            break;
+        case IFA_LABEL:
+            rta_label = rta;
+            break;
+        }
+    }
+    const struct rtattr *rta_raw = rta_local ? rta_local : rta_address;
+    if (!rta_raw || RTA_PAYLOAD(rta_raw) < nraw) {
+        return false;
+    }
+
+    IfaceAddr a = {.family = ifa->ifa_family};
+    memcpy(a.raw, RTA_DATA(rta_raw), nraw);
+    if (rta_label && ifa->ifa_family == AF_INET) {
+        copy_name(a.label, rta_label);
+    } else {
+        memcpy(a.label, iface->name, sizeof(a.label));
+    }
+
+    size_t i = 0;
+    for (; i < iface->naddrs; ++i) {
+        IfaceAddr *cur = &iface->addrs[i];
+        if (cur->family == a.family && memcmp(cur->raw, a.raw, nraw) == 0) {
+            break;
+        }
+    }
+
+    if (nh->nlmsg_type == RTM_DELADDR) {
+        if (i == iface->naddrs) {
+            return false;
+        }
+        // Preserve the order, as it is visible from Lua with /new_ip_fmt/.
+        memmove(
+            &iface->addrs[i],
+            &iface->addrs[i + 1],
+            sizeof(IfaceAddr) * (iface->naddrs - i - 1));
+        --iface->naddrs;
+        return true;
+    }
+
+    if (i != iface->naddrs) {
+        // Already known; /RTM_NEWADDR/ is also sent when, e.g., the lifetimes of an IPv6 address
+        // get updated. Only the label can change here.
+        if (strcmp(iface->addrs[i].label, a.label) == 0) {
+            return false;
+        }
+        memcpy(iface->addrs[i].label, a.label, sizeof(a.label));
+        return true;
+    }
+
+    if (!format_addr(&a, ifa->ifa_index)) {
+        return false;
+    }
+    if (iface->naddrs == iface->addrs_capacity) {
+        iface->addrs = LS_M_X2REALLOC(iface->addrs, &iface->addrs_capacity);
+    }
+    iface->addrs[iface->naddrs++] = a;
+    return true;
+}
+
+bool iface_table_apply(IfaceTable *t, const struct nlmsghdr *nh, bool probe_wlan)
+{
+    switch (nh->nlmsg_type) {
+    case RTM_NEWLINK:
+    case RTM_DELLINK:
+        return apply_link(t, nh, probe_wlan);
+    case RTM_NEWADDR:
+    case RTM_DELADDR:
+        return apply_addr(t, nh);
+    default:
+        return false;
+    }
+}
+
+// Sends a dump request of type /type/ over /fd/ and applies all the messages received in response.
+// Returns /0/ on success, or an /errno/ value on failure.
+static int dump(
+        IfaceTable *t,
+        int fd,
+        int type,
+        uint32_t seq,
+        bool probe_wlan,
+        char *buf,
+        size_t nbuf)
+{
+    struct {
+        struct nlmsghdr nh;
+        struct rtgenmsg g;
+    } req = {
+        .nh = {
+            .nlmsg_len = NLMSG_LENGTH(sizeof(struct rtgenmsg)),
+            .nlmsg_type = type,
+            .nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP,
+            .nlmsg_seq = seq,
+        },
+        .g = {.rtgen_family = AF_UNSPEC},
+    };
+    struct sockaddr_nl sa = {.nl_family = AF_NETLINK};
+
+    while (sendto(fd, &req, req.nh.nlmsg_len, 0, (struct sockaddr *) &sa, sizeof(sa)) < 0) {
+        if (errno != EINTR) {
+            return errno;
+        }
+    }
+
+    for (;;) {
+        struct iovec iov = {.iov_base = buf, .iov_len = nbuf};
+        struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1};
+        ssize_t r = recvmsg(fd, &msg, 0);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (r == 0 || (msg.msg_flags & MSG_TRUNC)) {
+            return EPROTO;
+        }
+        size_t len = r;
+        for (
+            struct nlmsghdr *nh = (struct nlmsghdr *) buf;
+            NLMSG_OK(nh, len);
+            nh = NLMSG_NEXT(nh, len))
+        {
+            if (nh->nlmsg_seq != seq) {
+                continue;
+            }
+            if (nh->nlmsg_type == NLMSG_DONE) {
+                return 0;
+            }
+            if (nh->nlmsg_type == NLMSG_ERROR) {
+                if (nh->nlmsg_len < NLMSG_LENGTH(sizeof(struct nlmsgerr))) {
+                    return EPROTO;
+                }
+                struct nlmsgerr *e = NLMSG_DATA(nh);
+                return e->error ? -e->error : EPROTO;
+            }
+            iface_table_apply(t, nh, probe_wlan);
+        }
+    }
+}
+
+int iface_table_rescan(IfaceTable *t, bool probe_wlan)
+{
+    // This is large enough for any dump message: the kernel never makes them larger than
+    // /min(page size, 8192)/ bytes (unless some link has a really huge set of attributes, in which
+    // case we report /EPROTO/).
+    enum { NBUF = 32768 };
+
+    clear(t);
+
+    int ret = 0;
+    char *buf = LS_XNEW(char, NBUF);
+    int fd = ls_cloexec_socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+    if (fd < 0) {
+        ret = errno;
+        goto done;
+    }
+
+    // Addresses refer to links by index, so links must be fetched first.
+    if ((ret = dump(t, fd, RTM_GETLINK, 1, probe_wlan, buf, NBUF))) {
+        goto done;
+    }
+    if ((ret = dump(t, fd, RTM_GETADDR, 2, probe_wlan, buf, NBUF))) {
+        goto done;
+    }
+
+done:
+    free(buf);
+    ls_close(fd);
+    if (ret) {
+        clear(t);
+        errno = ret;
+        return -1;
+    }
+    return 0;
+}
+
+void iface_table_destroy(IfaceTable *t)
+{
+    clear(t);
+    free(t->data);
+    free(t->ignored);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+
+#include "iface_filter.h"
+
+// A local IPv4/IPv6 address of an interface.
+typedef struct {
+    // Either /AF_INET/ or /AF_INET6/.
+    int family;
+
+    // The raw address; only the first 4 bytes are used if /family == AF_INET/.
+    unsigned char raw[16];
+
+    // The name the address is reported under: the label of the address (for IPv4 aliases such as
+    // "eth0:1"), or the name of the interface.
+    char label[IF_NAMESIZE];
+
+    // The numeric textual representation, as formatted by /getnameinfo()/.
+    char host[128];
+} IfaceAddr;
+
+typedef struct {
+    int index;
+    unsigned flags;
+    char name[IF_NAMESIZE];
+
+    // Only meaningful if the table is maintained with /probe_wlan/ set to true.
+    bool is_wlan;
+
+    IfaceAddr *addrs;
+    size_t naddrs;
+    size_t addrs_capacity;
+} Iface;
+
+// The set of network interfaces along with their addresses, maintained from rtnetlink messages
+// (/RTM_NEWLINK/, /RTM_DELLINK/, /RTM_NEWADDR/, /RTM_DELADDR/), so that an update of a single
+// interface or address does not require re-fetching everything.
+//
+// Interfaces not allowed by the filter are not stored at all (and thus never probed).
+typedef struct {
+    Iface *data;
+    size_t size;
+    size_t capacity;
+
+    // May be /NULL/.
+    IfaceFilter *filter;
+
+    // Indexes of interfaces that have been filtered out.
+    int *ignored;
+    size_t nignored;
+    size_t ignored_capacity;
+
+    // Set when an interface that has been filtered out gets renamed to a name allowed by the
+    // filter: we have not been tracking its addresses, so the table must be re-fetched with
+    // /iface_table_rescan()/.
+    bool stale;
+} IfaceTable;
+
+// /filter/ may be /NULL/; otherwise, it must outlive the table.
+IfaceTable iface_table_new(IfaceFilter *filter);
+
+// Applies rtnetlink message /nh/ to the table. If /probe_wlan/ is true, each new (or renamed)
+// interface is checked with /is_wlan_iface()/.
+//
+// Returns /true/ if the table has changed, /false/ otherwise (including the case of the message
+// being irrelevant).
+bool iface_table_apply(IfaceTable *t, const struct nlmsghdr *nh, bool probe_wlan);
+
+// Re-fetches the whole table from the kernel (with a dump request over a new rtnetlink socket).
+//
+// On success, returns /0/. On failure, returns /-1/ and sets /errno/; the table is left empty
+// then.
+int iface_table_rescan(IfaceTable *t, bool probe_wlan);
+
+void iface_table_destroy(IfaceTable *t);
@@ -21,17 +21,15 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
-#include <ifaddrs.h>
-#include <netdb.h>
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <errno.h>
 #include <poll.h>
-#include <netinet/in.h>
 
 #include "include/plugin_v1.h"
 #include "include/sayf_macros.h"
@@ -46,7 +44,8 @@
 #include "libls/ls_evloop_lfuncs.h"
 #include "libls/ls_lua_compat.h"
 
-#include "strset.h"
+#include "iface_filter.h"
+#include "iface_table.h"
 #include "wireless_info.h"
 #include "ethernet_info.h"
 #include "iface_type.h"
@@ -58,7 +57,10 @@ typedef struct {
     bool new_ip_fmt;
     bool new_overall_fmt;
     double tmo;
-    Strset wlan_ifaces;
+    double debounce;
+    IfaceFilter filter;
+    IfaceTable ifaces;
+    WirelessCtx wctx;
     int eth_sockfd;
     int pipefds[2];
 } Priv;
@@ -66,13 +68,43 @@ typedef struct {
 static void destroy(LuastatusPluginData *pd)
 {
     Priv *p = pd->priv;
-    strset_destroy(p->wlan_ifaces);
+    iface_table_destroy(&p->ifaces);
+    iface_filter_destroy(p->filter);
+    wireless_ctx_destroy(&p->wctx);
     ls_close(p->eth_sockfd);
     ls_close(p->pipefds[0]);
     ls_close(p->pipefds[1]);
     free(p);
 }
 
+static int parse_iface_only_elem(MoonVisit *mv, void *ud, int kpos, int vpos)
+{
+    mv->where = "'iface_only' element";
+    (void) kpos;
+
+    Priv *p = ud;
+
+    if (moon_visit_checktype_at(mv, NULL, vpos, LUA_TSTRING) < 0)
+        return -1;
+
+    iface_filter_add_only(&p->filter, lua_tostring(mv->L, vpos));
+    return 1;
+}
+
+static int parse_iface_except_elem(MoonVisit *mv, void *ud, int kpos, int vpos)
+{
+    mv->where = "'iface_except' element";
+    (void) kpos;
+
+    Priv *p = ud;
+
+    if (moon_visit_checktype_at(mv, NULL, vpos, LUA_TSTRING) < 0)
+        return -1;
+
+    iface_filter_add_except(&p->filter, lua_tostring(mv->L, vpos));
+    return 1;
+}
+
 static int init(LuastatusPluginData *pd, lua_State *L)
 {
     Priv *p = pd->priv = LS_XNEW(Priv, 1);
@@ -83,7 +115,10 @@ static int init(LuastatusPluginData *pd, lua_State *L)
         .new_ip_fmt = false,
         .new_overall_fmt = false,
         .tmo = -1,
-        .wlan_ifaces = strset_new(),
+        .debounce = 0,
+        .filter = iface_filter_new(),
+        .ifaces = iface_table_new(&p->filter),
+        .wctx = {.sk = NULL, .nl80211_id = -1, .ev_sk = NULL},
         .eth_sockfd = -1,
         .pipefds = {-1, -1},
     };
@@ -114,6 +149,24 @@ static int init(LuastatusPluginData *pd, lua_State *L)
     if (moon_visit_num(&mv, -1, "timeout", &p->tmo, true) < 0)
         goto mverror;
 
+    // Parse debounce
+    if (moon_visit_num(&mv, -1, "debounce", &p->debounce, true) < 0)
+        goto mverror;
+    if (!ls_double_is_good_time_delta(p->debounce)) {
+        LS_FATALF(pd, "debounce is invalid");
+        goto error;
+    }
+
+    // Parse iface_only
+    if (moon_visit_table_f(&mv, -1, "iface_only", parse_iface_only_elem, p, true) < 0)
+        goto mverror;
+
+    // Parse iface_except
+    if (moon_visit_table_f(&mv, -1, "iface_except", parse_iface_except_elem, p, true) < 0)
+        goto mverror;
+
+    iface_filter_freeze(&p->filter);
+
     // Parse make_self_pipe
     bool make_self_pipe = false;
     if (moon_visit_bool(&mv, -1, "make_self_pipe", &make_self_pipe, true) < 0) {
@@ -127,6 +180,17 @@ static int init(LuastatusPluginData *pd, lua_State *L)
         }
     }
 
+    // Set up wireless context if needed.
+    if (p->report_wireless) {
+        wireless_ctx_init(&p->wctx, true);
+        if (!p->wctx.sk) {
+            LS_WARNF(pd, "cannot set up nl80211 socket (will retry later)");
+        }
+        if (!p->wctx.ev_sk) {
+            LS_WARNF(pd, "cannot subscribe to nl80211 events");
+        }
+    }
+
     // Open eth_sockfd if needed.
     if (p->report_ethernet) {
         p->eth_sockfd = ls_cloexec_socket(AF_INET, SOCK_DGRAM, 0);
@@ -170,25 +234,11 @@ static void report_error(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
     funcs.call_end(pd->userdata);
 }
 
-static void inject_ip_info(lua_State *L, struct ifaddrs *addr, bool new_ip_fmt)
+static void inject_ip_info(lua_State *L, const IfaceAddr *addr, bool new_ip_fmt)
 {
     // L: ? ifacetbl
-    if (!addr->ifa_addr) {
-        return;
-    }
-    int family = addr->ifa_addr->sa_family;
-    if (family != AF_INET && family != AF_INET6) {
-        return;
-    }
-    char host[1025];
-    int r = getnameinfo(
-        addr->ifa_addr,
-        family == AF_INET ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6),
-        host, sizeof(host),
-        NULL, 0, NI_NUMERICHOST);
-    if (r) {
-        return;
-    }
+    const char *host = addr->host;
+    int family = addr->family;
 
     const char *k = family == AF_INET ? "ipv4" : "ipv6";
     if (new_ip_fmt) {
@@ -220,10 +270,10 @@ static void inject_ip_info(lua_State *L, struct ifaddrs *addr, bool new_ip_fmt)
     }
 }
 
-static void inject_wireless_info(lua_State *L, struct ifaddrs *addr)
+static void inject_wireless_info(lua_State *L, WirelessCtx *wctx, int ifindex)
 {
     WirelessInfo info;
-    if (!get_wireless_info(addr->ifa_name, &info)) {
+    if (!get_wireless_info(wctx, ifindex, &info)) {
         return;
     }
 
@@ -248,12 +298,12 @@ static void inject_wireless_info(lua_State *L, struct ifaddrs *addr)
     lua_setfield(L, -2, "wireless"); // L: ? ifacetbl
 }
 
-static void inject_ethernet_info(lua_State *L, struct ifaddrs *addr, int sockfd)
+static void inject_ethernet_info(lua_State *L, const char *iface, int sockfd)
 {
     if (sockfd < 0) {
         return;
     }
-    uint32_t speed = get_ethernet_speed(sockfd, addr->ifa_name);
+    uint32_t speed = get_ethernet_speed(sockfd, iface);
     if (!speed) {
         return;
     }
@@ -291,19 +341,34 @@ static void end_call(Priv *p, lua_State *L, const char *what)
     }
 }
 
+// Pushes the table for interface (or address label) /name/ onto /L/'s stack, creating it (and
+// probing the interface, if this was requested) if it does not exist yet.
+static void push_ifacetbl(Priv *p, lua_State *L, const char *name, int index, bool is_wlan)
+{
+    // L: ? table
+    lua_getfield(L, -1, name); // L: ? table ifacetbl
+    if (!lua_isnil(L, -1)) {
+        return;
+    }
+    lua_pop(L, 1); // L: ? table
+    lua_newtable(L); // L: ? table ifacetbl
+    lua_pushvalue(L, -1); // L: ? table ifacetbl ifacetbl
+    lua_setfield(L, -3, name); // L: ? table ifacetbl
+
+    if (p->report_wireless && is_wlan) {
+        inject_wireless_info(L, &p->wctx, index); // L: ? table ifacetbl
+    }
+
+    if (p->report_ethernet) {
+        inject_ethernet_info(L, name, p->eth_sockfd); // L: ? table ifacetbl
+    }
+}
+
 static void make_call(
         LuastatusPluginData *pd,
         LuastatusPluginRunFuncs funcs,
-        bool refresh,
         const char *what)
 {
-    struct ifaddrs *ifaddr;
-    if (getifaddrs(&ifaddr) < 0) {
-        LS_ERRF(pd, "getifaddrs: %s", ls_tls_strerror(errno));
-        report_error(pd, funcs);
-        return;
-    }
-
     Priv *p = pd->priv;
 
     lua_State *L = funcs.call_begin(pd->userdata);
@@ -313,40 +378,26 @@ static void make_call(
 
     lua_newtable(L); // L: ?... table
 
-    if (refresh) {
-        strset_reset(&p->wlan_ifaces);
-    }
+    for (size_t i = 0; i < p->ifaces.size; ++i) {
+        const Iface *iface = &p->ifaces.data[i];
 
-    for (struct ifaddrs *cur = ifaddr; cur; cur = cur->ifa_next) {
-        lua_getfield(L, -1, cur->ifa_name); // L: ?... table ifacetbl
-        if (lua_isnil(L, -1)) {
-            lua_pop(L, 1); // L: ?... table
-            lua_newtable(L); // L: ?... table ifacetbl
-            lua_pushvalue(L, -1); // L: ?... table ifacetbl ifacetbl
-            lua_setfield(L, -3, cur->ifa_name); // L: ?... table ifacetbl
-
-            if (p->report_wireless) {
-                bool is_wlan;
-                if (refresh) {
-                    is_wlan = is_wlan_iface(cur->ifa_name);
-                    if (is_wlan) {
-                        strset_add(&p->wlan_ifaces, cur->ifa_name);
-                    }
+        push_ifacetbl(p, L, iface->name, iface->index, iface->is_wlan);
+        // L: ?... table ifacetbl
+
+        if (p->report_ip) {
+            for (size_t j = 0; j < iface->naddrs; ++j) {
+                const IfaceAddr *addr = &iface->addrs[j];
+                if (strcmp(addr->label, iface->name) == 0) {
+                    inject_ip_info(L, addr, p->new_ip_fmt); // L: ?... table ifacetbl
                 } else {
-                    is_wlan = strset_contains(&p->wlan_ifaces, cur->ifa_name);
-                }
-                if (is_wlan) {
-                    inject_wireless_info(L, cur); // L: ?... table ifacetbl
+                    // An IPv4 alias, e.g. "eth0:1".
+                    lua_pushvalue(L, -2); // L: ?... table ifacetbl table
+                    push_ifacetbl(p, L, addr->label, iface->index, false);
+                    // L: ?... table ifacetbl table atbl
+                    inject_ip_info(L, addr, p->new_ip_fmt); // L: ?... table ifacetbl table atbl
+                    lua_pop(L, 2); // L: ?... table ifacetbl
                 }
             }
-
-            if (p->report_ethernet) {
-                inject_ethernet_info(L, cur, p->eth_sockfd); // L: ?... table ifacetbl
-            }
-        }
-
-        if (p->report_ip) {
-            inject_ip_info(L, cur, p->new_ip_fmt); // L: ?... table ifacetbl
         }
 
         lua_pop(L, 1); // L: ?... table
@@ -356,22 +407,42 @@ static void make_call(
 
     end_call(p, L, what); // L: ? result
 
-    if (refresh) {
-        strset_freeze(&p->wlan_ifaces);
-    }
-
-    freeifaddrs(ifaddr);
-
     funcs.call_end(pd->userdata);
 }
 
-static ssize_t my_recvmsg(int fd_netlink, struct msghdr *msg, LS_TimeDelta tmo, int fd_extra)
+// Re-fetches the whole interface table and makes a call.
+//
+// On failure, returns false; the interface table may then be incomplete, so the caller should
+// resynchronize (see /run()/).
+static bool rescan_and_call(
+        LuastatusPluginData *pd,
+        LuastatusPluginRunFuncs funcs,
+        const char *what)
+{
+    Priv *p = pd->priv;
+    if (iface_table_rescan(&p->ifaces, p->report_wireless) < 0) {
+        LS_ERRF(pd, "iface_table_rescan: %s", ls_tls_strerror(errno));
+        return false;
+    }
+    make_call(pd, funcs, what);
+    return true;
+}
+
+static ssize_t my_recvmsg(
+        int fd_netlink,
+        struct msghdr *msg,
+        LS_TimeDelta tmo,
+        int fd_extra,
+        int fd_wireless,
+        bool *wireless_event)
 {
-    struct pollfd pfds[2] = {
-        {.fd = fd_netlink, .events = POLLIN},
-        {.fd = fd_extra,   .events = POLLIN},
+    struct pollfd pfds[3] = {
+        {.fd = fd_netlink,  .events = POLLIN},
+        {.fd = fd_extra,    .events = POLLIN},
+        {.fd = fd_wireless, .events = POLLIN},
     };
-    int poll_rc = ls_poll(pfds, 2, tmo);
+    *wireless_event = false;
+    int poll_rc = ls_poll(pfds, 3, tmo);
     if (poll_rc < 0) {
         // 'poll()' failed somewhy.
         return -1;
@@ -391,13 +462,22 @@ static ssize_t my_recvmsg(int fd_netlink, struct msghdr *msg, LS_TimeDelta tmo,
         errno = 0;
         return -1;
     }
+    if (pfds[2].revents & POLLIN) {
+        // We have some nl80211 events; the caller is responsible for reading them.
+        *wireless_event = true;
+        errno = 0;
+        return -1;
+    }
     // If 'recvmsg()' below fails with /EAGAIN/ or /EWOULDBLOCK/, we do exactly the right
     // thing: return -1 and set errno to /EAGAIN/ or /EWOULDBLOCK/, which signals a timeout.
     return recvmsg(fd_netlink, msg, 0);
 }
 
-static bool interpret_nl_msg(LuastatusPluginData *pd, char *msg_buf, size_t len)
+// Applies the messages to the interface table; sets /*changed/ to true if it has changed.
+static bool interpret_nl_msg(LuastatusPluginData *pd, char *msg_buf, size_t len, bool *changed)
 {
+    Priv *p = pd->priv;
+
     for (
         struct nlmsghdr *nh = (struct nlmsghdr *) msg_buf;
         NLMSG_OK(nh, len);
@@ -422,7 +502,9 @@ static bool interpret_nl_msg(LuastatusPluginData *pd, char *msg_buf, size_t len)
                 continue;
             }
         }
-        // we don't care about the message
+        if (iface_table_apply(&p->ifaces, nh, p->report_wireless)) {
+            *changed = true;
+        }
     }
     return true;
 }
@@ -464,39 +546,88 @@ static bool interact(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
     }
 
     LS_TimeDelta TD = ls_double_to_TD(p->tmo, LS_TD_FOREVER);
+    LS_TimeDelta debounce_TD = ls_double_to_TD_or_die(p->debounce);
+    int wireless_event_fd = wireless_ctx_event_fd(&p->wctx);
 
-    make_call(pd, funcs, true, "update");
+    // We subscribe to updates before the initial scan, so none of them can be missed.
+    if (!rescan_and_call(pd, funcs, "update")) {
+        ret = true;
+        goto error;
+    }
+
+    // Whether the interface table has changed since the last call. If so, the call is postponed
+    // until /flush_deadline/ (or until no more messages are immediately available, if /debounce/ is
+    // zero), so that a burst of updates results in a single call.
+    bool dirty = false;
+    LS_TimeStamp flush_deadline = LS_TS_BAD;
 
     while (1) {
+        LS_TimeDelta cur_TD = dirty ? ls_TS_minus_TS_nonneg(flush_deadline, ls_now()) : TD;
+
         struct iovec iov = {.iov_base = buf, .iov_len = NBUF};
         struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1};
-        ssize_t len = my_recvmsg(fd, &msg, TD, p->pipefds[0]);
+        bool wireless_event;
+        ssize_t len = my_recvmsg(
+            fd, &msg, cur_TD, p->pipefds[0], wireless_event_fd, &wireless_event);
         if (len < 0) {
-            if (errno == 0) {
-                make_call(pd, funcs, false, "self_pipe");
+            if (errno == 0 && wireless_event) {
+                // Wireless connection info is not a part of the interface table, so it is fetched
+                // anew on every call; we just need to make one.
+                if (wireless_ctx_drain_events(&p->wctx) && !dirty) {
+                    dirty = true;
+                    flush_deadline = ls_TS_plus_TD(ls_now(), debounce_TD);
+                }
+                continue;
+            } else if (errno == 0) {
+                make_call(pd, funcs, "self_pipe");
+                dirty = false;
                 continue;
             } else if (errno == EINTR) {
-                make_call(pd, funcs, true, "update");
+                if (!rescan_and_call(pd, funcs, "update")) {
+                    ret = true;
+                    goto error;
+                }
+                dirty = false;
                 continue;
             } else if (LS_IS_EAGAIN(errno)) {
-                make_call(pd, funcs, false, "timeout");
+                make_call(pd, funcs, dirty ? "update" : "timeout");
+                dirty = false;
                 continue;
             } else if (errno == ENOBUFS) {
-                ret = true;
-                LS_WARNF(pd, "ENOBUFS - kernel's socket buffer is full");
-                goto error;
+                // Some updates have been lost; this is the only case we need a full rescan.
+                LS_WARNF(pd, "ENOBUFS - kernel's socket buffer is full; resynchronizing");
+                if (!rescan_and_call(pd, funcs, "update")) {
+                    ret = true;
+                    goto error;
+                }
+                dirty = false;
+                continue;
             } else {
                 LS_FATALF(pd, "my_recvmsg: %s", ls_tls_strerror(errno));
                 goto error;
             }
         }
 
-        if (!interpret_nl_msg(pd, buf, len)) {
+        bool changed = false;
+        if (!interpret_nl_msg(pd, buf, len, &changed)) {
             ret = true;
             goto error;
         }
 
-        make_call(pd, funcs, true, "update");
+        if (p->ifaces.stale) {
+            LS_DEBUGF(pd, "an interface that has been filtered out got renamed; rescanning");
+            if (!rescan_and_call(pd, funcs, "update")) {
+                ret = true;
+                goto error;
+            }
+            dirty = false;
+            continue;
+        }
+
+        if (changed && !dirty) {
+            dirty = true;
+            flush_deadline = ls_TS_plus_TD(ls_now(), debounce_TD);
+        }
     }
 
 error:
@@ -24,7 +24,6 @@
 #include <string.h>
 #include <stdio.h>
 
-#include <net/if.h>
 #include <netlink/netlink.h>
 #include <netlink/genl/genl.h>
 #include <netlink/genl/ctrl.h>
@@ -211,30 +210,126 @@ static int gwi_scan_cb(struct nl_msg *msg, void *vud)
     return NL_SKIP;
 }
 
-bool get_wireless_info(const char *iface, WirelessInfo *info)
+static struct nl_sock *connect_new_socket(void)
+{
+    struct nl_sock *sk = nl_socket_alloc();
+    if (!sk) {
+        return NULL;
+    }
+    if (genl_connect(sk) != 0) {
+        nl_socket_free(sk);
+        return NULL;
+    }
+    return sk;
+}
+
+static bool setup_request_socket(WirelessCtx *ctx)
+{
+    if (!(ctx->sk = connect_new_socket())) {
+        return false;
+    }
+    ctx->nl80211_id = genl_ctrl_resolve(ctx->sk, "nl80211");
+    if (ctx->nl80211_id < 0) {
+        nl_socket_free(ctx->sk);
+        ctx->sk = NULL;
+        return false;
+    }
+    return true;
+}
+
+static int event_cb(struct nl_msg *msg, void *vud)
+{
+    (void) msg;
+    bool *got_event = vud;
+    *got_event = true;
+    return NL_SKIP;
+}
+
+static struct nl_sock *setup_event_socket(void)
+{
+    struct nl_sock *sk = connect_new_socket();
+    if (!sk) {
+        return NULL;
+    }
+    int grp = genl_ctrl_resolve_grp(sk, "nl80211", "mlme");
+    if (grp < 0) {
+        goto fail;
+    }
+    // Events are not replies to our requests.
+    nl_socket_disable_seq_check(sk);
+    if (nl_socket_add_membership(sk, grp) < 0) {
+        goto fail;
+    }
+    if (nl_socket_set_nonblocking(sk) < 0) {
+        goto fail;
+    }
+    return sk;
+fail:
+    nl_socket_free(sk);
+    return NULL;
+}
+
+void wireless_ctx_init(WirelessCtx *ctx, bool subscribe)
+{
+    *ctx = (WirelessCtx) {.sk = NULL, .nl80211_id = -1, .ev_sk = NULL};
+    setup_request_socket(ctx);
+    if (subscribe) {
+        ctx->ev_sk = setup_event_socket();
+    }
+}
+
+int wireless_ctx_event_fd(WirelessCtx *ctx)
+{
+    return ctx->ev_sk ? nl_socket_get_fd(ctx->ev_sk) : -1;
+}
+
+bool wireless_ctx_drain_events(WirelessCtx *ctx)
+{
+    if (!ctx->ev_sk) {
+        return false;
+    }
+    bool got_event = false;
+    if (nl_socket_modify_cb(ctx->ev_sk, NL_CB_VALID, NL_CB_CUSTOM, event_cb, &got_event) < 0) {
+        return false;
+    }
+    // Bound the number of iterations, just in case.
+    for (int i = 0; i < 1024; ++i) {
+        if (nl_recvmsgs_default(ctx->ev_sk) < 0) {
+            // Either /-NLE_AGAIN/ (nothing more to read) or some error; in the latter case, the
+            // worst thing that can happen is that we miss some events.
+            break;
+        }
+    }
+    return got_event;
+}
+
+void wireless_ctx_destroy(WirelessCtx *ctx)
+{
+    if (ctx->sk) {
+        nl_socket_free(ctx->sk);
+    }
+    if (ctx->ev_sk) {
+        nl_socket_free(ctx->ev_sk);
+    }
+}
+
+bool get_wireless_info(WirelessCtx *ctx, int ifindex, WirelessInfo *info)
 {
     memset(info, 0, sizeof(WirelessInfo));
     bool ok = false;
-    struct nl_sock *sk = NULL;
     struct nl_msg *msg = NULL;
     int r;
 
-    if (!(sk = nl_socket_alloc()))
-        goto done;
-
-    if (genl_connect(sk) != 0)
-        goto done;
-
-    if (nl_socket_modify_cb(sk, NL_CB_VALID, NL_CB_CUSTOM, gwi_scan_cb, info) < 0)
-        goto done;
+    if (ifindex <= 0)
+        return false;
 
-    int nl80211_id = genl_ctrl_resolve(sk, "nl80211");
-    if (nl80211_id < 0)
-        goto done;
+    if (!ctx->sk && !setup_request_socket(ctx))
+        return false;
 
+    struct nl_sock *sk = ctx->sk;
+    int nl80211_id = ctx->nl80211_id;
 
-    unsigned ifidx = if_nametoindex(iface);
-    if (ifidx == 0)
+    if (nl_socket_modify_cb(sk, NL_CB_VALID, NL_CB_CUSTOM, gwi_scan_cb, info) < 0)
         goto done;
 
     if (!(msg = nlmsg_alloc()))
@@ -253,7 +348,7 @@ bool get_wireless_info(const char *iface, WirelessInfo *info)
     {
         goto done;
     }
-    if (nla_put_u32(msg, NL80211_ATTR_IFINDEX, ifidx) < 0)
+    if (nla_put_u32(msg, NL80211_ATTR_IFINDEX, ifindex) < 0)
         goto done;
 
     r = nl_send_sync(sk, msg);
@@ -281,7 +376,7 @@ bool get_wireless_info(const char *iface, WirelessInfo *info)
         goto done;
     }
 
-    if (nla_put_u32(msg, NL80211_ATTR_IFINDEX, ifidx) < 0)
+    if (nla_put_u32(msg, NL80211_ATTR_IFINDEX, ifindex) < 0)
         goto done;
 
     if (nla_put(msg, NL80211_ATTR_MAC, 6, info->bssid) < 0)
@@ -296,7 +391,11 @@ bool get_wireless_info(const char *iface, WirelessInfo *info)
 done:
     if (msg)
         nlmsg_free(msg);
-    if (sk)
-        nl_socket_free(sk);
+    if (!ok) {
+        // The socket may be left with unread or garbled replies (e.g. after an interrupted dump
+        // or a sequence number mismatch); drop it so that the next call sets up a fresh one.
+        nl_socket_free(ctx->sk);
+        ctx->sk = NULL;
+    }
     return ok;
 }
@@ -22,6 +22,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <linux/if_ether.h>
+#include <netlink/socket.h>
 
 enum { ESSID_MAX = 32 };
 
@@ -41,4 +42,32 @@ typedef struct {
     double   frequency;
 } WirelessInfo;
 
-bool get_wireless_info(const char *iface, WirelessInfo *info);
+typedef struct {
+    // Long-lived generic netlink socket for nl80211 requests, or /NULL/ if it could not be set up,
+    // or if the last request through it has failed (then set-up is retried on the next
+    // /get_wireless_info()/ call).
+    struct nl_sock *sk;
+
+    // Cached nl80211 family id; only meaningful if /sk/ is not /NULL/.
+    int nl80211_id;
+
+    // Socket subscribed to nl80211 "mlme" multicast group (connect, disconnect, roaming, connection
+    // quality monitor notifications), or /NULL/ if subscription was not requested or has failed.
+    struct nl_sock *ev_sk;
+} WirelessCtx;
+
+// Initializes /ctx/. If /subscribe/ is true, also subscribes to nl80211 events.
+//
+// Never fails as a whole; if something cannot be set up, the corresponding field of /ctx/ is left
+// /NULL/.
+void wireless_ctx_init(WirelessCtx *ctx, bool subscribe);
+
+// Returns the file descriptor of the event socket, or /-1/ if there is none.
+int wireless_ctx_event_fd(WirelessCtx *ctx);
+
+// Reads all pending nl80211 events (without blocking). Returns /true/ if there was any.
+bool wireless_ctx_drain_events(WirelessCtx *ctx);
+
+void wireless_ctx_destroy(WirelessCtx *ctx);
+
+bool get_wireless_info(WirelessCtx *ctx, int ifindex, WirelessInfo *info);
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "netdev_reader.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+
+#include "libls/ls_alloc_utils.h"
+#include "libls/ls_io_utils.h"
+#include "libls/ls_osdep.h"
+#include "libls/ls_string.h"
+#include "libls/ls_xallocf.h"
+
+int netdev_reader_open(NetdevReader *r, NetdevSource source, const char *procpath)
+{
+    *r = (NetdevReader) {
+        .source = source,
+        .fd = -1,
+        .seq = 0,
+        .buf = ls_string_new_reserve(8192),
+    };
+
+    if (source == NETDEV_SOURCE_PROCFS) {
+        char *path = ls_xallocf("%s/net/dev", procpath);
+        r->fd = open(path, O_RDONLY | O_CLOEXEC);
+        free(path);
+    } else {
+        r->fd = ls_cloexec_socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+    }
+
+    if (r->fd < 0) {
+        int saved_errno = errno;
+        ls_string_free(r->buf);
+        errno = saved_errno;
+        return -1;
+    }
+    return 0;
+}
+
+// Reads the whole file into /r->buf/.
+static int read_whole_file(NetdevReader *r)
+{
+    r->buf.size = 0;
+    for (;;) {
+        ls_string_ensure_avail(&r->buf, 4096);
+        size_t avail = r->buf.capacity - r->buf.size;
+        ssize_t nread = pread(r->fd, r->buf.data + r->buf.size, avail, r->buf.size);
+        if (nread < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (nread == 0) {
+            return 0;
+        }
+        r->buf.size += nread;
+    }
+}
+
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// Parses a decimal number starting at /*ps/ (skipping leading spaces), and advances /*ps/ past it.
+static bool scan_u64(const char **ps, const char *end, uint64_t *out)
+{
+    const char *s = *ps;
+    while (s != end && is_space(*s)) {
+        ++s;
+    }
+    if (s == end || *s < '0' || *s > '9') {
+        return false;
+    }
+    uint64_t x = 0;
+    for (; s != end && *s >= '0' && *s <= '9'; ++s) {
+        x = x * 10 + (*s - '0');
+    }
+    *ps = s;
+    *out = x;
+    return true;
+}
+
+/* /proc/net/dev looks like this:
+
+Inter-|   Receive                                                |  Transmit
+ face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed
+docker0:       0       0    0    0    0     0          0         0        0       0    0    0    0     0       0          0
+wlp2s0: 39893402   38711    0    0    0     0          0         0  3676924   27205    0    0    0     0       0          0
+    lo:       0       0    0    0    0     0          0         0        0       0    0    0    0     0       0          0
+*/
+
+static int read_procfs(NetdevReader *r, NetdevVisitor v)
+{
+    if (read_whole_file(r) < 0) {
+        return -1;
+    }
+
+    const char *s = r->buf.data;
+    const char *end = s + r->buf.size;
+
+    while (s != end) {
+        const char *line_end = memchr(s, '\n', end - s);
+        if (!line_end) {
+            line_end = end;
+        }
+
+        if (!memchr(s, '|', line_end - s)) {
+            // Not a header line.
+            while (s != line_end && is_space(*s)) {
+                ++s;
+            }
+            const char *colon = memchr(s, ':', line_end - s);
+            if (!colon || colon == s) {
+                errno = EPROTO;
+                return -1;
+            }
+            const char *name = s;
+            size_t nname = colon - s;
+
+            if (v.want(v.ud, name, nname)) {
+                const char *t = colon + 1;
+                uint64_t recv = 0;
+                uint64_t sent = 0;
+                for (int i = 0; i < 9; ++i) {
+                    uint64_t x;
+                    if (!scan_u64(&t, line_end, &x)) {
+                        errno = EPROTO;
+                        return -1;
+                    }
+                    if (i == 0) {
+                        recv = x;
+                    }
+                    sent = x;
+                }
+                v.put(v.ud, name, nname, recv, sent);
+            }
+        }
+
+        s = line_end == end ? end : line_end + 1;
+    }
+    return 0;
+}
+
+static int read_netlink(NetdevReader *r, NetdevVisitor v)
+{
+    // See /plugins/network-linux/iface_table.c/ on the buffer size.
+    enum { NBUF = 32768 };
+
+    uint32_t seq = ++r->seq;
+    struct {
+        struct nlmsghdr nh;
+        struct ifinfomsg ifi;
+    } req = {
+        .nh = {
+            .nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg)),
+            .nlmsg_type = RTM_GETLINK,
+            .nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP,
+            .nlmsg_seq = seq,
+        },
+        .ifi = {.ifi_family = AF_UNSPEC},
+    };
+    struct sockaddr_nl sa = {.nl_family = AF_NETLINK};
+
+    while (sendto(r->fd, &req, req.nh.nlmsg_len, 0, (struct sockaddr *) &sa, sizeof(sa)) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+
+    ls_string_reserve(&r->buf, NBUF);
+
+    for (;;) {
+        struct iovec iov = {.iov_base = r->buf.data, .iov_len = NBUF};
+        struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1};
+        ssize_t nread = recvmsg(r->fd, &msg, 0);
+        if (nread < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (nread == 0 || (msg.msg_flags & MSG_TRUNC)) {
+            errno = EPROTO;
+            return -1;
+        }
+        size_t len = nread;
+        for (
+            struct nlmsghdr *nh = (struct nlmsghdr *) r->buf.data;
+            NLMSG_OK(nh, len);
+            nh = NLMSG_NEXT(nh, len))
+        {
+            if (nh->nlmsg_seq != seq) {
+                // A reply to an earlier request that has failed midway.
+                continue;
+            }
+            if (nh->nlmsg_type == NLMSG_DONE) {
+                return 0;
+            }
+            if (nh->nlmsg_type == NLMSG_ERROR) {
+                struct nlmsgerr *e = NLMSG_DATA(nh);
+                if (nh->nlmsg_len < NLMSG_LENGTH(sizeof(*e)) || !e->error) {
+                    errno = EPROTO;
+                } else {
+                    errno = -e->error;
+                }
+                return -1;
+            }
+            if (nh->nlmsg_type != RTM_NEWLINK ||
+                nh->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg)))
+            {
+                continue;
+            }
+
+            const char *name = NULL;
+            size_t nname = 0;
+            const struct rtattr *rta_stats = NULL;
+
+            struct ifinfomsg *ifi = NLMSG_DATA(nh);
+            size_t alen = IFLA_PAYLOAD(nh);
+            for (
+                struct rtattr *rta = IFLA_RTA(ifi);
+                RTA_OK(rta, alen);
+                rta = RTA_NEXT(rta, alen))
+            {
+                if (rta->rta_type == IFLA_IFNAME) {
+                    name = RTA_DATA(rta);
+                    nname = strnlen(name, RTA_PAYLOAD(rta));
+                } else if (rta->rta_type == IFLA_STATS64) {
+                    rta_stats = rta;
+                }
+            }
+
+            if (!name || !rta_stats) {
+                continue;
+            }
+            if (RTA_PAYLOAD(rta_stats) < sizeof(struct rtnl_link_stats64)) {
+                continue;
+            }
+            if (!v.want(v.ud, name, nname)) {
+                continue;
+            }
+            // The attribute data is only guaranteed to be 4-byte aligned.
+            struct rtnl_link_stats64 stats;
+            memcpy(&stats, RTA_DATA(rta_stats), sizeof(stats));
+            v.put(v.ud, name, nname, stats.rx_bytes, stats.tx_bytes);
+        }
+    }
+}
+
+int netdev_reader_read(NetdevReader *r, NetdevVisitor v)
+{
+    switch (r->source) {
+    case NETDEV_SOURCE_PROCFS:
+        return read_procfs(r, v);
+    case NETDEV_SOURCE_NETLINK:
+        return read_netlink(r, v);
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+void netdev_reader_close(NetdevReader *r)
+{
+    ls_close(r->fd);
+    ls_string_free(r->buf);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "libls/ls_string.h"
+
+typedef enum {
+    NETDEV_SOURCE_PROCFS,
+    NETDEV_SOURCE_NETLINK,
+} NetdevSource;
+
+// Reads per-interface byte counters, either from /<procpath>/net/dev/ (which is kept open and
+// re-read with /pread()/), or from /IFLA_STATS64/ attributes of an rtnetlink /RTM_GETLINK/ dump
+// (over a long-lived socket).
+typedef struct {
+    NetdevSource source;
+    int fd;
+    uint32_t seq;
+    LS_String buf;
+} NetdevReader;
+
+typedef struct {
+    // Called first for each interface; should return whether the counters of the interface are
+    // wanted. Counters of unwanted interfaces are not even parsed.
+    bool (*want)(void *ud, const char *name, size_t nname);
+
+    // Called for each wanted interface, in the order reported by the kernel.
+    void (*put)(void *ud, const char *name, size_t nname, uint64_t recv, uint64_t sent);
+
+    void *ud;
+} NetdevVisitor;
+
+// On success, returns /0/. On failure, returns /-1/ and sets /errno/.
+int netdev_reader_open(NetdevReader *r, NetdevSource source, const char *procpath);
+
+// On success, returns /0/. On failure, returns /-1/ and sets /errno/ (/EPROTO/ if the data is
+// malformed); some of the interfaces may have been visited already then.
+int netdev_reader_read(NetdevReader *r, NetdevVisitor v);
+
+void netdev_reader_close(NetdevReader *r);
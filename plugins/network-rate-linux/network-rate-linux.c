@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lua.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "include/plugin_v2.h"
+#include "include/sayf_macros.h"
+
+#include "libmoonvisit/moonvisit.h"
+
+#include "libls/ls_alloc_utils.h"
+#include "libls/ls_strarr.h"
+#include "libls/ls_string.h"
+#include "libls/ls_tls_ebuf.h"
+#include "libls/ls_time_utils.h"
+
+#include "netdev_reader.h"
+
+// This is the native backend of the /network-rate-linux/ derived plugin; see
+// /network-rate-linux.lua/.
+
+typedef struct {
+    char *name;
+    uint64_t last_recv;
+    uint64_t last_sent;
+    // Whether /R/ and /S/ have been computed during the current read.
+    bool has_datum;
+    double R;
+    double S;
+} IfaceState;
+
+typedef struct {
+    double period;
+    bool in_array_form;
+
+    // Either an "only" list or an "except" list (depending on /filter_negate/), or no filter if
+    // /has_filter/ is false.
+    bool has_filter;
+    bool filter_negate;
+    LS_StringArray filter_names;
+
+    NetdevSource source;
+    char *procpath;
+    NetdevReader reader;
+    bool reader_opened;
+
+    // Interfaces in the order they were reported by the last read.
+    IfaceState *ifaces;
+    size_t nifaces;
+    size_t ifaces_capacity;
+
+    // Position in /ifaces/ where the next reported interface is expected to be.
+    size_t hint;
+} Priv;
+
+static void destroy(LuastatusPluginData *pd)
+{
+    Priv *p = pd->priv;
+    ls_strarr_destroy(p->filter_names);
+    free(p->procpath);
+    if (p->reader_opened) {
+        netdev_reader_close(&p->reader);
+    }
+    for (size_t i = 0; i < p->nifaces; ++i) {
+        free(p->ifaces[i].name);
+    }
+    free(p->ifaces);
+    free(p);
+}
+
+static int parse_filter_elem(MoonVisit *mv, void *ud, int kpos, int vpos)
+{
+    mv->where = "'filter' element";
+    (void) kpos;
+
+    Priv *p = ud;
+
+    if (moon_visit_checktype_at(mv, NULL, vpos, LUA_TSTRING) < 0)
+        return -1;
+
+    size_t ns;
+    const char *s = lua_tolstring(mv->L, vpos, &ns);
+    ls_strarr_append(&p->filter_names, s, ns);
+    return 1;
+}
+
+static int init(LuastatusPluginData *pd, lua_State *L)
+{
+    Priv *p = pd->priv = LS_XNEW(Priv, 1);
+    *p = (Priv) {
+        .period = 1.0,
+        .in_array_form = false,
+        .has_filter = false,
+        .filter_negate = false,
+        .filter_names = ls_strarr_new(),
+        .source = NETDEV_SOURCE_PROCFS,
+        .procpath = NULL,
+        .reader_opened = false,
+        .ifaces = NULL,
+        .nifaces = 0,
+        .ifaces_capacity = 0,
+        .hint = 0,
+    };
+    char errbuf[256];
+    MoonVisit mv = {.L = L, .errbuf = errbuf, .nerrbuf = sizeof(errbuf)};
+
+    // Parse period
+    if (moon_visit_num(&mv, -1, "period", &p->period, true) < 0)
+        goto mverror;
+    if (!ls_double_is_good_time_delta(p->period)) {
+        LS_FATALF(pd, "period is invalid");
+        goto error;
+    }
+
+    // Parse in_array_form
+    if (moon_visit_bool(&mv, -1, "in_array_form", &p->in_array_form, true) < 0)
+        goto mverror;
+
+    // Parse filter
+    lua_getfield(L, -1, "filter"); // L: opts filter
+    p->has_filter = !lua_isnil(L, -1);
+    lua_pop(L, 1); // L: opts
+    if (moon_visit_table_f(&mv, -1, "filter", parse_filter_elem, p, true) < 0)
+        goto mverror;
+
+    // Parse filter_negate
+    if (moon_visit_bool(&mv, -1, "filter_negate", &p->filter_negate, true) < 0)
+        goto mverror;
+
+    // Parse source
+    char *source = NULL;
+    if (moon_visit_str(&mv, -1, "source", &source, NULL, true) < 0)
+        goto mverror;
+    if (source) {
+        if (strcmp(source, "procfs") == 0) {
+            p->source = NETDEV_SOURCE_PROCFS;
+        } else if (strcmp(source, "netlink") == 0) {
+            p->source = NETDEV_SOURCE_NETLINK;
+        } else {
+            LS_FATALF(pd, "invalid source: '%s' (expected 'procfs' or 'netlink')", source);
+            free(source);
+            goto error;
+        }
+        free(source);
+    }
+
+    // Parse iface_filter: a Lua function, which this plugin cannot use; /widget()/ of the derived
+    // plugin only passes it here if it is combined with /source/, /iface_only/ or /iface_except/.
+    lua_getfield(L, -1, "iface_filter"); // L: opts iface_filter
+    bool has_iface_filter = !lua_isnil(L, -1);
+    lua_pop(L, 1); // L: opts
+    if (has_iface_filter) {
+        LS_FATALF(pd, "iface_filter cannot be used together with source, iface_only or "
+                      "iface_except");
+        goto error;
+    }
+
+    // Parse _procpath
+    if (moon_visit_str(&mv, -1, "_procpath", &p->procpath, NULL, true) < 0)
+        goto mverror;
+    if (!p->procpath) {
+        p->procpath = ls_xstrdup("/proc");
+    }
+
+    return LUASTATUS_OK;
+
+mverror:
+    LS_FATALF(pd, "%s", errbuf);
+error:
+    destroy(pd);
+    return LUASTATUS_ERR;
+}
+
+static bool visitor_want(void *ud, const char *name, size_t nname)
+{
+    Priv *p = ud;
+    if (!p->has_filter) {
+        return true;
+    }
+    bool found = false;
+    size_t n = ls_strarr_size(p->filter_names);
+    for (size_t i = 0; i < n; ++i) {
+        size_t ns;
+        const char *s = ls_strarr_at(p->filter_names, i, &ns);
+        if (ns == nname && memcmp(s, name, nname) == 0) {
+            found = true;
+            break;
+        }
+    }
+    return found != p->filter_negate;
+}
+
+static bool name_eq(const char *s, const char *name, size_t nname)
+{
+    return strncmp(s, name, nname) == 0 && s[nname] == '\0';
+}
+
+static void visitor_put(void *ud, const char *name, size_t nname, uint64_t recv, uint64_t sent)
+{
+    Priv *p = ud;
+
+    // Interfaces are almost always reported in the same order as the last time, so look at the
+    // "expected" position first.
+    // Interfaces at positions /[0; hint)/ have already been seen during this read.
+    size_t i = p->hint;
+    if (i >= p->nifaces || !name_eq(p->ifaces[i].name, name, nname)) {
+        for (i = p->hint; i < p->nifaces; ++i) {
+            if (name_eq(p->ifaces[i].name, name, nname)) {
+                break;
+            }
+        }
+    }
+
+    IfaceState *st;
+    if (i == p->nifaces) {
+        if (p->nifaces == p->ifaces_capacity) {
+            p->ifaces = LS_M_X2REALLOC(p->ifaces, &p->ifaces_capacity);
+        }
+        st = &p->ifaces[p->nifaces++];
+        char *dup = LS_XNEW(char, nname + 1);
+        memcpy(dup, name, nname);
+        dup[nname] = '\0';
+        *st = (IfaceState) {.name = dup, .last_recv = recv, .last_sent = sent};
+    } else {
+        st = &p->ifaces[i];
+        st->has_datum = recv >= st->last_recv && sent >= st->last_sent && (recv || sent);
+        if (st->has_datum) {
+            st->R = (recv - st->last_recv) / p->period;
+            st->S = (sent - st->last_sent) / p->period;
+        }
+        st->last_recv = recv;
+        st->last_sent = sent;
+    }
+
+    // Keep /ifaces/ in the order of the last read, so that the hint works and the array form
+    // follows the kernel's order.
+    size_t pos = st - p->ifaces;
+    size_t want_pos = p->hint;
+    if (pos != want_pos) {
+        IfaceState tmp = p->ifaces[pos];
+        p->ifaces[pos] = p->ifaces[want_pos];
+        p->ifaces[want_pos] = tmp;
+    }
+    ++p->hint;
+}
+
+// Reads the counters. On failure, returns /false/; the state is reset then.
+static bool read_counters(LuastatusPluginData *pd)
+{
+    Priv *p = pd->priv;
+
+    if (!p->reader_opened) {
+        if (netdev_reader_open(&p->reader, p->source, p->procpath) < 0) {
+            LS_ERRF(pd, "netdev_reader_open: %s", ls_tls_strerror(errno));
+            return false;
+        }
+        p->reader_opened = true;
+    }
+
+    for (size_t i = 0; i < p->nifaces; ++i) {
+        p->ifaces[i].has_datum = false;
+    }
+    p->hint = 0;
+
+    NetdevVisitor v = {.want = visitor_want, .put = visitor_put, .ud = p};
+    bool ok = netdev_reader_read(&p->reader, v) >= 0;
+    if (!ok) {
+        LS_ERRF(pd, "netdev_reader_read: %s", ls_tls_strerror(errno));
+        netdev_reader_close(&p->reader);
+        p->reader_opened = false;
+    }
+
+    // Forget about interfaces that are gone (on failure, about all of them). The seen ones occupy
+    // positions /[0; hint)/.
+    size_t nkeep = ok ? p->hint : 0;
+    for (size_t i = nkeep; i < p->nifaces; ++i) {
+        free(p->ifaces[i].name);
+    }
+    p->nifaces = nkeep;
+
+    return ok;
+}
+
+static void make_call(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
+{
+    Priv *p = pd->priv;
+
+    lua_State *L = funcs.call_begin(pd->userdata);
+    // L: ?
+    lua_newtable(L); // L: ? result
+    size_t n = 0;
+    for (size_t i = 0; i < p->nifaces; ++i) {
+        IfaceState *st = &p->ifaces[i];
+        if (!st->has_datum) {
+            continue;
+        }
+        if (p->in_array_form) {
+            lua_createtable(L, 2, 0); // L: ? result entry
+            lua_pushstring(L, st->name); // L: ? result entry name
+            lua_rawseti(L, -2, 1); // L: ? result entry
+        }
+        lua_createtable(L, 0, 2); // L: ? result [entry] datum
+        lua_pushnumber(L, st->R); // L: ? result [entry] datum R
+        lua_setfield(L, -2, "R"); // L: ? result [entry] datum
+        lua_pushnumber(L, st->S); // L: ? result [entry] datum S
+        lua_setfield(L, -2, "S"); // L: ? result [entry] datum
+        if (p->in_array_form) {
+            lua_rawseti(L, -2, 2); // L: ? result entry
+            lua_rawseti(L, -2, ++n); // L: ? result
+        } else {
+            lua_setfield(L, -2, st->name); // L: ? result
+        }
+    }
+    funcs.call_end(pd->userdata);
+}
+
+static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
+{
+    Priv *p = pd->priv;
+
+    LS_TimeDelta period_TD = ls_double_to_TD_or_die(p->period);
+
+    for (;;) {
+        read_counters(pd);
+        make_call(pd, funcs);
+        funcs.call_idle(pd->userdata);
+        ls_sleep(period_TD);
+    }
+}
+
+LuastatusPluginIface_v2 luastatus_plugin_iface_v2 = {
+    .init = init,
+    .run = run,
+    .destroy = destroy,
+};
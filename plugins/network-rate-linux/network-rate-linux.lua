@@ -100,7 +100,7 @@ function P.reader_read(reader, divisor, in_array_form)
     return res
 end
 
-local function mkfilter(x, negate)
+local function mk_match_table(x)
     local match_table = {}
 
     if type(x) == 'string' then
@@ -125,30 +125,23 @@ local function mkfilter(x, negate)
         error('invalid iface_only/iface_except value (expected string or table)')
     end
 
-    if negate then
-        return function(iface)
-            return not match_table[iface]
-        end
-    else
-        return function(iface)
-            return match_table[iface]
-        end
-    end
+    return match_table
 end
 
-function P.widget(tbl)
-    local iface_filter
-    if tbl.iface_only then
-        iface_filter = mkfilter(tbl.iface_only, false)
-    elseif tbl.iface_except then
-        iface_filter = mkfilter(tbl.iface_except, true)
-    else
-        iface_filter = tbl.iface_filter
+local function mk_name_list(x)
+    local names = {}
+    for k, _ in pairs(mk_match_table(x)) do
+        names[#names + 1] = k
     end
+    return names
+end
 
+-- Constructs a widget that uses the 'timer' plugin and a Lua reader; this is only needed if
+-- 'iface_filter' function is specified, as it cannot be passed to the native plugin.
+local function widget_with_lua_reader(tbl)
     local period = tbl.period or 1
 
-    local reader = P.reader_new(iface_filter)
+    local reader = P.reader_new(tbl.iface_filter)
     reader._procpath = tbl._procpath or DEFAULT_PROCPATH
 
     return {
@@ -163,4 +156,33 @@ function P.widget(tbl)
     }
 end
 
+function P.widget(tbl)
+    if tbl.iface_filter and not (tbl.iface_only or tbl.iface_except or tbl.source) then
+        return widget_with_lua_reader(tbl)
+    end
+
+    local filter, filter_negate
+    if tbl.iface_only then
+        filter, filter_negate = mk_name_list(tbl.iface_only), false
+    elseif tbl.iface_except then
+        filter, filter_negate = mk_name_list(tbl.iface_except), true
+    end
+
+    return {
+        plugin = 'network-rate-linux',
+        opts = {
+            period = tbl.period or 1,
+            in_array_form = tbl.in_array_form,
+            filter = filter,
+            filter_negate = filter_negate,
+            source = tbl.source,
+            -- Only non-nil here if combined with one of the above; the native plugin rejects it.
+            iface_filter = tbl.iface_filter,
+            _procpath = tbl._procpath,
+        },
+        cb = tbl.cb,
+        event = tbl.event,
+    }
+end
+
 return P
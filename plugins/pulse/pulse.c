@@ -19,6 +19,7 @@
 
 #include <lua.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <stdint.h>
 #include <unistd.h>
@@ -51,6 +52,8 @@
 
 typedef struct {
     char *sink_name;
+    pa_usec_t debounce_us;
+    bool report_all;
     int pipefds[2];
 } Priv;
 
@@ -68,6 +71,8 @@ static int init(LuastatusPluginData *pd, lua_State *L)
     Priv *p = pd->priv = LS_XNEW(Priv, 1);
     *p = (Priv) {
         .sink_name = NULL,
+        .debounce_us = 0,
+        .report_all = false,
         .pipefds = {-1, -1},
     };
     char errbuf[256];
@@ -79,6 +84,22 @@ static int init(LuastatusPluginData *pd, lua_State *L)
     if (!p->sink_name)
         p->sink_name = ls_xstrdup("@DEFAULT_SINK@");
 
+    // Parse debounce
+    double debounce = 0.0;
+    if (moon_visit_num(&mv, -1, "debounce", &debounce, true) < 0)
+        goto mverror;
+    // Also reject infinite and huge values, so that the conversion to microseconds below is well
+    // defined.
+    if (!ls_double_is_good_time_delta(debounce) || debounce > LS_TMO_MAX) {
+        LS_FATALF(pd, "debounce is invalid");
+        goto error;
+    }
+    p->debounce_us = debounce * PA_USEC_PER_SEC;
+
+    // Parse report_all
+    if (moon_visit_bool(&mv, -1, "report_all", &p->report_all, true) < 0)
+        goto mverror;
+
     // Parse make_self_pipe
     bool mkpipe = false;
     if (moon_visit_bool(&mv, -1, "make_self_pipe", &mkpipe, true) < 0)
@@ -107,13 +128,206 @@ static void register_funcs(LuastatusPluginData *pd, lua_State *L)
     lua_setfield(L, -2, "wake_up"); // L: table
 }
 
+// A sink or a source.
+typedef struct {
+    uint32_t index;
+    char *name;
+    char *desc;
+    pa_volume_t cur;
+    bool mute;
+    // Only meaningful for sources.
+    bool is_monitor;
+    bool has_port;
+    char *port_name;
+    char *port_desc;
+    int port_type;
+} Device;
+
+static inline char *xstrdup_or_null(const char *s)
+{
+    return s ? ls_xstrdup(s) : NULL;
+}
+
+static void device_free(Device d)
+{
+    free(d.name);
+    free(d.desc);
+    free(d.port_name);
+    free(d.port_desc);
+}
+
+// /Info_/ is either /const pa_sink_info */ or /const pa_source_info */.
+#if MY_CHECK_VERSION(14, 0, 0)
+# define PORT_TYPE_OF(Info_) ((Info_)->active_port->type)
+#else
+# define PORT_TYPE_OF(Info_) 0
+#endif
+#if MY_CHECK_VERSION(0, 9, 16)
+# define FILL_PORT(D_, Info_) \
+    do { \
+        if ((Info_)->active_port) { \
+            (D_)->has_port = true; \
+            (D_)->port_name = xstrdup_or_null((Info_)->active_port->name); \
+            (D_)->port_desc = xstrdup_or_null((Info_)->active_port->description); \
+            (D_)->port_type = PORT_TYPE_OF(Info_); \
+        } \
+    } while (0)
+#else
+# define FILL_PORT(D_, Info_) do {} while (0)
+#endif
+
+static Device device_from_sink(const pa_sink_info *info)
+{
+    Device d = {
+        .index = info->index,
+        .name = xstrdup_or_null(info->name),
+        .desc = xstrdup_or_null(info->description),
+        .cur = pa_cvolume_avg(&info->volume),
+        .mute = !!info->mute,
+        .is_monitor = false,
+        .has_port = false,
+    };
+    FILL_PORT(&d, info);
+    return d;
+}
+
+static Device device_from_source(const pa_source_info *info)
+{
+    Device d = {
+        .index = info->index,
+        .name = xstrdup_or_null(info->name),
+        .desc = xstrdup_or_null(info->description),
+        .cur = pa_cvolume_avg(&info->volume),
+        .mute = !!info->mute,
+        .is_monitor = info->monitor_of_sink != PA_INVALID_INDEX,
+        .has_port = false,
+    };
+    FILL_PORT(&d, info);
+    return d;
+}
+
+#undef FILL_PORT
+#undef PORT_TYPE_OF
+
+// Array of devices, sorted by index.
+typedef struct {
+    Device *data;
+    size_t size;
+    size_t capacity;
+} DeviceList;
+
+static size_t device_list_lower_bound(DeviceList *x, uint32_t index)
+{
+    size_t lo = 0;
+    size_t hi = x->size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (x->data[mid].index < index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Takes ownership of /d/.
+static void device_list_put(DeviceList *x, Device d)
+{
+    size_t i = device_list_lower_bound(x, d.index);
+    if (i != x->size && x->data[i].index == d.index) {
+        device_free(x->data[i]);
+        x->data[i] = d;
+        return;
+    }
+    if (x->size == x->capacity) {
+        x->data = LS_M_X2REALLOC(x->data, &x->capacity);
+    }
+    memmove(x->data + i + 1, x->data + i, sizeof(Device) * (x->size - i));
+    x->data[i] = d;
+    ++x->size;
+}
+
+static bool device_list_remove(DeviceList *x, uint32_t index)
+{
+    size_t i = device_list_lower_bound(x, index);
+    if (i == x->size || x->data[i].index != index) {
+        return false;
+    }
+    device_free(x->data[i]);
+    memmove(x->data + i, x->data + i + 1, sizeof(Device) * (x->size - i - 1));
+    --x->size;
+    return true;
+}
+
+static void device_list_destroy(DeviceList *x)
+{
+    for (size_t i = 0; i < x->size; ++i) {
+        device_free(x->data[i]);
+    }
+    free(x->data);
+}
+
+// Set of indices of devices pending introspection.
+typedef struct {
+    uint32_t *data;
+    size_t size;
+    size_t capacity;
+} IndexSet;
+
+static void index_set_add(IndexSet *x, uint32_t index)
+{
+    for (size_t i = 0; i < x->size; ++i) {
+        if (x->data[i] == index) {
+            return;
+        }
+    }
+    if (x->size == x->capacity) {
+        x->data = LS_M_X2REALLOC(x->data, &x->capacity);
+    }
+    x->data[x->size++] = index;
+}
+
 typedef struct {
     LuastatusPluginData *pd;
     LuastatusPluginRunFuncs funcs;
     pa_mainloop *ml;
+    pa_mainloop_api *api;
+    pa_context *ctx;
     uint32_t sink_idx;
+
+    // Debouncing: events are recorded in the /pending_*/ fields below, and then processed all
+    // at once by /flush()/, either immediately or when /debounce_ev/ fires.
+    pa_time_event *debounce_ev;
+    bool debounce_armed;
+    bool pending_server;
+    // Only used if /report_all/ is false.
+    bool pending_sink;
+    // Only used if /report_all/ is true.
+    IndexSet pending_sinks;
+    IndexSet pending_sources;
+
+    // The following are only used if /report_all/ is true.
+    DeviceList sinks;
+    DeviceList sources;
+    char *default_sink;
+    char *default_source;
+    // Number of introspection operations in flight.
+    unsigned nops;
+    // Whether something has changed since the last call to /cb/.
+    bool dirty;
 } UserData;
 
+static void user_data_destroy(UserData *ud)
+{
+    free(ud->pending_sinks.data);
+    free(ud->pending_sources.data);
+    device_list_destroy(&ud->sinks);
+    device_list_destroy(&ud->sources);
+    free(ud->default_sink);
+    free(ud->default_source);
+}
+
 static void self_pipe_cb(
         pa_mainloop_api *api,
         pa_io_event *e,
@@ -176,6 +390,74 @@ static inline void push_str_or_nil(lua_State *L, const char *s)
     }
 }
 
+static void push_device(lua_State *L, const Device *d, bool is_source)
+{
+    // L: ?
+    lua_createtable(L, 0, 8); // L: ? table
+    lua_pushinteger(L, d->cur); // L: ? table integer
+    lua_setfield(L, -2, "cur"); // L: ? table
+    lua_pushinteger(L, PA_VOLUME_NORM); // L: ? table integer
+    lua_setfield(L, -2, "norm"); // L: ? table
+    lua_pushboolean(L, d->mute); // L: ? table boolean
+    lua_setfield(L, -2, "mute"); // L: ? table
+    lua_pushinteger(L, d->index); // L: ? table integer
+    lua_setfield(L, -2, "index"); // L: ? table
+    push_str_or_nil(L, d->name); // L: ? table string
+    lua_setfield(L, -2, "name"); // L: ? table
+    push_str_or_nil(L, d->desc); // L: ? table string
+    lua_setfield(L, -2, "desc"); // L: ? table
+
+    if (is_source) {
+        lua_pushboolean(L, d->is_monitor); // L: ? table boolean
+        lua_setfield(L, -2, "is_monitor"); // L: ? table
+    }
+
+#if MY_CHECK_VERSION(0, 9, 16)
+    if (!d->has_port) {
+        lua_pushnil(L); // L: ? table nil
+    } else {
+        lua_createtable(L, 0, 3); // L: ? table table
+        push_str_or_nil(L, d->port_name); // L: ? table table string
+        lua_setfield(L, -2, "name"); // L: ? table table
+        push_str_or_nil(L, d->port_desc); // L: ? table table string
+        lua_setfield(L, -2, "desc"); // L: ? table table
+# if MY_CHECK_VERSION(14, 0, 0)
+        push_port_type(L, d->port_type); // L: ? table table string
+        lua_setfield(L, -2, "type"); // L: ? table table
+# endif
+    }
+    lua_setfield(L, -2, "port"); // L: ? table
+#endif
+}
+
+static void push_device_list(lua_State *L, const DeviceList *x, bool is_source)
+{
+    // L: ?
+    lua_createtable(L, x->size, 0); // L: ? array
+    for (size_t i = 0; i < x->size; ++i) {
+        push_device(L, &x->data[i], is_source); // L: ? array table
+        lua_rawseti(L, -2, i + 1); // L: ? array
+    }
+}
+
+static void report_all_devices(UserData *ud)
+{
+    lua_State *L = ud->funcs.call_begin(ud->pd->userdata);
+    // L: ?
+    lua_createtable(L, 0, 4); // L: ? table
+    push_device_list(L, &ud->sinks, false); // L: ? table array
+    lua_setfield(L, -2, "sinks"); // L: ? table
+    push_device_list(L, &ud->sources, true); // L: ? table array
+    lua_setfield(L, -2, "sources"); // L: ? table
+    push_str_or_nil(L, ud->default_sink); // L: ? table string
+    lua_setfield(L, -2, "default_sink"); // L: ? table
+    push_str_or_nil(L, ud->default_source); // L: ? table string
+    lua_setfield(L, -2, "default_source"); // L: ? table
+    ud->funcs.call_end(ud->pd->userdata);
+
+    ud->dirty = false;
+}
+
 static void store_volume_from_sink_cb(
         pa_context *c,
         const pa_sink_info *info,
@@ -190,40 +472,11 @@ static void store_volume_from_sink_cb(
         LS_ERRF(ud->pd, "PulseAudio error: %s", pa_strerror(pa_context_errno(c)));
     } else if (eol == 0) {
         if (info->index == ud->sink_idx) {
+            Device d = device_from_sink(info);
             lua_State *L = ud->funcs.call_begin(ud->pd->userdata);
-            // L: ?
-            lua_createtable(L, 0, 7); // L: ? table
-            lua_pushinteger(L, pa_cvolume_avg(&info->volume)); // L: ? table integer
-            lua_setfield(L, -2, "cur"); // L: ? table
-            lua_pushinteger(L, PA_VOLUME_NORM); // L: ? table integer
-            lua_setfield(L, -2, "norm"); // L: ? table
-            lua_pushboolean(L, !!info->mute); // L: ? table boolean
-            lua_setfield(L, -2, "mute"); // L: ? table
-            lua_pushinteger(L, info->index); // L: ? table integer
-            lua_setfield(L, -2, "index"); // L: ? table
-            push_str_or_nil(L, info->name); // L: ? table string
-            lua_setfield(L, -2, "name"); // L: ? table
-            push_str_or_nil(L, info->description); // L: ? table string
-            lua_setfield(L, -2, "desc"); // L: ? table
-
-#if MY_CHECK_VERSION(0, 9, 16)
-            if (!info->active_port) {
-                lua_pushnil(L); // L: ? table nil
-            } else {
-                lua_createtable(L, 0, 3); // L: ? table table
-                push_str_or_nil(L, info->active_port->name); // L: ? table table string
-                lua_setfield(L, -2, "name"); // L: ? table table
-                push_str_or_nil(L, info->active_port->description); // L: ? table table string
-                lua_setfield(L, -2, "desc"); // L: ? table table
-# if MY_CHECK_VERSION(14, 0, 0)
-                push_port_type(L, info->active_port->type); // L: ? table table string
-                lua_setfield(L, -2, "type"); // L: ? table table
-# endif
-            }
-            lua_setfield(L, -2, "port"); // L: ? table
-#endif
-
+            push_device(L, &d, false);
             ud->funcs.call_end(ud->pd->userdata);
+            device_free(d);
         }
     }
 }
@@ -257,27 +510,97 @@ static void update_sink(pa_context *c, void *vud)
     }
 }
 
-static void subscribe_cb(
+// Called when an introspection operation issued in the /report_all/ mode has completed.
+static void op_done(UserData *ud)
+{
+    LS_ASSERT(ud->nops != 0);
+    if (--ud->nops == 0 && ud->dirty) {
+        report_all_devices(ud);
+    }
+}
+
+static void track_op(UserData *ud, pa_operation *o, const char *what)
+{
+    if (o) {
+        pa_operation_unref(o);
+        ++ud->nops;
+    } else {
+        LS_ERRF(ud->pd, "%s: %s", what, pa_strerror(pa_context_errno(ud->ctx)));
+    }
+}
+
+static void report_introspection_error(UserData *ud, pa_context *c)
+{
+    // The device may have been removed in the meantime; if so, there will be a "remove" event.
+    if (pa_context_errno(c) != PA_ERR_NOENTITY) {
+        LS_ERRF(ud->pd, "PulseAudio error: %s", pa_strerror(pa_context_errno(c)));
+    }
+}
+
+static void cache_sink_cb(
         pa_context *c,
-        pa_subscription_event_type_t t,
-        uint32_t idx,
+        const pa_sink_info *info,
+        int eol,
         void *vud)
 {
     UserData *ud = vud;
+    if (eol == 0) {
+        device_list_put(&ud->sinks, device_from_sink(info));
+        ud->dirty = true;
+        return;
+    }
+    if (eol < 0) {
+        report_introspection_error(ud, c);
+    }
+    op_done(ud);
+}
 
-    if ((t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) != PA_SUBSCRIPTION_EVENT_CHANGE) {
+static void cache_source_cb(
+        pa_context *c,
+        const pa_source_info *info,
+        int eol,
+        void *vud)
+{
+    UserData *ud = vud;
+    if (eol == 0) {
+        device_list_put(&ud->sources, device_from_source(info));
+        ud->dirty = true;
         return;
     }
-    pa_subscription_event_type_t facility = t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
-    switch (facility) {
-    case PA_SUBSCRIPTION_EVENT_SERVER:
-        // server change event, see if the sink has changed
-        update_sink(c, vud);
-        break;
-    case PA_SUBSCRIPTION_EVENT_SINK:
-        {
+    if (eol < 0) {
+        report_introspection_error(ud, c);
+    }
+    op_done(ud);
+}
+
+static void cache_server_cb(pa_context *c, const pa_server_info *info, void *vud)
+{
+    UserData *ud = vud;
+    if (info) {
+        free(ud->default_sink);
+        ud->default_sink = xstrdup_or_null(info->default_sink_name);
+        free(ud->default_source);
+        ud->default_source = xstrdup_or_null(info->default_source_name);
+        ud->dirty = true;
+    } else {
+        report_introspection_error(ud, c);
+    }
+    op_done(ud);
+}
+
+static void flush(UserData *ud)
+{
+    Priv *p = ud->pd->priv;
+    pa_context *c = ud->ctx;
+
+    if (!p->report_all) {
+        if (ud->pending_server) {
+            // server change event, see if the sink has changed
+            update_sink(c, ud);
+        }
+        if (ud->pending_sink) {
             pa_operation *o = pa_context_get_sink_info_by_index(
-                c, idx, store_volume_from_sink_cb, vud);
+                c, ud->sink_idx, store_volume_from_sink_cb, ud);
 
             if (o) {
                 pa_operation_unref(o);
@@ -286,15 +609,154 @@ static void subscribe_cb(
                         pa_strerror(pa_context_errno(c)));
             }
         }
+        ud->pending_server = false;
+        ud->pending_sink = false;
+        return;
+    }
+
+    if (ud->pending_server) {
+        track_op(
+            ud,
+            pa_context_get_server_info(c, cache_server_cb, ud),
+            "pa_context_get_server_info");
+    }
+    for (size_t i = 0; i < ud->pending_sinks.size; ++i) {
+        track_op(
+            ud,
+            pa_context_get_sink_info_by_index(c, ud->pending_sinks.data[i], cache_sink_cb, ud),
+            "pa_context_get_sink_info_by_index");
+    }
+    for (size_t i = 0; i < ud->pending_sources.size; ++i) {
+        track_op(
+            ud,
+            pa_context_get_source_info_by_index(
+                c, ud->pending_sources.data[i], cache_source_cb, ud),
+            "pa_context_get_source_info_by_index");
+    }
+    ud->pending_server = false;
+    ud->pending_sinks.size = 0;
+    ud->pending_sources.size = 0;
+
+    // E.g. if only "remove" events have been received.
+    if (!ud->nops && ud->dirty) {
+        report_all_devices(ud);
+    }
+}
+
+static void debounce_cb(
+        pa_mainloop_api *api,
+        pa_time_event *e,
+        const struct timeval *tv,
+        void *vud)
+{
+    (void) api;
+    (void) e;
+    (void) tv;
+
+    UserData *ud = vud;
+    ud->debounce_armed = false;
+    flush(ud);
+}
+
+// Arranges for /flush()/ to be called: immediately if debouncing is disabled, otherwise when the
+// debounce window, which starts at the first event after the previous flush, ends.
+static void schedule_flush(UserData *ud)
+{
+    Priv *p = ud->pd->priv;
+
+    if (p->debounce_us == 0) {
+        flush(ud);
+        return;
+    }
+    if (ud->debounce_armed) {
+        return;
+    }
+
+    struct timeval tv;
+    pa_gettimeofday(&tv);
+    pa_timeval_add(&tv, p->debounce_us);
+
+    if (ud->debounce_ev) {
+        ud->api->time_restart(ud->debounce_ev, &tv);
+    } else {
+        ud->debounce_ev = ud->api->time_new(ud->api, &tv, debounce_cb, ud);
+        if (!ud->debounce_ev) {
+            LS_ERRF(ud->pd, "time_new() failed");
+            flush(ud);
+            return;
+        }
+    }
+    ud->debounce_armed = true;
+}
+
+static void subscribe_cb(
+        pa_context *c,
+        pa_subscription_event_type_t t,
+        uint32_t idx,
+        void *vud)
+{
+    (void) c;
+
+    UserData *ud = vud;
+    Priv *p = ud->pd->priv;
+
+    pa_subscription_event_type_t type = t & PA_SUBSCRIPTION_EVENT_TYPE_MASK;
+    pa_subscription_event_type_t facility = t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
+
+    if (!p->report_all) {
+        if (type != PA_SUBSCRIPTION_EVENT_CHANGE) {
+            return;
+        }
+        switch (facility) {
+        case PA_SUBSCRIPTION_EVENT_SERVER:
+            ud->pending_server = true;
+            break;
+        case PA_SUBSCRIPTION_EVENT_SINK:
+            // Changes of other sinks are of no interest to us.
+            if (idx != ud->sink_idx) {
+                return;
+            }
+            ud->pending_sink = true;
+            break;
+        default:
+            return;
+        }
+        schedule_flush(ud);
+        return;
+    }
+
+    switch (facility) {
+    case PA_SUBSCRIPTION_EVENT_SERVER:
+        ud->pending_server = true;
         break;
-    default:
+    case PA_SUBSCRIPTION_EVENT_SINK:
+        if (type == PA_SUBSCRIPTION_EVENT_REMOVE) {
+            if (device_list_remove(&ud->sinks, idx)) {
+                ud->dirty = true;
+            }
+        } else {
+            index_set_add(&ud->pending_sinks, idx);
+        }
+        break;
+    case PA_SUBSCRIPTION_EVENT_SOURCE:
+        if (type == PA_SUBSCRIPTION_EVENT_REMOVE) {
+            if (device_list_remove(&ud->sources, idx)) {
+                ud->dirty = true;
+            }
+        } else {
+            index_set_add(&ud->pending_sources, idx);
+        }
         break;
+    default:
+        return;
     }
+    schedule_flush(ud);
 }
 
 static void context_state_cb(pa_context *c, void *vud)
 {
     UserData *ud = vud;
+    Priv *p = ud->pd->priv;
     switch (pa_context_get_state(c)) {
     case PA_CONTEXT_UNCONNECTED:
     case PA_CONTEXT_CONNECTING:
@@ -307,9 +769,29 @@ static void context_state_cb(pa_context *c, void *vud)
     case PA_CONTEXT_READY:
         {
             pa_context_set_subscribe_callback(c, subscribe_cb, vud);
-            update_sink(c, vud);
-            pa_operation *o = pa_context_subscribe(
-                c, PA_SUBSCRIPTION_MASK_SINK | PA_SUBSCRIPTION_MASK_SERVER, NULL, NULL);
+
+            pa_subscription_mask_t mask = PA_SUBSCRIPTION_MASK_SINK | PA_SUBSCRIPTION_MASK_SERVER;
+            if (p->report_all) {
+                mask |= PA_SUBSCRIPTION_MASK_SOURCE;
+                // Fill the cache.
+                ud->dirty = true;
+                track_op(
+                    ud,
+                    pa_context_get_server_info(c, cache_server_cb, ud),
+                    "pa_context_get_server_info");
+                track_op(
+                    ud,
+                    pa_context_get_sink_info_list(c, cache_sink_cb, ud),
+                    "pa_context_get_sink_info_list");
+                track_op(
+                    ud,
+                    pa_context_get_source_info_list(c, cache_source_cb, ud),
+                    "pa_context_get_source_info_list");
+            } else {
+                update_sink(c, vud);
+            }
+
+            pa_operation *o = pa_context_subscribe(c, mask, NULL, NULL);
 
             if (o) {
                 pa_operation_unref(o);
@@ -343,6 +825,7 @@ static bool iteration(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
         LS_FATALF(pd, "pa_mainloop_get_api() failed");
         goto error;
     }
+    ud.api = api;
     pa_proplist *proplist = pa_proplist_new();
     pa_proplist_sets(proplist, PA_PROP_APPLICATION_NAME, "luastatus-plugin-pulse");
     pa_proplist_sets(proplist, PA_PROP_APPLICATION_ID, "io.github.shdown.luastatus");
@@ -353,6 +836,7 @@ static bool iteration(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
         LS_FATALF(pd, "pa_context_new_with_proplist() failed");
         goto error;
     }
+    ud.ctx = ctx;
 
     pa_context_set_state_callback(ctx, context_state_cb, &ud);
     if (pa_context_connect(ctx, NULL, PA_CONTEXT_NOFAIL | PA_CONTEXT_NOAUTOSPAWN, NULL) < 0) {
@@ -381,12 +865,17 @@ error:
         LS_ASSERT(api != NULL);
         api->io_free(pipe_ev);
     }
+    if (ud.debounce_ev) {
+        LS_ASSERT(api != NULL);
+        api->time_free(ud.debounce_ev);
+    }
     if (ctx) {
         pa_context_unref(ctx);
     }
     if (ud.ml) {
         pa_mainloop_free(ud.ml);
     }
+    user_data_destroy(&ud);
     return ret;
 }
 
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "sensor_set.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/types.h>
+
+#include "libls/ls_alloc_utils.h"
+#include "libls/ls_xallocf.h"
+
+SensorSet sensor_set_new(void)
+{
+    return (SensorSet) {.sensors = NULL, .nsensors = 0, .capacity = 0};
+}
+
+// Returns the first number in /s/, or /-1/ if there is none.
+static long first_number(const char *s)
+{
+    s += strcspn(s, "0123456789");
+    if (!*s) {
+        return -1;
+    }
+    long r = 0;
+    for (; *s >= '0' && *s <= '9'; ++s) {
+        if (r < 100000000L) {
+            r = r * 10 + (*s - '0');
+        }
+    }
+    return r;
+}
+
+typedef struct {
+    Sensor sensor;
+    long sort_key;
+} Candidate;
+
+typedef struct {
+    Candidate *data;
+    size_t size;
+    size_t capacity;
+} Candidates;
+
+static int candidate_cmp(const void *a, const void *b)
+{
+    const Candidate *x = a;
+    const Candidate *y = b;
+    if (x->sort_key != y->sort_key) {
+        return x->sort_key < y->sort_key ? -1 : 1;
+    }
+    return strcmp(x->sensor.path, y->sensor.path);
+}
+
+// Takes ownership of /name/ and /path/.
+static void add_candidate(
+        Candidates *c,
+        SensorKind kind,
+        char *name,
+        char *path,
+        long sort_key)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        free(name);
+        free(path);
+        return;
+    }
+    if (c->size == c->capacity) {
+        c->data = LS_M_X2REALLOC(c->data, &c->capacity);
+    }
+    c->data[c->size++] = (Candidate) {
+        .sensor = {
+            .kind = kind,
+            .name = name,
+            .path = path,
+            .fd = fd,
+            .has_value = false,
+            .ever_read = false,
+            .value = 0,
+        },
+        .sort_key = sort_key,
+    };
+}
+
+static void flush_candidates(SensorSet *s, Candidates *c)
+{
+    qsort(c->data, c->size, sizeof(Candidate), candidate_cmp);
+    for (size_t i = 0; i < c->size; ++i) {
+        if (s->nsensors == s->capacity) {
+            s->sensors = LS_M_X2REALLOC(s->sensors, &s->capacity);
+        }
+        s->sensors[s->nsensors++] = c->data[i].sensor;
+    }
+    c->size = 0;
+}
+
+static bool is_dot_or_dotdot(const char *s)
+{
+    return s[0] == '.' && (s[1] == '\0' || (s[1] == '.' && s[2] == '\0'));
+}
+
+static void scan_thermal(Candidates *c, const char *thermal_path)
+{
+    DIR *d = opendir(thermal_path);
+    if (!d) {
+        return;
+    }
+    struct dirent *e;
+    while ((e = readdir(d))) {
+        if (strncmp(e->d_name, "thermal_zone", 12) != 0) {
+            continue;
+        }
+        char *path = ls_xallocf("%s/%s/temp", thermal_path, e->d_name);
+        add_candidate(
+            c, SENSOR_KIND_THERMAL, ls_xstrdup(e->d_name), path, first_number(e->d_name));
+    }
+    closedir(d);
+}
+
+// Reads the first line of /<dir>/name/. Returns a newly allocated string, or /NULL/ if the file
+// cannot be read or the line is empty.
+static char *read_monitor_name(const char *dir)
+{
+    char *path = ls_xallocf("%s/name", dir);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    free(path);
+    if (fd < 0) {
+        return NULL;
+    }
+    char buf[256];
+    ssize_t r;
+    do {
+        r = read(fd, buf, sizeof(buf) - 1);
+    } while (r < 0 && errno == EINTR);
+    close(fd);
+    if (r <= 0) {
+        return NULL;
+    }
+    buf[r] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+    if (!buf[0]) {
+        return NULL;
+    }
+    return ls_xstrdup(buf);
+}
+
+static void scan_hwmon_monitor(Candidates *c, const char *dir)
+{
+    char *monitor_name = read_monitor_name(dir);
+    if (!monitor_name) {
+        return;
+    }
+    DIR *d = opendir(dir);
+    if (d) {
+        struct dirent *e;
+        while ((e = readdir(d))) {
+            if (fnmatch("temp*_input", e->d_name, FNM_PERIOD) != 0) {
+                continue;
+            }
+            char *path = ls_xallocf("%s/%s", dir, e->d_name);
+            add_candidate(
+                c, SENSOR_KIND_HWMON, ls_xstrdup(monitor_name), path, first_number(e->d_name));
+        }
+        closedir(d);
+    }
+    free(monitor_name);
+}
+
+static void scan_hwmon(Candidates *c, const char *hwmon_path)
+{
+    DIR *d = opendir(hwmon_path);
+    if (!d) {
+        return;
+    }
+    struct dirent *e;
+    while ((e = readdir(d))) {
+        if (is_dot_or_dotdot(e->d_name)) {
+            continue;
+        }
+        char *dir = ls_xallocf("%s/%s", hwmon_path, e->d_name);
+        scan_hwmon_monitor(c, dir);
+        free(dir);
+    }
+    closedir(d);
+}
+
+void sensor_set_rescan(SensorSet *s, const char *thermal_path, const char *hwmon_path)
+{
+    sensor_set_clear(s);
+
+    Candidates c = {.data = NULL, .size = 0, .capacity = 0};
+
+    scan_thermal(&c, thermal_path);
+    flush_candidates(s, &c);
+
+    scan_hwmon(&c, hwmon_path);
+    flush_candidates(s, &c);
+
+    free(c.data);
+}
+
+static int read_sensor(Sensor *sensor)
+{
+    char buf[64];
+    ssize_t r;
+    do {
+        r = pread(sensor->fd, buf, sizeof(buf) - 1, 0);
+    } while (r < 0 && errno == EINTR);
+    if (r < 0) {
+        return -1;
+    }
+    buf[r] = '\0';
+
+    char *endptr;
+    errno = 0;
+    double value = strtod(buf, &endptr);
+    if (endptr == buf || errno) {
+        errno = EPROTO;
+        return -1;
+    }
+    sensor->value = value;
+    return 0;
+}
+
+int sensor_set_read(SensorSet *s)
+{
+    for (size_t i = 0; i < s->nsensors; ++i) {
+        Sensor *sensor = &s->sensors[i];
+        sensor->has_value = read_sensor(sensor) >= 0;
+        if (sensor->has_value) {
+            sensor->ever_read = true;
+        } else if (sensor->ever_read) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void sensor_set_clear(SensorSet *s)
+{
+    for (size_t i = 0; i < s->nsensors; ++i) {
+        Sensor *sensor = &s->sensors[i];
+        close(sensor->fd);
+        free(sensor->name);
+        free(sensor->path);
+    }
+    s->nsensors = 0;
+}
+
+void sensor_set_destroy(SensorSet *s)
+{
+    sensor_set_clear(s);
+    free(s->sensors);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    SENSOR_KIND_THERMAL,
+    SENSOR_KIND_HWMON,
+} SensorKind;
+
+typedef struct {
+    SensorKind kind;
+    // For thermal sensors, the name of the thermal zone directory; for hwmon sensors, the first
+    // line of the monitor's /name/ file.
+    char *name;
+    char *path;
+    int fd;
+    // Whether the last reading succeeded; /value/ is only meaningful if so.
+    bool has_value;
+    // Whether any reading has succeeded since the sensor was discovered.
+    bool ever_read;
+    double value;
+} Sensor;
+
+// A set of temperature sensors discovered under the thermal and hwmon sysfs class directories.
+// The sensor files are kept open and re-read with /pread()/.
+typedef struct {
+    Sensor *sensors;
+    size_t nsensors;
+    size_t capacity;
+} SensorSet;
+
+SensorSet sensor_set_new(void);
+
+// Discards the current set of sensors and scans /thermal_path/ and /hwmon_path/ for new ones.
+// Thermal sensors go first, then hwmon ones; within a kind, sensors are sorted by the first number
+// in the name of the thermal zone directory or of the /temp*_input/ file.
+//
+// Directories that cannot be opened are treated as empty; files that cannot be opened are skipped.
+void sensor_set_rescan(SensorSet *s, const char *thermal_path, const char *hwmon_path);
+
+// Reads the current values of all sensors into their /value/ fields, and sets their /has_value/
+// fields accordingly. A sensor that has not been read successfully even once since it was
+// discovered (say, a broken one) does not count as a failure; it is just left without a value.
+//
+// On success, returns /0/. If a sensor that used to be readable could not be read, returns /-1/ and
+// sets /errno/ (/EPROTO/ if the contents of a file could not be parsed); the set of sensors has
+// then most likely changed, and should be rescanned.
+int sensor_set_read(SensorSet *s);
+
+void sensor_set_clear(SensorSet *s);
+
+void sensor_set_destroy(SensorSet *s);
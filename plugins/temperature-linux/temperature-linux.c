@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2015-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lua.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "include/plugin_v2.h"
+#include "include/sayf_macros.h"
+
+#include "libmoonvisit/moonvisit.h"
+
+#include "libls/ls_alloc_utils.h"
+#include "libls/ls_panic.h"
+#include "libls/ls_time_utils.h"
+
+#include "sensor_set.h"
+
+// This is the native backend of the /temperature-linux/ derived plugin; see
+// /temperature-linux.lua/.
+
+typedef struct {
+    double period;
+    char *thermal_path;
+    char *hwmon_path;
+
+    SensorSet sensors;
+
+    // Guards /reload_requested/, which is set by the /reload()/ Lua function.
+    pthread_mutex_t reload_mtx;
+    bool reload_requested;
+} Priv;
+
+static void destroy(LuastatusPluginData *pd)
+{
+    Priv *p = pd->priv;
+    free(p->thermal_path);
+    free(p->hwmon_path);
+    sensor_set_destroy(&p->sensors);
+    LS_PTH_CHECK(pthread_mutex_destroy(&p->reload_mtx));
+    free(p);
+}
+
+static int init(LuastatusPluginData *pd, lua_State *L)
+{
+    Priv *p = pd->priv = LS_XNEW(Priv, 1);
+    *p = (Priv) {
+        .period = 1.0,
+        .thermal_path = NULL,
+        .hwmon_path = NULL,
+        .sensors = sensor_set_new(),
+        .reload_requested = false,
+    };
+    LS_PTH_CHECK(pthread_mutex_init(&p->reload_mtx, NULL));
+
+    char errbuf[256];
+    MoonVisit mv = {.L = L, .errbuf = errbuf, .nerrbuf = sizeof(errbuf)};
+
+    // Parse period
+    if (moon_visit_num(&mv, -1, "period", &p->period, true) < 0)
+        goto mverror;
+    if (!ls_double_is_good_time_delta(p->period)) {
+        LS_FATALF(pd, "period is invalid");
+        goto error;
+    }
+
+    // Parse _thermal_path
+    if (moon_visit_str(&mv, -1, "_thermal_path", &p->thermal_path, NULL, true) < 0)
+        goto mverror;
+    if (!p->thermal_path) {
+        p->thermal_path = ls_xstrdup("/sys/class/thermal");
+    }
+
+    // Parse _hwmon_path
+    if (moon_visit_str(&mv, -1, "_hwmon_path", &p->hwmon_path, NULL, true) < 0)
+        goto mverror;
+    if (!p->hwmon_path) {
+        p->hwmon_path = ls_xstrdup("/sys/class/hwmon");
+    }
+
+    return LUASTATUS_OK;
+
+mverror:
+    LS_FATALF(pd, "%s", errbuf);
+error:
+    destroy(pd);
+    return LUASTATUS_ERR;
+}
+
+static int l_reload(lua_State *L)
+{
+    Priv *p = lua_touserdata(L, lua_upvalueindex(1));
+    LS_PTH_CHECK(pthread_mutex_lock(&p->reload_mtx));
+    p->reload_requested = true;
+    LS_PTH_CHECK(pthread_mutex_unlock(&p->reload_mtx));
+    return 0;
+}
+
+static void register_funcs(LuastatusPluginData *pd, lua_State *L)
+{
+    // L: table
+    lua_pushlightuserdata(L, pd->priv); // L: table ud
+    lua_pushcclosure(L, l_reload, 1); // L: table func
+    lua_setfield(L, -2, "reload"); // L: table
+}
+
+static bool fetch_reload_requested(Priv *p)
+{
+    LS_PTH_CHECK(pthread_mutex_lock(&p->reload_mtx));
+    bool r = p->reload_requested;
+    p->reload_requested = false;
+    LS_PTH_CHECK(pthread_mutex_unlock(&p->reload_mtx));
+    return r;
+}
+
+static const char *kind_str(SensorKind kind)
+{
+    switch (kind) {
+    case SENSOR_KIND_THERMAL: return "thermal";
+    case SENSOR_KIND_HWMON:   return "hwmon";
+    }
+    LS_MUST_BE_UNREACHABLE();
+}
+
+static void make_call(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs, bool ok)
+{
+    Priv *p = pd->priv;
+
+    lua_State *L = funcs.call_begin(pd->userdata);
+    // L: ?
+    if (!ok) {
+        lua_pushnil(L); // L: ? nil
+        funcs.call_end(pd->userdata);
+        return;
+    }
+    lua_createtable(L, p->sensors.nsensors, 0); // L: ? result
+    size_t n = 0;
+    for (size_t i = 0; i < p->sensors.nsensors; ++i) {
+        Sensor *sensor = &p->sensors.sensors[i];
+        if (!sensor->has_value) {
+            continue;
+        }
+        lua_createtable(L, 0, 4); // L: ? result entry
+        lua_pushstring(L, kind_str(sensor->kind)); // L: ? result entry kind
+        lua_setfield(L, -2, "kind"); // L: ? result entry
+        lua_pushstring(L, sensor->name); // L: ? result entry name
+        lua_setfield(L, -2, "name"); // L: ? result entry
+        lua_pushstring(L, sensor->path); // L: ? result entry path
+        lua_setfield(L, -2, "path"); // L: ? result entry
+        lua_pushnumber(L, sensor->value / 1000); // L: ? result entry value
+        lua_setfield(L, -2, "value"); // L: ? result entry
+        lua_rawseti(L, -2, ++n); // L: ? result
+    }
+    funcs.call_end(pd->userdata);
+}
+
+static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
+{
+    Priv *p = pd->priv;
+
+    LS_TimeDelta period_TD = ls_double_to_TD_or_die(p->period);
+
+    sensor_set_rescan(&p->sensors, p->thermal_path, p->hwmon_path);
+
+    for (;;) {
+        if (fetch_reload_requested(p)) {
+            sensor_set_rescan(&p->sensors, p->thermal_path, p->hwmon_path);
+        }
+        bool ok = sensor_set_read(&p->sensors) >= 0;
+        if (!ok) {
+            // The set of sensors has most likely changed.
+            sensor_set_rescan(&p->sensors, p->thermal_path, p->hwmon_path);
+        }
+        make_call(pd, funcs, ok);
+        // /cb/ may have just requested a reload; do it now rather than after the sleep, so that
+        // the very next reading is already made with the new set of sensors.
+        if (fetch_reload_requested(p)) {
+            sensor_set_rescan(&p->sensors, p->thermal_path, p->hwmon_path);
+        }
+        funcs.call_idle(pd->userdata);
+        ls_sleep(period_TD);
+    }
+}
+
+LuastatusPluginIface_v2 luastatus_plugin_iface_v2 = {
+    .init = init,
+    .register_funcs = register_funcs,
+    .run = run,
+    .destroy = destroy,
+};
@@ -179,6 +179,29 @@ function P.get_temps(data)
     return r
 end
 
+-- Returns true if 'timer_opts' only contain options that the native plugin understands.
+local function timer_opts_are_native(timer_opts)
+    for k, _ in pairs(timer_opts or {}) do
+        if k ~= 'period' then
+            return false
+        end
+    end
+    return true
+end
+
+-- Constructs a widget that uses the 'timer' plugin and 'get_temps'; this is only needed if
+-- 'timer_opts' contain options other than 'period'.
+local function widget_with_lua_reader(tbl, data)
+    return {
+        plugin = 'timer',
+        opts = tbl.timer_opts,
+        cb = function()
+            return tbl.cb(P.get_temps(data))
+        end,
+        event = tbl.event,
+    }
+end
+
 function P.widget(tbl, data)
     data = data or {}
 
@@ -186,11 +209,39 @@ function P.widget(tbl, data)
         data.filter_func = tbl.filter_func
     end
 
+    if not timer_opts_are_native(tbl.timer_opts) then
+        return widget_with_lua_reader(tbl, data)
+    end
+
+    -- Passes a reload request on to the native plugin, which handles it before its next reading.
+    local function check_reload()
+        if data.please_reload then
+            data.please_reload = nil
+            luastatus.plugin.reload()
+        end
+    end
+
     return {
-        plugin = 'timer',
-        opts = tbl.timer_opts,
-        cb = function()
-            return tbl.cb(P.get_temps(data))
+        plugin = 'temperature-linux',
+        opts = {
+            period = (tbl.timer_opts or {}).period,
+            _thermal_path = data._thermal_path,
+            _hwmon_path = data._hwmon_path,
+        },
+        cb = function(t)
+            check_reload()
+            if t and data.filter_func then
+                local r = {}
+                for _, entry in ipairs(t) do
+                    if data.filter_func(entry.kind, entry.name) then
+                        r[#r + 1] = entry
+                    end
+                end
+                t = r
+            end
+            local r = tbl.cb(t)
+            check_reload()
+            return r
         end,
         event = tbl.event,
     }
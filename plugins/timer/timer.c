@@ -25,7 +25,7 @@
 #include <poll.h>
 #include <sys/types.h>
 
-#include "include/plugin_v1.h"
+#include "include/plugin_v2.h"
 #include "include/sayf_macros.h"
 
 #include "libmoonvisit/moonvisit.h"
@@ -146,6 +146,8 @@ static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
         }
         LS_TimeDelta TD = ls_pushed_timeout_fetch(&p->pushed_tmo, default_tmo);
 
+        funcs.call_idle(pd->userdata);
+
         struct pollfd pfds[2] = {
             {.fd = dev.fd,          .events = POLLIN},
             {.fd = p->self_pipe[0], .events = POLLIN},
@@ -175,7 +177,7 @@ error:
     ls_fifo_device_close(&dev);
 }
 
-LuastatusPluginIface luastatus_plugin_iface_v1 = {
+LuastatusPluginIface luastatus_plugin_iface_v2 = {
     .init = init,
     .register_funcs = register_funcs,
     .run = run,
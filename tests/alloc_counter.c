@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// A library to be loaded with LD_PRELOAD that counts calls to /malloc()/, /calloc()/ and
+// /realloc()/. The count can be obtained with the /alloc_counter_get()/ function, which is to be
+// looked up with /dlsym()/ on the handle returned by /dlopen(NULL, ...)/.
+
+#ifndef _GNU_SOURCE
+#   define _GNU_SOURCE
+#endif
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <dlfcn.h>
+
+static void *(*real_malloc)(size_t);
+static void *(*real_calloc)(size_t, size_t);
+static void *(*real_realloc)(void *, size_t);
+static void (*real_free)(void *);
+
+static uint64_t count;
+
+// /dlsym()/ may allocate memory itself; such requests are served from here.
+static char bootstrap_buf[16384] __attribute__((aligned(16)));
+static size_t bootstrap_used;
+
+static void *bootstrap_alloc(size_t n)
+{
+    n = (n + 15) / 16 * 16;
+    if (n > sizeof(bootstrap_buf) - bootstrap_used) {
+        return NULL;
+    }
+    void *r = bootstrap_buf + bootstrap_used;
+    bootstrap_used += n;
+    return r;
+}
+
+static inline bool is_bootstrap(void *p)
+{
+    char *c = p;
+    return c >= bootstrap_buf && c < bootstrap_buf + sizeof(bootstrap_buf);
+}
+
+// Returns false if called recursively (from within /dlsym()/).
+static bool resolve(void)
+{
+    static bool resolving = false;
+    if (real_free) {
+        return true;
+    }
+    if (resolving) {
+        return false;
+    }
+    resolving = true;
+    *(void **) &real_malloc = dlsym(RTLD_NEXT, "malloc");
+    *(void **) &real_calloc = dlsym(RTLD_NEXT, "calloc");
+    *(void **) &real_realloc = dlsym(RTLD_NEXT, "realloc");
+    *(void **) &real_free = dlsym(RTLD_NEXT, "free");
+    resolving = false;
+    return true;
+}
+
+static inline void bump(void)
+{
+    __atomic_add_fetch(&count, 1, __ATOMIC_RELAXED);
+}
+
+uint64_t alloc_counter_get(void)
+{
+    return __atomic_load_n(&count, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t n)
+{
+    if (!resolve()) {
+        return bootstrap_alloc(n);
+    }
+    bump();
+    return real_malloc(n);
+}
+
+void *calloc(size_t nelems, size_t elemsz)
+{
+    if (!resolve()) {
+        // /bootstrap_buf/ is zero-initialized and never reused.
+        if (elemsz && nelems > SIZE_MAX / elemsz) {
+            return NULL;
+        }
+        return bootstrap_alloc(nelems * elemsz);
+    }
+    bump();
+    return real_calloc(nelems, elemsz);
+}
+
+void *realloc(void *p, size_t n)
+{
+    if (!resolve()) {
+        return NULL;
+    }
+    bump();
+    if (is_bootstrap(p)) {
+        void *r = real_malloc(n);
+        if (r) {
+            size_t avail = bootstrap_buf + sizeof(bootstrap_buf) - (char *) p;
+            memcpy(r, p, n < avail ? n : avail);
+        }
+        return r;
+    }
+    return real_realloc(p, n);
+}
+
+void free(void *p)
+{
+    if (is_bootstrap(p) || !resolve()) {
+        return;
+    }
+    real_free(p);
+}
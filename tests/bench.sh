@@ -0,0 +1,60 @@
+#!/usr/bin/env bash
+
+# Runs luastatus with N mock widgets, each making M calls, and prints a line of space-separated
+# "key=value" pairs: the options, then the report of the mock barlib (see "bench_report" in
+# mock_barlib.c), e.g.:
+#     widgets=8 calls=100000 updates=800000 errors=0 elapsed_ns=... updates_per_sec=...
+#     e2e_p50_ns=... e2e_p99_ns=... begin_wait_p50_ns=... begin_wait_p99_ns=...
+#     end_to_set_p50_ns=... end_to_set_p99_ns=... allocs_per_update=...
+# (all on a single line), where:
+#   * "e2e" is the time from the plugin's call to "call_begin()" to the barlib's "set()";
+#   * "begin_wait" is the time spent in "call_begin()", i.e. waiting for the widget's lock;
+#   * "end_to_set" is the time from the plugin's call to "call_end()" to the barlib's "set()",
+#     i.e. running the (trivial) widget's callback and waiting for the barlib's lock;
+#   * "allocs_per_update" is the number of malloc/calloc/realloc calls per update.
+
+set -e
+
+opwd=$PWD
+cd -- "$(dirname "$(readlink "$0" || printf '%s\n' "$0")")"
+
+source ./utils.lib.bash
+
+if (( $# < 1 || $# > 3 )); then
+    echo >&2 "USAGE: $0 <build root> [<number of widgets> [<calls per widget>]]"
+    exit 2
+fi
+BUILD_DIR=$(resolve_relative "$1" "$opwd")
+NWIDGETS=${2:-8}
+NCALLS=${3:-100000}
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf -- "$tmp_dir"' EXIT
+
+widget_files=()
+for (( i = 0; i < NWIDGETS; ++i )); do
+    f=$tmp_dir/widget$i.lua
+    cat > "$f" <<__EOF__
+widget = {
+    plugin = '$BUILD_DIR/tests/plugin-mock.so',
+    opts = {
+        make_calls = $NCALLS,
+        bench = true,
+    },
+    cb = function(t)
+        return t
+    end,
+}
+__EOF__
+    widget_files+=("$f")
+done
+
+LD_PRELOAD=$BUILD_DIR/tests/alloc-counter.so \
+    "$BUILD_DIR"/luastatus/luastatus \
+    -e \
+    -l error \
+    -b "$BUILD_DIR"/tests/barlib-mock.so \
+    -B bench_report="$tmp_dir"/report \
+    "${widget_files[@]}"
+
+printf 'widgets=%d calls=%d %s\n' "$NWIDGETS" "$NCALLS" "$(< "$tmp_dir"/report)"
@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Measures how fast a barlib encodes and writes out updates: replays a corpus of widget outputs
+// through the barlib's /set()/ (which redraws the bar if the content has changed), with the output
+// going to a pipe that is drained (and counted) by a separate thread.
+//
+// Usage: bench-barlib BARLIB_SO CORPUS_LUA [ITERATIONS [BARLIB_OPTION...]]
+//
+// The corpus is a Lua file that returns a table of the form
+//     {nwidgets = <number of widgets>, updates = {{<widget index>, <data>}, ...}},
+// where widget indices are 0-based and /<data>/ is what the widgets' /cb/ functions would return.
+// The updates are replayed /ITERATIONS/ times.
+//
+// The barlib gets the "in_fd=<fd>" (where /fd/ is opened on "/dev/null") and "out_fd=<fd>" options
+// prepended to /BARLIB_OPTION/s.
+//
+// Prints a line of the form
+//     <updates> <total nanoseconds> <nanoseconds per update> <bytes written> <bytes per update>
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "include/barlib_data_v1.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+        perror("bench-barlib: clock_gettime");
+        abort();
+    }
+    return ((uint64_t) ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t parse_uint_cstr_or_die(const char *s)
+{
+    errno = 0;
+    char *endptr;
+    uint64_t r = strtoull(s, &endptr, 10);
+    if (errno || endptr == s || endptr[0] != '\0' || r == 0) {
+        fprintf(stderr, "bench-barlib: cannot parse as positive integer: '%s'.\n", s);
+        abort();
+    }
+    return r;
+}
+
+static void barlib_sayf(void *userdata, int level, const char *fmt, ...)
+{
+    (void) userdata;
+    if (level > LUASTATUS_LOG_WARN) {
+        return;
+    }
+    va_list vl;
+    va_start(vl, fmt);
+    fputs("bench-barlib: barlib: ", stderr);
+    vfprintf(stderr, fmt, vl);
+    fputc('\n', stderr);
+    va_end(vl);
+}
+
+// Only accessed by the drain thread until it is joined.
+static uint64_t nbytes;
+
+static void *drain_thread(void *arg)
+{
+    int fd = *(int *) arg;
+    char buf[65536];
+    for (;;) {
+        ssize_t r = read(fd, buf, sizeof(buf));
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("bench-barlib: read");
+            abort();
+        }
+        if (r == 0) {
+            break;
+        }
+        nbytes += r;
+    }
+    return NULL;
+}
+
+// Returns the widget index of the /k/-th update of the corpus table at position /t/ of /L/'s stack,
+// and pushes its data onto the stack.
+static size_t push_update(lua_State *L, int t, int k, size_t nwidgets)
+{
+    lua_rawgeti(L, t, k); // L: ? update
+    lua_rawgeti(L, -1, 1); // L: ? update idx
+    lua_rawgeti(L, -2, 2); // L: ? update idx data
+    lua_remove(L, -3); // L: ? idx data
+    lua_Number idx = lua_tonumber(L, -2);
+    lua_remove(L, -2); // L: ? data
+    if (!(idx >= 0 && idx < nwidgets)) {
+        fprintf(stderr, "bench-barlib: update #%d: invalid widget index.\n", k);
+        exit(1);
+    }
+    return idx;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr,
+                "USAGE: bench-barlib BARLIB_SO CORPUS_LUA [ITERATIONS [BARLIB_OPTION...]]\n");
+        return 2;
+    }
+    uint64_t niters = argc > 3 ? parse_uint_cstr_or_die(argv[3]) : 100;
+
+    void *dl = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!dl) {
+        fprintf(stderr, "bench-barlib: dlopen: %s\n", dlerror());
+        return 1;
+    }
+    LuastatusBarlibIface_v1 *iface = dlsym(dl, "luastatus_barlib_iface_v1");
+    if (!iface) {
+        fprintf(stderr, "bench-barlib: dlsym: %s\n", dlerror());
+        return 1;
+    }
+
+    lua_State *L = luaL_newstate();
+    if (!L) {
+        fprintf(stderr, "bench-barlib: luaL_newstate() failed\n");
+        return 1;
+    }
+    luaL_openlibs(L);
+    if (luaL_dofile(L, argv[2]) != 0) {
+        fprintf(stderr, "bench-barlib: cannot load corpus: %s\n", lua_tostring(L, -1));
+        return 1;
+    }
+    // L: corpus
+    if (!lua_istable(L, 1)) {
+        fprintf(stderr, "bench-barlib: corpus: expected table\n");
+        return 1;
+    }
+    lua_getfield(L, 1, "nwidgets"); // L: corpus nwidgets
+    lua_Number nwidgets_num = lua_tonumber(L, -1);
+    if (!(nwidgets_num >= 1)) {
+        fprintf(stderr, "bench-barlib: corpus: invalid 'nwidgets'\n");
+        return 1;
+    }
+    size_t nwidgets = nwidgets_num;
+    lua_pop(L, 1); // L: corpus
+    lua_getfield(L, 1, "updates"); // L: corpus updates
+    if (!lua_istable(L, 2)) {
+        fprintf(stderr, "bench-barlib: corpus: 'updates' is not a table\n");
+        return 1;
+    }
+#if LUA_VERSION_NUM <= 501
+    int nupdates = lua_objlen(L, 2);
+#else
+    int nupdates = lua_rawlen(L, 2);
+#endif
+    if (!nupdates) {
+        fprintf(stderr, "bench-barlib: corpus: 'updates' is empty\n");
+        return 1;
+    }
+
+    int in_fd = open("/dev/null", O_RDONLY);
+    if (in_fd < 0) {
+        perror("bench-barlib: /dev/null");
+        return 1;
+    }
+    int pipe_fds[2];
+    if (pipe(pipe_fds) < 0) {
+        perror("bench-barlib: pipe");
+        return 1;
+    }
+    pthread_t drainer;
+    if ((errno = pthread_create(&drainer, NULL, drain_thread, &pipe_fds[0]))) {
+        perror("bench-barlib: pthread_create");
+        return 1;
+    }
+
+    char in_fd_opt[32];
+    char out_fd_opt[32];
+    snprintf(in_fd_opt, sizeof(in_fd_opt), "in_fd=%d", in_fd);
+    snprintf(out_fd_opt, sizeof(out_fd_opt), "out_fd=%d", pipe_fds[1]);
+    const char **opts = calloc(argc, sizeof(const char *));
+    if (!opts) {
+        perror("bench-barlib: calloc");
+        return 1;
+    }
+    opts[0] = in_fd_opt;
+    opts[1] = out_fd_opt;
+    for (int i = 4; i < argc; ++i) {
+        opts[i - 2] = argv[i];
+    }
+
+    LuastatusBarlibData_v1 bd = {
+        .priv = NULL,
+        .userdata = NULL,
+        .sayf = barlib_sayf,
+        .map_get = NULL,
+    };
+    if (iface->init(&bd, opts, nwidgets) != LUASTATUS_OK) {
+        fprintf(stderr, "bench-barlib: barlib's init() failed\n");
+        return 1;
+    }
+
+    uint64_t start = now_ns();
+    for (uint64_t iter = 0; iter < niters; ++iter) {
+        for (int k = 1; k <= nupdates; ++k) {
+            size_t idx = push_update(L, 2, k, nwidgets); // L: corpus updates data
+            if (iface->set(&bd, L, idx) != LUASTATUS_OK) {
+                fprintf(stderr, "bench-barlib: barlib's set() failed on update #%d\n", k);
+                return 1;
+            }
+            lua_settop(L, 2); // L: corpus updates
+        }
+    }
+    // The barlib flushes its output on destroy.
+    iface->destroy(&bd);
+    uint64_t total = now_ns() - start;
+
+    // /destroy()/ has closed both /in_fd/ and the write end of the pipe.
+    if ((errno = pthread_join(drainer, NULL))) {
+        perror("bench-barlib: pthread_join");
+        return 1;
+    }
+
+    uint64_t n = niters * nupdates;
+    printf("%" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %.1f\n",
+           n, total, total / n, nbytes, (double) nbytes / n);
+
+    free(opts);
+    lua_close(L);
+    close(pipe_fds[0]);
+    return 0;
+}
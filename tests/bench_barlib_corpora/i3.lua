@@ -0,0 +1,51 @@
+-- A corpus for bench-barlib and the i3 barlib: a dozen widgets producing arrays of segments with
+-- Pango markup, colors and long Unicode window titles.
+
+local titles = {
+    'Mozilla Firefox — Википедия, свободная энциклопедия',
+    '東京都の天気 - 1時間ごとの天気予報 — Google Chrome',
+    '~/src/luastatus: vim plugins/multiplex/conq.c "Ünïcödé" \\ path',
+    '🎵 Ελληνικά τραγούδια — Spotify Premium',
+    'Terminal <root@host> & friends: tail -f /var/log/syslog',
+}
+
+local colors = {'#ff0000', '#00ff00', '#0000ff', '#ffffff', '#ffaa00'}
+
+local NWIDGETS = 12
+local NUPDATES = 600
+
+local function make_segments(widget, i)
+    local title = titles[(widget + i) % #titles + 1]
+    local color = colors[i % #colors + 1]
+    local segments = {
+        {
+            full_text = string.format(
+                '<span foreground="%s"><b>%d</b></span> %s',
+                color, i, title),
+            markup = 'pango',
+            instance = tostring(i % 3),
+            separator = false,
+            separator_block_width = 6,
+        },
+        {
+            full_text = string.format('%d%% «%s»', (i * 7) % 100, title:sub(1, 12)),
+            short_text = tostring(i),
+            color = colors[(i + widget) % #colors + 1],
+            min_width = 40,
+            align = 'right',
+            urgent = (i % 10 == 0),
+        },
+    }
+    if widget % 3 == 0 then
+        segments[#segments + 1] = {full_text = string.rep('▁▂▃▅▇', 4) .. ' ' .. i}
+    end
+    return segments
+end
+
+local updates = {}
+for i = 1, NUPDATES do
+    local widget = (i * 5) % NWIDGETS
+    updates[i] = {widget, make_segments(widget, i)}
+end
+
+return {nwidgets = NWIDGETS, updates = updates}
@@ -0,0 +1,37 @@
+-- A corpus for bench-barlib and the lemonbar barlib: a dozen widgets producing strings and arrays
+-- of strings with lemonbar markup and long Unicode window titles; some of them contain characters
+-- that need sanitizing.
+
+local titles = {
+    'Mozilla Firefox — Википедия, свободная энциклопедия',
+    '東京都の天気 - 1時間ごとの天気予報 — Google Chrome',
+    '~/src/luastatus: vim plugins/multiplex/conq.c "Ünïcödé" 100% done',
+    '🎵 Ελληνικά τραγούδια — Spotify Premium',
+    'Terminal: printf "a\\nb" %{F#ff0000}not markup%{F-}',
+}
+
+local colors = {'#ff0000', '#00ff00', '#0000ff', '#ffffff', '#ffaa00'}
+
+local NWIDGETS = 12
+local NUPDATES = 600
+
+local function make_data(widget, i)
+    local title = titles[(widget + i) % #titles + 1]
+    local color = colors[i % #colors + 1]
+    if widget % 2 == 0 then
+        return string.format('%%{F%s}%%{+u}%d%%{-u}%%{F-} %s', color, i, title)
+    end
+    return {
+        string.format('%%{B%s} %d%%%% %%{B-}', color, (i * 7) % 100),
+        title,
+        string.format('%%{A:click%d:}%s%%{A}', widget, string.rep('▁▂▃▅▇', 3)),
+    }
+end
+
+local updates = {}
+for i = 1, NUPDATES do
+    local widget = (i * 5) % NWIDGETS
+    updates[i] = {widget, make_data(widget, i)}
+end
+
+return {nwidgets = NWIDGETS, updates = updates}
@@ -0,0 +1,33 @@
+-- A corpus for bench-barlib and the stdout barlib: a dozen widgets producing strings and arrays of
+-- strings with long Unicode window titles; some of them contain newlines that need sanitizing.
+
+local titles = {
+    'Mozilla Firefox — Википедия, свободная энциклопедия',
+    '東京都の天気 - 1時間ごとの天気予報 — Google Chrome',
+    '~/src/luastatus: vim plugins/multiplex/conq.c "Ünïcödé"',
+    '🎵 Ελληνικά τραγούδια — Spotify Premium',
+    'Terminal: printf "a\nb\nc"',
+}
+
+local NWIDGETS = 12
+local NUPDATES = 600
+
+local function make_data(widget, i)
+    local title = titles[(widget + i) % #titles + 1]
+    if widget % 2 == 0 then
+        return string.format('[%d] %s', i, title)
+    end
+    return {
+        string.format('%d%%', (i * 7) % 100),
+        title,
+        string.rep('▁▂▃▅▇', 3),
+    }
+end
+
+local updates = {}
+for i = 1, NUPDATES do
+    local widget = (i * 5) % NWIDGETS
+    updates[i] = {widget, make_data(widget, i)}
+end
+
+return {nwidgets = NWIDGETS, updates = updates}
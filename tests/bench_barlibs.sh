@@ -0,0 +1,36 @@
+#!/usr/bin/env bash
+
+# For each barlib that has been built and has a corpus in bench_barlib_corpora/, runs bench-barlib
+# (see bench_barlib.c) with and without the "async_output" option, and prints lines of the form
+#     <barlib> <mode> <updates> <total ns> <ns per update> <bytes written> <bytes per update>
+
+set -e
+
+opwd=$PWD
+cd -- "$(dirname "$(readlink "$0" || printf '%s\n' "$0")")"
+
+source ./utils.lib.bash
+
+if (( $# < 1 || $# > 2 )); then
+    echo >&2 "USAGE: $0 <build root> [<iterations>]"
+    exit 2
+fi
+BUILD_DIR=$(resolve_relative "$1" "$opwd")
+NITERS=${2:-200}
+
+for corpus in bench_barlib_corpora/*.lua; do
+    name=$(basename -- "$corpus" .lua)
+    barlib=$BUILD_DIR/barlibs/$name/barlib-$name.so
+    if [[ ! -e $barlib ]]; then
+        echo >&2 "Skipping barlib '$name': not built."
+        continue
+    fi
+    for mode in sync async_output; do
+        opts=()
+        if [[ $mode == async_output ]]; then
+            opts+=(async_output)
+        fi
+        printf '%s %s %s\n' "$name" "$mode" \
+            "$("$BUILD_DIR"/tests/bench-barlib "$barlib" "$corpus" "$NITERS" "${opts[@]}")"
+    done
+done
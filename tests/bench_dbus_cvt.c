@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Measures the throughput of the dbus plugin's GVariant-to-Lua conversion (/cvt()/) on an
+// integer-heavy "a{sv}" dictionary (as returned by "GetAll" or sent with "PropertiesChanged"),
+// with integers converted to strings vs. to native Lua integers.
+//
+// Usage: bench-dbus-cvt [ITERATIONS [ENTRIES]]
+//
+// For each mode, prints a line of the form
+//     <mode> <iterations> <total nanoseconds> <nanoseconds per conversion>
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <lua.h>
+#include <lauxlib.h>
+#include <glib.h>
+
+#include "plugins/dbus/cvt.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+        perror("bench-dbus-cvt: clock_gettime");
+        abort();
+    }
+    return ((uint64_t) ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t parse_uint_cstr_or_die(const char *s)
+{
+    errno = 0;
+    char *endptr;
+    uint64_t r = strtoull(s, &endptr, 10);
+    if (errno || endptr == s || endptr[0] != '\0' || r == 0) {
+        fprintf(stderr, "bench-dbus-cvt: cannot parse as positive integer: '%s'.\n", s);
+        abort();
+    }
+    return r;
+}
+
+static GVariant *make_value(uint64_t i)
+{
+    switch (i % 8) {
+    case 0: return g_variant_new_byte(i);
+    case 1: return g_variant_new_int16(-(int16_t) (i % 30000));
+    case 2: return g_variant_new_uint16(i);
+    case 3: return g_variant_new_int32(-(int32_t) i * 1000);
+    case 4: return g_variant_new_uint32(i * 1000);
+    case 5: return g_variant_new_int64(-(int64_t) i * 1000000007);
+    // Does not fit into /lua_Integer/ half of the time.
+    case 6: return g_variant_new_uint64(i * UINT64_C(0x8000000000000001));
+    default: return g_variant_new_double(i / 7.0);
+    }
+}
+
+static GVariant *make_dict(uint64_t nentries)
+{
+    GVariantBuilder b;
+    g_variant_builder_init(&b, G_VARIANT_TYPE("a{sv}"));
+    for (uint64_t i = 0; i < nentries; ++i) {
+        char key[32];
+        snprintf(key, sizeof(key), "Property%" PRIu64, i);
+        g_variant_builder_add(&b, "{sv}", key, make_value(i));
+    }
+    return g_variant_ref_sink(g_variant_builder_end(&b));
+}
+
+static void bench(const char *mode, bool native_ints, GVariant *var, uint64_t niters)
+{
+    lua_State *L = luaL_newstate();
+    if (!L) {
+        fprintf(stderr, "bench-dbus-cvt: luaL_newstate() failed.\n");
+        abort();
+    }
+
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < niters; ++i) {
+        cvt(L, var, native_ints);
+        lua_pop(L, 1);
+    }
+    uint64_t total = now_ns() - start;
+
+    lua_close(L);
+
+    printf("%s %" PRIu64 " %" PRIu64 " %" PRIu64 "\n", mode, niters, total, total / niters);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t niters = 10000;
+    uint64_t nentries = 64;
+
+    if (argc > 3) {
+        fprintf(stderr, "USAGE: bench-dbus-cvt [ITERATIONS [ENTRIES]]\n");
+        return 2;
+    }
+    if (argc > 1) {
+        niters = parse_uint_cstr_or_die(argv[1]);
+    }
+    if (argc > 2) {
+        nentries = parse_uint_cstr_or_die(argv[2]);
+    }
+
+    GVariant *var = make_dict(nentries);
+
+    bench("strings", false, var, niters);
+    bench("native", true, var, niters);
+
+    g_variant_unref(var);
+    return 0;
+}
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2021-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Measures how fast the mpd plugin goes through idle wakeups against a local fake MPD server that
+// delays each of its replies by a given amount of time, thus simulating the round-trip time of a
+// remote server.
+//
+// Usage: bench-mpd PLUGIN_SO [UPDATES [DELAY_US [EXTRA_COMMAND...]]]
+//
+// The fake server understands both command lists and standalone commands. After /UPDATES/ updates
+// (not counting the first one), prints a line of the form
+//     <updates> <total nanoseconds> <nanoseconds per update> <round-trips per update>
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "include/plugin_data_v1.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+        perror("bench-mpd: clock_gettime");
+        abort();
+    }
+    return ((uint64_t) ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t parse_uint_cstr_or_die(const char *s)
+{
+    errno = 0;
+    char *endptr;
+    uint64_t r = strtoull(s, &endptr, 10);
+    if (errno || endptr == s || endptr[0] != '\0') {
+        fprintf(stderr, "bench-mpd: cannot parse as integer: '%s'.\n", s);
+        abort();
+    }
+    return r;
+}
+
+static char socket_dir[] = "/tmp/bench-mpd-XXXXXX";
+static struct sockaddr_un socket_addr = {.sun_family = AF_UNIX};
+
+static uint64_t delay_us;
+static uint64_t nupdates;
+
+// Only accessed by the fake server thread.
+static uint64_t nroundtrips;
+
+// Only accessed by the plugin thread.
+static uint64_t ncalls;
+static uint64_t start_ns;
+static uint64_t start_roundtrips;
+
+static pthread_mutex_t roundtrips_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static void delay_reply(void)
+{
+    struct timespec ts = {
+        .tv_sec = delay_us / 1000000,
+        .tv_nsec = (delay_us % 1000000) * 1000,
+    };
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+    }
+    pthread_mutex_lock(&roundtrips_mtx);
+    ++nroundtrips;
+    pthread_mutex_unlock(&roundtrips_mtx);
+}
+
+static uint64_t get_roundtrips(void)
+{
+    pthread_mutex_lock(&roundtrips_mtx);
+    uint64_t r = nroundtrips;
+    pthread_mutex_unlock(&roundtrips_mtx);
+    return r;
+}
+
+static void write_reply_body(FILE *f, const char *cmd)
+{
+    if (strcmp(cmd, "currentsong") == 0) {
+        fputs(
+            "file: music/artist/album/01 - track.flac\n"
+            "Artist: Artist\n"
+            "Album: Album\n"
+            "Title: Track\n"
+            "Track: 1\n"
+            "Time: 215\n"
+            "Pos: 0\n"
+            "Id: 1\n", f);
+    } else if (strcmp(cmd, "status") == 0) {
+        fputs(
+            "volume: 100\n"
+            "repeat: 0\n"
+            "random: 0\n"
+            "single: 0\n"
+            "consume: 0\n"
+            "playlist: 2\n"
+            "playlistlength: 10\n"
+            "state: play\n"
+            "song: 0\n"
+            "songid: 1\n"
+            "elapsed: 12.345\n"
+            "bitrate: 1024\n"
+            "audio: 44100:16:2\n", f);
+    } else {
+        fprintf(f, "command: %s\n", cmd);
+    }
+}
+
+static void *server_thread(void *arg)
+{
+    int lfd = *(int *) arg;
+    int fd = accept(lfd, NULL, NULL);
+    if (fd < 0) {
+        perror("bench-mpd: accept");
+        abort();
+    }
+    // The listening socket is not needed anymore.
+    close(lfd);
+    unlink(socket_addr.sun_path);
+    rmdir(socket_dir);
+
+    FILE *f = fdopen(fd, "r+");
+    if (!f) {
+        perror("bench-mpd: fdopen");
+        abort();
+    }
+
+    fputs("OK MPD 0.23.0\n", f);
+    fflush(f);
+
+    char cmds[16][128];
+    size_t ncmds = 0;
+    bool in_list = false;
+
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+
+        if (strcmp(line, "command_list_ok_begin") == 0) {
+            in_list = true;
+            ncmds = 0;
+
+        } else if (strcmp(line, "command_list_end") == 0) {
+            delay_reply();
+            for (size_t i = 0; i < ncmds; ++i) {
+                write_reply_body(f, cmds[i]);
+                fputs("list_OK\n", f);
+            }
+            fputs("OK\n", f);
+            in_list = false;
+
+        } else if (in_list) {
+            if (ncmds == 16) {
+                fprintf(stderr, "bench-mpd: too many commands in a command list\n");
+                abort();
+            }
+            snprintf(cmds[ncmds++], sizeof(cmds[0]), "%s", line);
+
+        } else if (strncmp(line, "idle", 4) == 0) {
+            delay_reply();
+            fputs("changed: player\nOK\n", f);
+
+        } else {
+            delay_reply();
+            write_reply_body(f, line);
+            fputs("OK\n", f);
+        }
+        fflush(f);
+    }
+
+    fprintf(stderr, "bench-mpd: the plugin has closed the connection\n");
+    exit(1);
+}
+
+static void plugin_sayf(void *userdata, int level, const char *fmt, ...)
+{
+    (void) userdata;
+    if (level > LUASTATUS_LOG_WARN) {
+        return;
+    }
+    va_list vl;
+    va_start(vl, fmt);
+    fputs("bench-mpd: plugin: ", stderr);
+    vfprintf(stderr, fmt, vl);
+    fputc('\n', stderr);
+    va_end(vl);
+}
+
+static lua_State *plugin_L;
+
+static lua_State *call_begin(void *userdata)
+{
+    (void) userdata;
+    return plugin_L;
+}
+
+static void call_end(void *userdata)
+{
+    (void) userdata;
+
+    lua_getfield(plugin_L, -1, "what"); // L: table what
+    const char *what = lua_tostring(plugin_L, -1);
+    if (what && strcmp(what, "error") == 0) {
+        fprintf(stderr, "bench-mpd: the plugin has reported an error\n");
+        exit(1);
+    }
+    bool is_update = what && strcmp(what, "update") == 0;
+    lua_pop(plugin_L, 2); // L: -
+
+    if (!is_update) {
+        return;
+    }
+    if (ncalls++ == 0) {
+        start_ns = now_ns();
+        start_roundtrips = get_roundtrips();
+        return;
+    }
+    if (ncalls == nupdates + 1) {
+        uint64_t total = now_ns() - start_ns;
+        uint64_t roundtrips = get_roundtrips() - start_roundtrips;
+        printf("%" PRIu64 " %" PRIu64 " %" PRIu64 " %.2f\n",
+               nupdates, total, total / nupdates, (double) roundtrips / nupdates);
+        fflush(stdout);
+        exit(0);
+    }
+}
+
+static void call_cancel(void *userdata)
+{
+    (void) userdata;
+    lua_settop(plugin_L, 0);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "USAGE: bench-mpd PLUGIN_SO [UPDATES [DELAY_US [EXTRA_COMMAND...]]]\n");
+        return 2;
+    }
+    nupdates = argc > 2 ? parse_uint_cstr_or_die(argv[2]) : 1000;
+    delay_us = argc > 3 ? parse_uint_cstr_or_die(argv[3]) : 0;
+    if (!nupdates) {
+        fprintf(stderr, "bench-mpd: UPDATES must be positive.\n");
+        return 2;
+    }
+
+    void *dl = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!dl) {
+        fprintf(stderr, "bench-mpd: dlopen: %s\n", dlerror());
+        return 1;
+    }
+    LuastatusPluginIface_v1 *iface = dlsym(dl, "luastatus_plugin_iface_v1");
+    if (!iface) {
+        fprintf(stderr, "bench-mpd: dlsym: %s\n", dlerror());
+        return 1;
+    }
+
+    if (!mkdtemp(socket_dir)) {
+        perror("bench-mpd: mkdtemp");
+        return 1;
+    }
+    snprintf(socket_addr.sun_path, sizeof(socket_addr.sun_path), "%s/socket", socket_dir);
+
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0) {
+        perror("bench-mpd: socket");
+        return 1;
+    }
+    if (bind(lfd, (struct sockaddr *) &socket_addr, sizeof(socket_addr)) < 0 ||
+        listen(lfd, 1) < 0)
+    {
+        perror("bench-mpd: bind/listen");
+        return 1;
+    }
+    pthread_t server;
+    if ((errno = pthread_create(&server, NULL, server_thread, &lfd))) {
+        perror("bench-mpd: pthread_create");
+        return 1;
+    }
+
+    plugin_L = luaL_newstate();
+    if (!plugin_L) {
+        fprintf(stderr, "bench-mpd: luaL_newstate() failed\n");
+        return 1;
+    }
+    lua_newtable(plugin_L); // L: opts
+    lua_pushstring(plugin_L, socket_addr.sun_path); // L: opts path
+    lua_setfield(plugin_L, -2, "hostname"); // L: opts
+    lua_pushnumber(plugin_L, -1); // L: opts -1
+    lua_setfield(plugin_L, -2, "retry_in"); // L: opts
+    if (argc > 4) {
+        lua_newtable(plugin_L); // L: opts extra
+        for (int i = 4; i < argc; ++i) {
+            lua_pushstring(plugin_L, argv[i]); // L: opts extra cmd
+            lua_rawseti(plugin_L, -2, i - 3); // L: opts extra
+        }
+        lua_setfield(plugin_L, -2, "extra_commands"); // L: opts
+    }
+
+    LuastatusPluginData_v1 pd = {
+        .priv = NULL,
+        .userdata = NULL,
+        .sayf = plugin_sayf,
+        .map_get = NULL,
+    };
+    if (iface->init(&pd, plugin_L) != LUASTATUS_OK) {
+        fprintf(stderr, "bench-mpd: plugin's init() failed\n");
+        return 1;
+    }
+    lua_settop(plugin_L, 0);
+
+    LuastatusPluginRunFuncs_v1 funcs = {
+        .call_begin = call_begin,
+        .call_end = call_end,
+        .call_cancel = call_cancel,
+    };
+    iface->run(&pd, funcs);
+
+    fprintf(stderr, "bench-mpd: plugin's run() has returned\n");
+    return 1;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021-2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Measures the latency of spawning a child process with librunshell: /sh -c/ vs. the argv mode
+// vs. /runshell_spawn_argv()/ + /runshell_wait()/.
+//
+// Usage: bench-runshell [ITERATIONS [PROGRAM]]
+//
+// For each mode, prints a line of the form
+//     <mode> <iterations> <total nanoseconds> <nanoseconds per call>
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "librunshell/runshell.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+        perror("bench-runshell: clock_gettime");
+        abort();
+    }
+    return ((uint64_t) ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t parse_uint_cstr_or_die(const char *s)
+{
+    errno = 0;
+    char *endptr;
+    uint64_t r = strtoull(s, &endptr, 10);
+    if (errno || endptr == s || endptr[0] != '\0' || r == 0) {
+        fprintf(stderr, "bench-runshell: cannot parse as positive integer: '%s'.\n", s);
+        abort();
+    }
+    return r;
+}
+
+static void check_status(const char *mode, int status)
+{
+    if (status < 0) {
+        fprintf(stderr, "bench-runshell: %s: %s\n", mode, strerror(errno));
+        exit(1);
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "bench-runshell: %s: child process has failed\n", mode);
+        exit(1);
+    }
+}
+
+static void report(const char *mode, uint64_t n, uint64_t start_ns)
+{
+    uint64_t total = now_ns() - start_ns;
+    printf("%s %" PRIu64 " %" PRIu64 " %" PRIu64 "\n", mode, n, total, total / n);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 3) {
+        fprintf(stderr, "USAGE: bench-runshell [ITERATIONS [PROGRAM]]\n");
+        return 2;
+    }
+    uint64_t n = argc > 1 ? parse_uint_cstr_or_die(argv[1]) : 1000;
+    char *prog = argc > 2 ? argv[2] : "true";
+
+    char *child_argv[] = {prog, NULL};
+    uint64_t start;
+
+    start = now_ns();
+    for (uint64_t i = 0; i < n; ++i) {
+        check_status("sh", runshell(prog));
+    }
+    report("sh", n, start);
+
+    start = now_ns();
+    for (uint64_t i = 0; i < n; ++i) {
+        check_status("argv", runshell_argv(child_argv));
+    }
+    report("argv", n, start);
+
+    start = now_ns();
+    for (uint64_t i = 0; i < n; ++i) {
+        pid_t pid = runshell_spawn_argv(child_argv);
+        if (pid < 0) {
+            check_status("spawn", -1);
+        }
+        check_status("spawn", runshell_wait(pid));
+    }
+    report("spawn", n, start);
+
+    return 0;
+}
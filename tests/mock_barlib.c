@@ -18,8 +18,10 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <dlfcn.h>
 
 #include <lua.h>
 
@@ -31,17 +33,151 @@
 #include "libls/ls_parse_int.h"
 
 #include "minstd.h"
+#include "mock_bench.h"
+
+typedef struct {
+    uint64_t *data;
+    size_t size;
+    size_t capacity;
+} Samples;
+
+// State of the "bench_report" mode.
+typedef struct {
+    // Path to write the report to; /NULL/ if not in the "bench_report" mode.
+    char *report_path;
+
+    // /alloc_counter_get()/ from alloc_counter.c if it is preloaded; /NULL/ otherwise.
+    uint64_t (*alloc_counter_get)(void);
+
+    // From /begin_ns/ to the call to /set()/.
+    Samples e2e;
+    // From /begin_ns/ to /begun_ns/.
+    Samples begin_wait;
+    // From /end_ns/ to the call to /set()/.
+    Samples end_to_set;
+
+    uint64_t first_begin_ns;
+    uint64_t last_set_ns;
+
+    uint64_t first_allocs;
+    uint64_t last_allocs;
+    // Number of allocations made by ourselves between the first and the last calls to /set()/.
+    uint64_t own_allocs;
+
+    uint64_t nerrors;
+} Bench;
 
 typedef struct {
     size_t nwidgets;
     unsigned char *widgets;
     int nevents;
     int64_t prng_seed;
+    Bench bench;
 } Priv;
 
+static void samples_push(Bench *b, Samples *s, uint64_t x)
+{
+    if (s->size == s->capacity) {
+        s->data = LS_M_X2REALLOC(s->data, &s->capacity);
+        ++b->own_allocs;
+    }
+    s->data[s->size++] = x;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+// Sorts /s/ and returns its /pct/-th percentile; /s/ must not be empty.
+static uint64_t samples_percentile(Samples *s, unsigned pct)
+{
+    qsort(s->data, s->size, sizeof(uint64_t), compare_u64);
+    size_t i = (s->size - 1) * pct / 100;
+    return s->data[i];
+}
+
+static void bench_record(Bench *b, const MockBenchStamp *stamp)
+{
+    uint64_t now = mock_bench_now_ns();
+    uint64_t allocs = b->alloc_counter_get ? b->alloc_counter_get() : 0;
+
+    if (!b->e2e.size) {
+        b->first_begin_ns = stamp->begin_ns;
+        b->first_allocs = allocs;
+        b->own_allocs = 0;
+    } else if (stamp->begin_ns < b->first_begin_ns) {
+        b->first_begin_ns = stamp->begin_ns;
+    }
+    b->last_set_ns = now;
+    b->last_allocs = allocs;
+
+    samples_push(b, &b->e2e, now - stamp->begin_ns);
+    samples_push(b, &b->begin_wait, stamp->begun_ns - stamp->begin_ns);
+    samples_push(b, &b->end_to_set, now - stamp->end_ns);
+}
+
+// Writes a single line of space-separated "key=value" pairs.
+static void bench_write_report(LuastatusBarlibData *bd, Bench *b)
+{
+    FILE *f = fopen(b->report_path, "w");
+    if (!f) {
+        LS_ERRF(bd, "cannot open '%s' for writing", b->report_path);
+        return;
+    }
+
+    size_t n = b->e2e.size;
+    fprintf(f, "updates=%zu errors=%" PRIu64, n, b->nerrors);
+    if (n) {
+        uint64_t elapsed = b->last_set_ns - b->first_begin_ns;
+        fprintf(f, " elapsed_ns=%" PRIu64, elapsed);
+        fprintf(f, " updates_per_sec=%.1f", elapsed ? n / (elapsed / 1e9) : 0.0);
+
+        fprintf(f, " e2e_p50_ns=%" PRIu64, samples_percentile(&b->e2e, 50));
+        fprintf(f, " e2e_p99_ns=%" PRIu64, samples_percentile(&b->e2e, 99));
+        fprintf(f, " begin_wait_p50_ns=%" PRIu64, samples_percentile(&b->begin_wait, 50));
+        fprintf(f, " begin_wait_p99_ns=%" PRIu64, samples_percentile(&b->begin_wait, 99));
+        fprintf(f, " end_to_set_p50_ns=%" PRIu64, samples_percentile(&b->end_to_set, 50));
+        fprintf(f, " end_to_set_p99_ns=%" PRIu64, samples_percentile(&b->end_to_set, 99));
+
+        if (b->alloc_counter_get && n > 1) {
+            uint64_t allocs = b->last_allocs - b->first_allocs - b->own_allocs;
+            fprintf(f, " allocs_per_update=%.2f", (double) allocs / (n - 1));
+        } else {
+            fprintf(f, " allocs_per_update=-1");
+        }
+    }
+    fputc('\n', f);
+
+    if (fclose(f) != 0) {
+        LS_ERRF(bd, "cannot write to '%s'", b->report_path);
+    }
+}
+
+static uint64_t (*lookup_alloc_counter_get(void))(void)
+{
+    uint64_t (*r)(void) = NULL;
+    void *handle = dlopen(NULL, RTLD_NOW);
+    if (handle) {
+        *(void **) &r = dlsym(handle, "alloc_counter_get");
+        dlclose(handle);
+    }
+    return r;
+}
+
 static void destroy(LuastatusBarlibData *bd)
 {
     Priv *p = bd->priv;
+    Bench *b = &p->bench;
+    if (b->report_path) {
+        bench_write_report(bd, b);
+    }
+    free(b->report_path);
+    free(b->e2e.data);
+    free(b->begin_wait.data);
+    free(b->end_to_set.data);
     free(p->widgets);
     free(p);
 }
@@ -54,6 +190,7 @@ static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidget
         .widgets = LS_XNEW0(unsigned char, nwidgets),
         .nevents = 0,
         .prng_seed = -1,
+        .bench = {.report_path = NULL},
     };
 
     if (nwidgets > (size_t) INT32_MAX) {
@@ -75,6 +212,11 @@ static int init(LuastatusBarlibData *bd, const char *const *opts, size_t nwidget
                 goto error;
             }
 
+        } else if ((v = ls_strfollow(*s, "bench_report="))) {
+            free(p->bench.report_path);
+            p->bench.report_path = ls_xstrdup(v);
+            p->bench.alloc_counter_get = lookup_alloc_counter_get();
+
         } else {
             LS_FATALF(bd, "unknown option: '%s'", *s);
             goto error;
@@ -90,6 +232,10 @@ error:
 static int set(LuastatusBarlibData *bd, lua_State *L, size_t widget_idx)
 {
     Priv *p = bd->priv;
+    if (p->bench.report_path && lua_islightuserdata(L, -1)) {
+        bench_record(&p->bench, lua_touserdata(L, -1));
+        return LUASTATUS_OK;
+    }
     if (!lua_isnil(L, -1)) {
         LS_ERRF(bd, "got non-nil data");
         return LUASTATUS_NONFATAL_ERR;
@@ -102,6 +248,7 @@ static int set_error(LuastatusBarlibData *bd, size_t widget_idx)
 {
     Priv *p = bd->priv;
     --p->widgets[widget_idx];
+    ++p->bench.nerrors;
     return LUASTATUS_OK;
 }
 
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026  luastatus developers
+ *
+ * This file is part of luastatus.
+ *
+ * luastatus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * luastatus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with luastatus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include "libls/ls_compdep.h"
+#include "libls/ls_panic.h"
+
+// Time stamps of a single call made by the mock plugin in the "bench" mode.
+//
+// The plugin passes a pointer to it (as a light userdata) to the widget's callback, which is
+// expected to return it as is, so that the mock barlib (in the "bench_report" mode) gets it in
+// its /set()/.
+typedef struct {
+    // Right before /call_begin()/.
+    uint64_t begin_ns;
+
+    // Right after /call_begin()/ has returned (so /begun_ns - begin_ns/ is how long it took to
+    // lock the widget's Lua interpreter instance).
+    uint64_t begun_ns;
+
+    // Right before /call_end()/.
+    uint64_t end_ns;
+} MockBenchStamp;
+
+LS_INHEADER uint64_t mock_bench_now_ns(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+        LS_PANIC("clock_gettime() failed");
+    }
+    return ((uint64_t) ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
@@ -22,15 +22,19 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#include "include/plugin_v1.h"
+#include "include/plugin_v2.h"
 #include "include/sayf_macros.h"
 
 #include "libmoonvisit/moonvisit.h"
 
 #include "libls/ls_alloc_utils.h"
 
+#include "mock_bench.h"
+
 typedef struct {
     uint64_t ncalls;
+    bool bench;
+    MockBenchStamp stamp;
 } Priv;
 
 static void destroy(LuastatusPluginData *pd)
@@ -44,6 +48,7 @@ static int init(LuastatusPluginData *pd, lua_State *L)
     Priv *p = pd->priv = LS_XNEW(Priv, 1);
     *p = (Priv) {
         .ncalls = 0,
+        .bench = false,
     };
 
     char errbuf[256];
@@ -54,6 +59,11 @@ static int init(LuastatusPluginData *pd, lua_State *L)
         goto mverror;
     }
 
+    // Parse bench
+    if (moon_visit_bool(&mv, -1, "bench", &p->bench, true) < 0) {
+        goto mverror;
+    }
+
     return LUASTATUS_OK;
 
 mverror:
@@ -66,14 +76,26 @@ mverror:
 static void run(LuastatusPluginData *pd, LuastatusPluginRunFuncs funcs)
 {
     Priv *p = pd->priv;
+    if (p->bench) {
+        for (uint64_t i = 0; i < p->ncalls; ++i) {
+            p->stamp.begin_ns = mock_bench_now_ns();
+            lua_State *L = funcs.call_begin(pd->userdata);
+            p->stamp.begun_ns = mock_bench_now_ns();
+            lua_pushlightuserdata(L, &p->stamp);
+            p->stamp.end_ns = mock_bench_now_ns();
+            funcs.call_end(pd->userdata);
+        }
+        return;
+    }
     for (uint64_t i = 0; i < p->ncalls; ++i) {
         lua_State *L = funcs.call_begin(pd->userdata);
         lua_pushnil(L);
         funcs.call_end(pd->userdata);
+        funcs.call_idle(pd->userdata);
     }
 }
 
-LuastatusPluginIface luastatus_plugin_iface_v1 = {
+LuastatusPluginIface luastatus_plugin_iface_v2 = {
     .init = init,
     .run = run,
     .destroy = destroy,
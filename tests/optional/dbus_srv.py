@@ -50,6 +50,7 @@ class MyServerObject(dbus.service.Object):
     def __init__(self, bus, object_path):
         dbus.service.Object.__init__(self, bus, object_path, MY_BUS_NAME)
         self.prop = ''
+        self.prop_ncalls = {'Get': 0, 'GetAll': 0}
 
     @dbus.service.method(MY_INTERFACE, in_signature='s', out_signature='s')
     def Upcase(self, msg):
@@ -132,6 +133,7 @@ class MyServerObject(dbus.service.Object):
     def Get(self, _, prop_name):
         prop_name = str(prop_name)
         log(f'Called Get (property): prop_name="{prop_name}"')
+        self.prop_ncalls['Get'] += 1
         if prop_name != 'MyProperty':
             raise ValueError('wrong property name')
         return self.prop
@@ -139,6 +141,7 @@ class MyServerObject(dbus.service.Object):
     @dbus.service.method(PROP_INTERFACE, in_signature='s', out_signature='a{sv}')
     def GetAll(self, _):
         log('Called GetAll (properties)')
+        self.prop_ncalls['GetAll'] += 1
         return {
             'MyProperty': self.prop,
         }
@@ -151,6 +154,23 @@ class MyServerObject(dbus.service.Object):
         if prop_name != 'MyProperty':
             raise ValueError('wrong property name')
         self.prop = value
+        self.PropertiesChanged(MY_INTERFACE, {'MyProperty': value}, [])
+
+    @dbus.service.signal(PROP_INTERFACE, signature='sa{sv}as')
+    def PropertiesChanged(self, iface, changed, invalidated):
+        log(f'Emitting PropertiesChanged: changed={changed}, invalidated={invalidated}')
+
+    @dbus.service.method(MY_INTERFACE, in_signature='s', out_signature='')
+    def SetMyPropertyAndInvalidate(self, value):
+        value = str(value)
+        log(f'Called SetMyPropertyAndInvalidate: value="{value}"')
+        self.prop = value
+        self.PropertiesChanged(MY_INTERFACE, {}, ['MyProperty'])
+
+    @dbus.service.method(MY_INTERFACE, in_signature='', out_signature='uu')
+    def GetPropCallCounts(self):
+        log('Called GetPropCallCounts')
+        return (self.prop_ncalls['Get'], self.prop_ncalls['GetAll'])
 
 
 def main():
@@ -63,7 +63,7 @@ widget = {
     end,
 }
 __EOF__
-    x_spawn_luastatus
+    x_spawn_luastatus "${@:3}"
     exec {pfd}<"$main_fifo_file"
     pt_expect_line '{"version":1,"click_events":true,"stop_signal":0,"cont_signal":0}' <&${PT_SPAWNED_THINGS_FDS_0[luastatus]}
     pt_expect_line '[' <&${PT_SPAWNED_THINGS_FDS_0[luastatus]}
@@ -81,3 +81,7 @@ x_testcase_input '{"name":"1","what":"invalid widget index"},
 {"name":"0","finally ok":"yes"}' '{["finally ok"]="yes",["name"]="0"}'
 x_testcase_input '{"name":"0","foo":[1,2,3,{"k":"v"},4]}' '{["foo"]={1,2,3,{["k"]="v"},4},["name"]="0"}'
 x_testcase_input '{"name":"0","foo":null,"bar":true,"baz":false}' '{["bar"]=true,["baz"]=false,["name"]="0"}'
+x_testcase_input '{"name":"0","button":4,"x":10,"y":20,"modifiers":["Shift"],"instance":"a"}' '{["button"]=4,["modifiers"]={"Shift"},["x"]=10}' -B click_fields=button,x -B click_fields=modifiers
+x_testcase_input '{"name":"1","button":1},
+{"extra":{"k":[1,{"n":"v"}]},"button":5,"name":"0","foo":"bar"}' '{["button"]=5}' -B click_fields=button
+x_testcase_input '{"name":"0","button":4}' '{}' -B click_fields=
@@ -0,0 +1,30 @@
+pt_testcase_begin
+pt_write_widget_file <<__EOF__
+local n = 0
+widget = {
+    plugin = '$PT_BUILD_DIR/tests/plugin-mock.so',
+    opts = {make_calls = 1000},
+    cb = function()
+        n = n + 1
+        return tostring(n)
+    end,
+}
+__EOF__
+x_spawn_luastatus -B async_output
+# Intermediate lines may be dropped, but the ones that are written must be complete and come in
+# order; and the last one must always be written.
+x_prev=0
+while true; do
+    pt_read_line <&${PT_SPAWNED_THINGS_FDS_0[luastatus]}
+    if [[ $PT_LINE == '%{B#f00}%{F#fff}(Error)%{B-}%{F-}' ]]; then
+        break
+    fi
+    if ! [[ $PT_LINE =~ ^[0-9]+$ ]]; then
+        pt_fail "Unexpected line: '$PT_LINE'."
+    fi
+    if (( PT_LINE <= x_prev )); then
+        pt_fail "Lines come out of order: '$PT_LINE' after '$x_prev'."
+    fi
+    x_prev=$PT_LINE
+done
+pt_testcase_end
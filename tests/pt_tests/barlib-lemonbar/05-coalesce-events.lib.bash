@@ -0,0 +1,38 @@
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+x_unblock_fifo_file=./tmp-fifo-unblock
+pt_add_fifo "$x_unblock_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$PT_BUILD_DIR/tests/plugin-mock.so',
+    opts = {make_calls = 0},
+    cb = function()
+    end,
+    coalesce_events = true,
+    event = function(t, count)
+        f:write('event ' .. t .. ' ' .. count .. '\n')
+        if t == 'first' then
+            -- Block until all the other events are read by the event watcher.
+            local g = assert(io.open('$x_unblock_fifo_file', 'r'))
+            g:read('*l')
+            g:close()
+        end
+    end,
+}
+__EOF__
+x_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+printf '%s\n' 0_first >&${PT_SPAWNED_THINGS_FDS_1[luastatus]}
+pt_expect_line "event first 1" <&$pfd
+printf '%s\n' 0_up 0_up 0_up 0_down 0_down 0_up >&${PT_SPAWNED_THINGS_FDS_1[luastatus]}
+sleep 1
+exec {x_ufd}>"$x_unblock_fifo_file"
+printf '%s\n' go >&$x_ufd
+pt_close_fd "$x_ufd"
+pt_expect_line "event up 3" <&$pfd
+pt_expect_line "event down 2" <&$pfd
+pt_expect_line "event up 1" <&$pfd
+pt_close_fd "$pfd"
+pt_testcase_end
@@ -0,0 +1,90 @@
+x_testcase_event_pool() {
+    local event_beg=$1 event_end=$2
+
+    pt_testcase_begin
+    pt_add_fifo "$main_fifo_file"
+    local x_unblock_fifo_file=./tmp-fifo-unblock
+    pt_add_fifo "$x_unblock_fifo_file"
+    local i
+    for i in 0 1; do
+        pt_write_widget_file <<__EOF__
+-- Keep the FIFO open so that the reader never sees EOF between the writes below.
+keep_open = assert(io.open('$main_fifo_file', 'w'))
+widget = {
+    plugin = '$PT_BUILD_DIR/tests/plugin-mock.so',
+    opts = {make_calls = 0},
+    cb = function()
+    end,
+    event = $event_beg
+        local t = ...
+        local f = assert(io.open('$main_fifo_file', 'a'))
+        f:write('event $i ' .. t .. '\\n')
+        f:close()
+        if t == 'block' then
+            -- Block until the test unblocks us; the other widget's events must still be processed.
+            local g = assert(io.open('$x_unblock_fifo_file', 'r'))
+            g:read('*l')
+            g:close()
+        end
+    $event_end,
+}
+__EOF__
+    done
+    x_spawn_luastatus -j 2
+    exec {pfd}<"$main_fifo_file"
+    printf '%s\n' 0_block 0_after 1_foo 1_bar >&${PT_SPAWNED_THINGS_FDS_1[luastatus]}
+    pt_expect_line "event 0 block" <&$pfd
+    pt_expect_line "event 1 foo" <&$pfd
+    pt_expect_line "event 1 bar" <&$pfd
+    exec {x_ufd}>"$x_unblock_fifo_file"
+    printf '%s\n' go >&$x_ufd
+    pt_close_fd "$x_ufd"
+    pt_expect_line "event 0 after" <&$pfd
+    pt_close_fd "$pfd"
+    pt_testcase_end
+}
+
+x_testcase_event_pool 'function(...)' 'end'
+x_testcase_event_pool '[[' ']]'
+
+# Events are never dropped (unless coalesced): when a widget's queue is full, the event watcher
+# waits.
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+x_unblock_fifo_file=./tmp-fifo-unblock
+pt_add_fifo "$x_unblock_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$PT_BUILD_DIR/tests/plugin-mock.so',
+    opts = {make_calls = 0},
+    cb = function()
+    end,
+    event = function(t)
+        if t == 'block' then
+            local g = assert(io.open('$x_unblock_fifo_file', 'r'))
+            g:read('*l')
+            g:close()
+        end
+        f:write('event ' .. t .. '\n')
+    end,
+}
+__EOF__
+x_spawn_luastatus -j 1
+exec {pfd}<"$main_fifo_file"
+{
+    printf '%s\n' 0_block
+    for (( x_i = 0; x_i < 200; ++x_i )); do
+        printf '%s\n' "0_$x_i"
+    done
+} >&${PT_SPAWNED_THINGS_FDS_1[luastatus]}
+exec {x_ufd}>"$x_unblock_fifo_file"
+printf '%s\n' go >&$x_ufd
+pt_close_fd "$x_ufd"
+pt_expect_line "event block" <&$pfd
+for (( x_i = 0; x_i < 200; ++x_i )); do
+    pt_expect_line "event $x_i" <&$pfd
+done
+pt_close_fd "$pfd"
+pt_testcase_end
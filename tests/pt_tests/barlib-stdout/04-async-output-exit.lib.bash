@@ -0,0 +1,31 @@
+# With /-e/, luastatus exits right after the last frame (the error one set when the plugin's
+# /run()/ returns) is submitted; the frame writer must still write it. The frames are larger than a
+# pipe buffer so that the writer thread is likely to be blocked in /write()/ at that moment.
+x_testcase_async_output_last_frame() {
+    pt_testcase_begin
+    pt_write_widget_file <<__EOF__
+widget = {
+    plugin = '$PT_BUILD_DIR/tests/plugin-mock.so',
+    opts = {make_calls = 10},
+    cb = function()
+        return ('x'):rep(256 * 1024)
+    end,
+}
+__EOF__
+    x_spawn_luastatus -e -B async_output
+    while true; do
+        pt_read_line <&${PT_SPAWNED_THINGS_FDS_0[luastatus]}
+        if [[ $PT_LINE == '(Error)' ]]; then
+            break
+        fi
+        if (( ${#PT_LINE} != 256 * 1024 )); then
+            pt_fail "Unexpected line of length ${#PT_LINE}."
+        fi
+    done
+    pt_wait_luastatus || pt_fail "luastatus exited with code $?"
+    pt_testcase_end
+}
+
+for (( x_i = 0; x_i < 10; ++x_i )); do
+    x_testcase_async_output_last_frame
+done
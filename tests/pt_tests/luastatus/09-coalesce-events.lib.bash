@@ -0,0 +1,47 @@
+x_testcase_coalesce_events() {
+    local event_beg=$1 event_end=$2
+    shift 2
+
+    pt_testcase_begin
+    pt_add_fifo "$main_fifo_file"
+    pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 0},
+    cb = function() end,
+    coalesce_events = true,
+    event = $event_beg
+        local _, count = ...
+        if not f then
+            f = assert(io.open('$main_fifo_file', 'w'))
+            f:setvbuf('line')
+        end
+        total = (total or 0) + count
+        f:write(total .. '\n')
+    $event_end,
+}
+__EOF__
+    pt_spawn_luastatus_directly -e -b "$mock_barlib" -B gen_events=1000 "$@"
+    exec {pfd}<"$main_fifo_file"
+    # Events may be coalesced arbitrarily, but none of them may be lost.
+    local x_total=0
+    while IFS= read -r PT_LINE <&$pfd; do
+        if (( PT_LINE <= x_total )); then
+            pt_fail "Unexpected line: '$PT_LINE' after '$x_total'."
+        fi
+        x_total=$PT_LINE
+    done
+    if (( x_total != 1000 )); then
+        pt_fail "Expected total count 1000, found $x_total."
+    fi
+    pt_wait_luastatus
+    pt_close_fd "$pfd"
+    pt_testcase_end
+}
+
+x_testcase_coalesce_events 'function(...)' 'end'
+x_testcase_coalesce_events '[[' ']]'
+x_testcase_coalesce_events 'function(...)' 'end' -j 3
+x_testcase_coalesce_events '[[' ']]' -j 3
@@ -0,0 +1,101 @@
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+local is_ok, what, code
+
+is_ok, what, code = luastatus.execute({'sh', '-c', 'exit \$1', 'sh', '42'})
+assert(is_ok == nil)
+assert(what == 'exit')
+assert(code == 42)
+
+is_ok, what, code = luastatus.execute({'true'})
+assert(is_ok == true)
+assert(what == 'exit')
+assert(code == 0)
+
+-- Arguments are passed as-is, with no shell expansion.
+is_ok, what, code = luastatus.execute({'test', '\$HOME', '=', '\$' .. 'HOME'})
+assert(is_ok == true)
+
+is_ok, what, code = luastatus.execute({'/nonexistent/luastatus-test-program'})
+assert(not is_ok)
+assert(type(what) == 'string')
+assert(type(code) == 'number')
+
+assert(not pcall(luastatus.execute, {}))
+assert(not pcall(luastatus.execute, {'true', 1, {}}))
+
+local h = assert(luastatus.spawn('exit 3'))
+is_ok, what, code = h:wait()
+assert(is_ok == nil and what == 'exit' and code == 3)
+-- Results are remembered.
+is_ok, what, code = h:wait()
+assert(is_ok == nil and what == 'exit' and code == 3)
+is_ok, what, code = h:poll()
+assert(is_ok == nil and what == 'exit' and code == 3)
+
+h = assert(luastatus.spawn({'sleep', '1'}))
+assert(h:poll() == nil)
+is_ok, what, code = h:wait()
+assert(is_ok == true and what == 'exit' and code == 0)
+
+h = assert(luastatus.spawn({'sh', '-c', 'kill -9 \$\$'}))
+repeat
+    is_ok, what, code = h:poll()
+until what ~= nil
+assert(is_ok == nil and what == 'signal' and code == 9)
+
+-- Abandoned handles must not break anything.
+luastatus.spawn({'true'})
+collectgarbage()
+collectgarbage()
+
+f:write('ok\n')
+__EOF__
+
+pt_spawn_luastatus_directly -b "$mock_barlib"
+
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'ok' <&$pfd
+pt_close_fd "$pfd"
+
+pt_testcase_end
+
+# Abandoned children are also reaped by /luastatus.execute()/, not only by /luastatus.spawn()/.
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+
+luastatus.spawn({'true'})
+collectgarbage()
+collectgarbage()
+-- Let it terminate.
+assert(luastatus.execute({'sleep', '0.5'}))
+
+-- Count zombie children of luastatus (the parent of this shell); the count is the exit code.
+local _, _, nzombies = luastatus.execute({'sh', '-c', [[
+n=0
+for s in /proc/[0-9]*/stat; do
+    read -r pid comm state ppid rest < "\$s" 2>/dev/null || continue
+    if [ "\$ppid" = "\$PPID" ] && [ "\$state" = Z ]; then
+        n=\$((n + 1))
+    fi
+done
+exit "\$n"
+]]})
+f:write(nzombies .. '\n')
+__EOF__
+
+pt_spawn_luastatus_directly -b "$mock_barlib"
+
+exec {pfd}<"$main_fifo_file"
+pt_expect_line '0' <&$pfd
+pt_close_fd "$pfd"
+
+pt_testcase_end
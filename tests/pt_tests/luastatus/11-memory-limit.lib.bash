@@ -0,0 +1,73 @@
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 1},
+    cb = function()
+        local m = luastatus.memory_usage()
+        f:write(string.format('%s %s %s\n', m.bytes > 0, m.peak >= m.bytes, m.limit))
+    end,
+}
+__EOF__
+pt_spawn_luastatus_directly -e -b "$mock_barlib"
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'true true nil' <&$pfd
+pt_wait_luastatus
+pt_close_fd "$pfd"
+pt_testcase_end
+
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 2},
+    memory_limit = 4 * 1024 * 1024,
+    cb = function()
+        local ok, err = pcall(function()
+            local t = {}
+            for i = 1, 10 * 1000 * 1000 do
+                t[i] = ('x'):rep(100) .. i
+            end
+        end)
+        collectgarbage()
+        local m = luastatus.memory_usage()
+        f:write(string.format('%s %s %s %s\n',
+            ok, tostring(err):match('not enough memory') ~= nil, m.refused > 0, m.limit))
+    end,
+}
+__EOF__
+pt_spawn_luastatus_directly -e -b "$mock_barlib"
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'false true true 4194304' <&$pfd
+pt_expect_line 'false true true 4194304' <&$pfd
+pt_wait_luastatus
+pt_close_fd "$pfd"
+pt_testcase_end
+
+pt_testcase_begin
+pt_write_widget_file <<__EOF__
+widget = {
+    plugin = '$mock_plugin',
+    memory_limit = 'a lot',
+    cb = function() end,
+}
+__EOF__
+assert_works -b "$mock_barlib"
+pt_testcase_end
+
+pt_testcase_begin
+pt_write_widget_file <<__EOF__
+widget = {
+    plugin = '$mock_plugin',
+    memory_limit = 0,
+    cb = function() end,
+}
+__EOF__
+assert_works -b "$mock_barlib"
+pt_testcase_end
@@ -0,0 +1,82 @@
+x_testcase_gc_idle_step() {
+    local idle_step=$1 expected=$2
+
+    pt_testcase_begin
+    pt_add_fifo "$main_fifo_file"
+    pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+-- Only the idle steps (if any) may collect garbage.
+collectgarbage('stop')
+n = 0
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 100},
+    gc = {idle_step = $idle_step},
+    cb = function()
+        n = n + 1
+        local t = {}
+        for i = 1, 1000 do
+            t[i] = ('x'):rep(100) .. i
+        end
+        if n == 100 then
+            f:write(tostring(collectgarbage('count') < 8 * 1024) .. '\n')
+        end
+    end,
+}
+__EOF__
+    pt_spawn_luastatus_directly -e -b "$mock_barlib"
+    exec {pfd}<"$main_fifo_file"
+    pt_expect_line "$expected" <&$pfd
+    pt_wait_luastatus
+    pt_close_fd "$pfd"
+    pt_testcase_end
+}
+
+x_testcase_gc_idle_step nil false
+x_testcase_gc_idle_step 256 true
+
+x_testcase_gc_opts_work() {
+    pt_testcase_begin
+    pt_add_fifo "$main_fifo_file"
+    pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 1},
+    gc = $1,
+    cb = function()
+        f:write('ok\n')
+    end,
+}
+__EOF__
+    pt_spawn_luastatus_directly -e -b "$mock_barlib"
+    exec {pfd}<"$main_fifo_file"
+    pt_expect_line 'ok' <&$pfd
+    pt_wait_luastatus
+    pt_close_fd "$pfd"
+    pt_testcase_end
+}
+
+x_testcase_gc_opts_work "{mode = 'incremental', pause = 150, stepmul = 200}"
+x_testcase_gc_opts_work "{mode = 'generational', idle_step = 64}"
+
+x_testcase_gc_opts_invalid() {
+    pt_testcase_begin
+    pt_write_widget_file <<__EOF__
+widget = {
+    plugin = '$mock_plugin',
+    gc = $1,
+    cb = function() end,
+}
+__EOF__
+    assert_works -b "$mock_barlib"
+    pt_testcase_end
+}
+
+x_testcase_gc_opts_invalid "'generational'"
+x_testcase_gc_opts_invalid "{mode = 'concurrent'}"
+x_testcase_gc_opts_invalid "{pause = 0}"
+x_testcase_gc_opts_invalid "{stepmul = 1.5}"
+x_testcase_gc_opts_invalid "{idle_step = 'a lot'}"
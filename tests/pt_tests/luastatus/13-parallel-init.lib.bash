@@ -0,0 +1,66 @@
+x_nwidgets=8
+
+pt_testcase_begin
+using_measure
+pt_add_fifo "$main_fifo_file"
+for (( i = 0; i < x_nwidgets; ++i )); do
+    pt_write_widget_file <<__EOF__
+-- Each widget takes half a second to initialize.
+luastatus.execute('sleep 0.5')
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 1},
+    cb = function()
+        f:write('cb\n')
+    end,
+}
+__EOF__
+done
+measure_start
+pt_spawn_luastatus_directly -e -p -b "$mock_barlib"
+exec {pfd}<"$main_fifo_file"
+for (( i = 0; i < x_nwidgets; ++i )); do
+    pt_expect_line 'cb' <&$pfd
+done
+x_elapsed=$(measure_get_ms)
+# Initializing the widgets one after another would take 4 seconds.
+if (( x_elapsed > 2000 )); then
+    pt_fail "Startup took $x_elapsed ms."
+fi
+echo >&2 "Startup of $x_nwidgets widgets took $x_elapsed ms."
+pt_wait_luastatus
+pt_close_fd "$pfd"
+pt_testcase_end
+
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+for (( i = 0; i < x_nwidgets; ++i )); do
+    if (( i % 2 )); then
+        pt_write_widget_file <<__EOF__
+widget = {plugin = '$mock_plugin', cb = 'this is not a function'}
+__EOF__
+        continue
+    fi
+    pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 1},
+    event = [[ ]],
+    cb = function()
+        f:write('cb\n')
+    end,
+}
+__EOF__
+done
+pt_spawn_luastatus_directly -e -p -b "$mock_barlib"
+exec {pfd}<"$main_fifo_file"
+for (( i = 0; i < x_nwidgets; i += 2 )); do
+    pt_expect_line 'cb' <&$pfd
+done
+pt_wait_luastatus
+pt_close_fd "$pfd"
+pt_testcase_end
@@ -0,0 +1,28 @@
+# The same widget file is loaded four times: twice from the source (the compiled chunk is only
+# cached on the second load), then twice from the cached compiled chunk, which should have the same
+# chunk name and line information.
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+local src = debug.getinfo(1, 'S').source
+local _, err = pcall(function() error('boom') end)
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 1},
+    cb = function()
+        f:write(tostring(err == src:sub(2) .. ':4: boom') .. '\n')
+    end,
+}
+__EOF__
+PT_WIDGET_FILES+=("${PT_WIDGET_FILES[0]}" "${PT_WIDGET_FILES[0]}" "${PT_WIDGET_FILES[0]}")
+pt_spawn_luastatus_directly -e -b "$mock_barlib"
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'true' <&$pfd
+pt_expect_line 'true' <&$pfd
+pt_expect_line 'true' <&$pfd
+pt_expect_line 'true' <&$pfd
+pt_wait_luastatus
+pt_close_fd "$pfd"
+pt_testcase_end
@@ -0,0 +1,90 @@
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+local function count(t)
+    local n = 0
+    for _ in pairs(t) do
+        n = n + 1
+    end
+    return n
+end
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 1},
+    cb = function()
+        f:write(string.format('%s %s %s %s\n',
+            require('io') == io, package.loaded.math == math, count(table) > 0, math.floor(2.5)))
+        os.custom = 42
+        f:write(string.format('%s %s\n', os.custom, type(os.time())))
+        f:write(debug.traceback('tb'):match('^tb\nstack traceback:') ~= nil and 'ok\n' or 'fail\n')
+    end,
+}
+__EOF__
+pt_spawn_luastatus_directly -e -b "$mock_barlib"
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'true true true 2' <&$pfd
+pt_expect_line '42 number' <&$pfd
+pt_expect_line 'ok' <&$pfd
+pt_wait_luastatus
+pt_close_fd "$pfd"
+pt_testcase_end
+
+# The first use of a library may happen inside a message handler, as with luastatus' own one.
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 1},
+    cb = function()
+        local ok, err = xpcall(
+            function() error('oops') end,
+            function(msg) return debug.traceback(msg) end)
+        f:write(string.format('%s %s\n', ok, err:match('oops\nstack traceback:') ~= nil))
+    end,
+}
+__EOF__
+pt_spawn_luastatus_directly -e -b "$mock_barlib"
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'false true' <&$pfd
+pt_wait_luastatus
+pt_close_fd "$pfd"
+pt_testcase_end
+
+# If opening a library fails (here, because of the memory limit), the next use of it tries again.
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+widget = {
+    plugin = '$mock_plugin',
+    opts = {make_calls = 1},
+    memory_limit = 1024 * 1024,
+    cb = function()
+        -- Nothing may be allocated outside of /pcall/ while the memory is exhausted.
+        local pad = {}
+        local function grow(n) pad[#pad + 1] = ('x'):rep(n) .. #pad end
+        local function get_floor() return math.floor end
+        for _, n in ipairs({1000, 100, 10, 1}) do
+            while pcall(grow, n) do
+            end
+        end
+        local ok1 = pcall(get_floor)
+        pad = nil
+        collectgarbage()
+        local ok2, floor = pcall(get_floor)
+        f:write(string.format('%s %s %s\n', ok1, ok2, floor and floor(2.5)))
+    end,
+}
+__EOF__
+pt_spawn_luastatus_directly -e -b "$mock_barlib"
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'false true 2' <&$pfd
+pt_wait_luastatus
+pt_close_fd "$pfd"
+pt_testcase_end
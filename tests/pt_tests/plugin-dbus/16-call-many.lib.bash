@@ -0,0 +1,84 @@
+x_dbus_begin
+
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+$preface
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/dbus/plugin-dbus.so',
+    opts = {
+        signals = {},
+        greet = true,
+    },
+    cb = function(t)
+        assert(t.what == 'hello', 't.what is not "hello"')
+
+        local res = luastatus.plugin.call_many({
+            {
+                kind = "get_property",
+                bus = "session",
+                dest = "org.freedesktop.DBus",
+                object_path = "/org/freedesktop/DBus",
+                interface = "org.freedesktop.DBus",
+                property_name = "Features",
+            },
+            {
+                kind = "get_all_properties",
+                bus = "session",
+                dest = "org.freedesktop.DBus",
+                object_path = "/org/freedesktop/DBus",
+                interface = "org.freedesktop.DBus",
+            },
+            {
+                bus = "session",
+                dest = "org.freedesktop.DBus",
+                object_path = "/org/freedesktop/DBus",
+                interface = "org.freedesktop.DBus",
+                method = "GetId",
+                args = luastatus.plugin.dbustypes.mkval_from_fmt("()", {}),
+            },
+            {
+                bus = "session",
+                dest = "org.freedesktop.DBus",
+                object_path = "/org/freedesktop/DBus",
+                interface = "org.freedesktop.DBus",
+                method = "NoSuchMethod",
+                args = luastatus.plugin.dbustypes.mkval_from_fmt("()", {}),
+            },
+        })
+        assert(#res == 4, 'result has wrong length')
+
+        assert(res[1][1], res[1][2])
+        assert(type(unpack1(res[1][2])) == 'table', 'features is not an array')
+
+        assert(res[2][1], res[2][2])
+        assert(type(unpack1(res[2][2])) == 'table', 'properties is not a table')
+
+        assert(res[3][1], res[3][2])
+        assert(type(unpack1(res[3][2])) == 'string', 'id is not a string')
+
+        assert(not res[4][1], 'call of a non-existent method has succeeded')
+        assert(type(res[4][2]) == 'string', 'error message is not a string')
+
+        assert(#luastatus.plugin.call_many({}) == 0, 'empty batch')
+
+        local is_ok = pcall(luastatus.plugin.call_many, {{kind = "set_property"}})
+        assert(not is_ok, 'invalid kind was accepted')
+
+        f:write('ok\n')
+    end,
+}
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+
+pt_expect_line 'ok' <&$pfd
+
+pt_close_fd "$pfd"
+pt_testcase_end
+
+x_dbus_end
@@ -0,0 +1,67 @@
+for x in false true; do
+    x_dbus_begin
+
+    pt_testcase_begin
+    pt_add_fifo "$main_fifo_file"
+    pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+$preface
+
+local native = $x
+local int_type = native and 'number' or 'string'
+
+local function check_lowlevel()
+    local DTLL = luastatus.plugin.dbustypes_lowlevel
+
+    local small = DTLL.mkval_simple(DTLL.mktype_simple('i'), -42)
+    assert(small:to_lua() == '-42', 'to_lua() did not return a string')
+    assert(small:to_lua(true) == -42, 'to_lua(true) did not return a number')
+
+    local big = DTLL.mkval_simple(DTLL.mktype_simple('t'), '18446744073709551615')
+    assert(big:to_lua(true) == '18446744073709551615', 'out-of-range uint64 is not a string')
+end
+
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/dbus/plugin-dbus.so',
+    opts = {
+        signals = {},
+        greet = true,
+        native_integers = native,
+    },
+    cb = function(t)
+        assert(t.what == 'hello', 't.what is not "hello"')
+
+        check_lowlevel()
+
+        local is_ok, res = luastatus.plugin.call_method({
+            bus = "session",
+            dest = "org.freedesktop.DBus",
+            object_path = "/org/freedesktop/DBus",
+            interface = "org.freedesktop.DBus",
+            method = "GetConnectionUnixUser",
+            args = luastatus.plugin.dbustypes.mkval_from_fmt("(s)", {"org.freedesktop.DBus"}),
+        })
+        assert(is_ok, res)
+        local uid = unpack1(res)
+        assert(type(uid) == int_type, 'uid is of type ' .. type(uid))
+        if native and math.type then
+            assert(math.type(uid) == 'integer', 'uid is not an integer')
+        end
+
+        f:write('ok\n')
+    end,
+}
+__EOF__
+    pt_spawn_luastatus
+    exec {pfd}<"$main_fifo_file"
+    pt_expect_line 'init' <&$pfd
+
+    pt_expect_line 'ok' <&$pfd
+
+    pt_close_fd "$pfd"
+    pt_testcase_end
+
+    x_dbus_end
+done
@@ -0,0 +1,135 @@
+if (( ! PLUGIN_DBUS_OPTIONAL )); then
+    return 0
+fi
+
+x_dbus_begin
+x_dbus_spawn_dbus_srv_py
+
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+$preface
+
+local function do_call_plugin_function(f, params)
+    local is_ok, res = f(params)
+    assert(is_ok, res)
+    return res
+end
+
+local function mkparams(extra)
+    local res = {
+        bus = "session",
+        dest = "io.github.shdown.luastatus.test",
+        object_path = "/io/github/shdown/luastatus/test/MyObject",
+        interface = "io.github.shdown.luastatus.test",
+    }
+    for k, v in pairs(extra or {}) do
+        res[k] = v
+    end
+    return res
+end
+
+local function call_my_method(method, args_fmt, args)
+    return do_call_plugin_function(luastatus.plugin.call_method, mkparams({
+        method = method,
+        args = luastatus.plugin.dbustypes.mkval_from_fmt(args_fmt, args),
+    }))
+end
+
+local function set_prop(value)
+    do_call_plugin_function(luastatus.plugin.set_property_str, mkparams({
+        property_name = "MyProperty",
+        value_str = value,
+    }))
+end
+
+local function get_cached_prop()
+    local res = do_call_plugin_function(luastatus.plugin.get_cached_property, mkparams({
+        property_name = "MyProperty",
+    }))
+    return unpack1(res)
+end
+
+local function get_all_cached_props()
+    local res = do_call_plugin_function(luastatus.plugin.get_all_cached_properties, mkparams())
+    local k, v = unpack2(unpack1(unpack1(res)))
+    assert(k == 'MyProperty')
+    return v
+end
+
+local function check_ncalls(expected)
+    local res = call_my_method("GetPropCallCounts", "()", {})
+    local got = string.format('Get=%s GetAll=%s', res[1], res[2])
+    assert(got == expected, 'got: ' .. got .. ', expected: ' .. expected)
+end
+
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/dbus/plugin-dbus.so',
+    opts = {
+        signals = {},
+        greet = true,
+        property_cache = {
+            {
+                dest = "io.github.shdown.luastatus.test",
+                object_path = "/io/github/shdown/luastatus/test/MyObject",
+                interface = "io.github.shdown.luastatus.test",
+            },
+        },
+    },
+    cb = function(t)
+        if t.what == 'hello' then
+            local is_ok = pcall(
+                luastatus.plugin.get_cached_property,
+                mkparams({interface = "no.such.interface", property_name = "MyProperty"}))
+            assert(not is_ok, 'lookup of a non-cached interface has succeeded')
+
+            set_prop('one')
+            assert(get_cached_prop() == 'one')
+            assert(get_cached_prop() == 'one')
+            assert(get_all_cached_props() == 'one')
+            check_ncalls('Get=0 GetAll=1')
+
+            call_my_method("SetMyPropertyAndInvalidate", "(s)", {'two'})
+            f:write('hello-ok\n')
+            return
+        end
+
+        assert(t.what == 'signal', 't.what is not "signal"')
+        assert(t.signal == 'PropertiesChanged')
+        local changed, invalidated = t.parameters[2], t.parameters[3]
+
+        if #invalidated > 0 then
+            assert(get_cached_prop() == 'two')
+            check_ncalls('Get=1 GetAll=1')
+            set_prop('three')
+            f:write('invalidated-ok\n')
+
+        elseif #changed > 0 and changed[1][2] == 'three' then
+            assert(get_all_cached_props() == 'three')
+            assert(get_cached_prop() == 'three')
+            check_ncalls('Get=1 GetAll=1')
+
+            luastatus.plugin.invalidate_cached_properties(mkparams())
+            assert(get_cached_prop() == 'three')
+            check_ncalls('Get=1 GetAll=2')
+            f:write('changed-ok\n')
+        end
+    end,
+}
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+
+pt_expect_line 'hello-ok' <&$pfd
+pt_expect_line 'invalidated-ok' <&$pfd
+pt_expect_line 'changed-ok' <&$pfd
+
+pt_close_fd "$pfd"
+pt_testcase_end
+
+x_dbus_kill_dbus_srv_py
+x_dbus_end
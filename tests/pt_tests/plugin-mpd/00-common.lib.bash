@@ -37,6 +37,14 @@ fakempd_say() {
     printf '%s\n' "$1" >&${PT_SPAWNED_THINGS_FDS_1[mpd_parrot]}
 }
 
+# Expects the query the plugin sends after connecting and after each idle wakeup.
+fakempd_expect_query() {
+    fakempd_expect 'command_list_ok_begin'
+    fakempd_expect 'currentsong'
+    fakempd_expect 'status'
+    fakempd_expect 'command_list_end'
+}
+
 fakempd_kill() {
     pt_kill_thing mpd_parrot
 }
@@ -32,16 +32,15 @@ pt_expect_line 'cb connecting' <&$pfd
 fakempd_say "OK MPD I-am-actually-a-shell-script"
 
 for (( i = 0; i < 3; ++i )); do
-    fakempd_expect 'currentsong'
+    fakempd_expect_query
     fakempd_say "Song_Foo: bar"
     fakempd_say "Song_Baz: quiz"
-    fakempd_say "OK"
-
-    fakempd_expect 'status'
+    fakempd_say "list_OK"
     fakempd_say "Status_One: ein"
     fakempd_say "Status_Two: zwei"
     fakempd_say "Status_Three: drei"
     fakempd_say "Z: $i"
+    fakempd_say "list_OK"
     fakempd_say "OK"
 
     fakempd_expect 'idle mixer player'
@@ -35,16 +35,15 @@ fakempd_expect 'password "qwerty123456"'
 fakempd_say "OK"
 
 for (( i = 0; i < 3; ++i )); do
-    fakempd_expect "currentsong"
+    fakempd_expect_query
     fakempd_say "Song_Foo: bar"
     fakempd_say "Song_Baz: quiz"
-    fakempd_say "OK"
-
-    fakempd_expect "status"
+    fakempd_say "list_OK"
     fakempd_say "Status_One: ein"
     fakempd_say "Status_Two: zwei"
     fakempd_say "Status_Three: drei"
     fakempd_say "Z: $i"
+    fakempd_say "list_OK"
     fakempd_say "OK"
 
     fakempd_expect "idle my custom events string"
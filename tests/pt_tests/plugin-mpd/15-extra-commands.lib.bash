@@ -0,0 +1,76 @@
+pt_testcase_begin
+
+fakempd_spawn
+
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+$preface
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/mpd/plugin-mpd.so',
+    opts = {
+        port = $port,
+        extra_commands = {'stats', 'replay_gain_status'},
+    },
+    cb = function(t)
+        if t.what == 'update' then
+            f:write(string.format(
+                'cb update song=%s status=%s stats=%s replay_gain_status=%s\n',
+                _fmt_kv(t.song),
+                _fmt_kv(t.status),
+                _fmt_kv(t.extra.stats),
+                _fmt_kv(t.extra.replay_gain_status)))
+        else
+            f:write('cb ' .. t.what .. '\n')
+        end
+    end,
+}
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+pt_expect_line 'cb connecting' <&$pfd
+
+fakempd_say "OK MPD I-am-actually-a-shell-script"
+
+fakempd_expect "command_list_ok_begin"
+fakempd_expect "currentsong"
+fakempd_expect "status"
+fakempd_expect "stats"
+fakempd_expect "replay_gain_status"
+fakempd_expect "command_list_end"
+fakempd_say "Title: Foo"
+fakempd_say "list_OK"
+fakempd_say "state: play"
+fakempd_say "list_OK"
+fakempd_say "uptime: 42"
+fakempd_say "songs: 7"
+fakempd_say "list_OK"
+fakempd_say "replay_gain_mode: off"
+fakempd_say "list_OK"
+fakempd_say "OK"
+
+fakempd_expect "idle mixer player"
+pt_expect_line "cb update song={Title=>Foo} status={state=>play} stats={songs=>7,uptime=>42} replay_gain_status={replay_gain_mode=>off}" <&$pfd
+
+# An error in any command of the list fails the whole query.
+fakempd_say "changed: player"
+fakempd_say "OK"
+
+fakempd_expect "command_list_ok_begin"
+fakempd_expect "currentsong"
+fakempd_expect "status"
+fakempd_expect "stats"
+fakempd_expect "replay_gain_status"
+fakempd_expect "command_list_end"
+fakempd_say "list_OK"
+fakempd_say "list_OK"
+fakempd_say "ACK [5@2] {stats} unknown command \"stats\""
+
+pt_expect_line 'cb error' <&$pfd
+
+fakempd_wait
+
+pt_testcase_end
@@ -0,0 +1,59 @@
+pt_testcase_begin
+
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+
+N = 100
+
+function make_data_source(num)
+    return string.format("MY_NUM = %d\n", num) .. [[
+        widget = {
+            plugin = '$PT_BUILD_DIR/plugins/timer/plugin-timer.so',
+            opts = {
+                period = 100,
+            },
+            cb = function(t)
+                return string.format("value%d", MY_NUM)
+            end,
+        }
+    ]]
+end
+
+data_sources = {}
+for i = 1, N do
+    data_sources['src' .. i] = make_data_source(i)
+end
+
+seen = {}
+nseen = 0
+
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/multiplex/plugin-multiplex.so',
+    opts = {
+        data_sources = data_sources,
+    },
+    cb = function(t)
+        assert(t.what == 'update')
+        for k, v in pairs(t.updates) do
+            assert(v == 'value' .. k:sub(4))
+            assert(not seen[k])
+            seen[k] = true
+            nseen = nseen + 1
+        end
+        if nseen == N then
+            f:write('all seen\n')
+        end
+    end,
+}
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+
+pt_expect_line 'all seen' <&$pfd
+
+pt_close_fd "$pfd"
+pt_testcase_end
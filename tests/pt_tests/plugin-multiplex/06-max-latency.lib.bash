@@ -0,0 +1,46 @@
+pt_testcase_begin
+
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+
+function make_data_source(num)
+    return string.format("MY_NUM = %d\n", num) .. [[
+        widget = {
+            plugin = '$PT_BUILD_DIR/plugins/timer/plugin-timer.so',
+            opts = {
+                period = 100,
+            },
+            cb = function(t)
+                return string.format("value%d", MY_NUM)
+            end,
+        }
+    ]]
+end
+
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/multiplex/plugin-multiplex.so',
+    opts = {
+        data_sources = {
+            src1 = make_data_source(1),
+            src2 = make_data_source(2),
+            src3 = make_data_source(3),
+        },
+        max_latency = 0.5,
+    },
+    cb = function(t)
+        assert(t.what == 'update')
+        f:write(string.format('cb %s %s %s\n', t.updates.src1, t.updates.src2, t.updates.src3))
+    end,
+}
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+
+pt_expect_line 'cb value1 value2 value3' <&$pfd
+
+pt_close_fd "$pfd"
+pt_testcase_end
@@ -0,0 +1,50 @@
+pt_testcase_begin
+using_measure
+
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/multiplex/plugin-multiplex.so',
+    opts = {
+        data_sources = {
+            src1 = [[
+                i = 0
+                widget = {
+                    plugin = '$PT_BUILD_DIR/plugins/timer/plugin-timer.so',
+                    opts = {
+                        period = 0.05,
+                    },
+                    cb = function(t)
+                        i = i + 1
+                        return tostring(i)
+                    end,
+                }
+            ]],
+        },
+        min_interval = 0.5,
+    },
+    cb = function(t)
+        assert(t.what == 'update')
+        f:write('cb\n')
+    end,
+}
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+
+pt_expect_line 'cb' <&$pfd
+measure_start
+pt_expect_line 'cb' <&$pfd
+measure_check_ms 500
+pt_expect_line 'cb' <&$pfd
+measure_check_ms 500
+pt_expect_line 'cb' <&$pfd
+measure_check_ms 500
+
+pt_close_fd "$pfd"
+pt_testcase_end
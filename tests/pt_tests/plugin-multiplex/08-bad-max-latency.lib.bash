@@ -0,0 +1,23 @@
+pt_testcase_begin
+pt_write_widget_file <<__EOF__
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/multiplex/plugin-multiplex.so',
+    opts = {
+        data_sources = {
+            src1 = [[
+                widget = {
+                    plugin = '$PT_BUILD_DIR/plugins/timer/plugin-timer.so',
+                    opts = {period = 0.1},
+                    cb = function() return 'value' end,
+                }
+            ]],
+        },
+        max_latency = math.huge,
+    },
+    cb = function(t) end,
+}
+__EOF__
+# The widget must fail to initialize, so that luastatus exits.
+pt_spawn_luastatus -e
+pt_wait_luastatus || pt_fail "luastatus exited with non-zero code $?"
+pt_testcase_end
@@ -0,0 +1,75 @@
+x_testcase_iface_filter()
+{
+    local opts_lua=$1
+    local awk_cond=$2
+
+    pt_testcase_begin
+    pt_add_fifo "$main_fifo_file"
+    pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+local function _fmt_t(t)
+    local s = {}
+    for k, v in pairs(t) do
+        for _, x in ipairs(v.ipv4 or {}) do
+            s[#s + 1] = string.format('%s ipv4 %s', k, x)
+        end
+        for _, x in ipairs(v.ipv6 or {}) do
+            s[#s + 1] = string.format('%s ipv6 %s', k, x)
+        end
+    end
+    if #s == 0 then
+        return ''
+    end
+    table.sort(s)
+    return table.concat(s, ';') .. ';'
+end
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/network-linux/plugin-network-linux.so',
+    opts = {
+        new_ip_fmt = true,
+        new_overall_fmt = true,
+        $opts_lua
+    },
+    cb = function(t)
+        if t.what == 'error' then
+            f:write('cb error\n')
+        else
+            f:write('cb ok ' .. _fmt_t(t.data) .. '\n')
+        end
+    end,
+}
+__EOF__
+    pt_spawn_luastatus
+    exec {pfd}<"$main_fifo_file"
+    pt_expect_line 'init' <&$pfd
+
+    local listnets_binary=$PT_BUILD_DIR/tests/listnets
+    local c=0 nets expect_str
+    nets=$("$listnets_binary") || c=$?
+    case "$c" in
+    0)
+        nets=$(printf '%s\n' "$nets" | awk "$awk_cond" | LC_ALL=C sort | tr '\n' ';')
+        expect_str="cb ok $nets"
+        ;;
+    1)
+        expect_str="cb error"
+        ;;
+    *)
+        pt_fail "listnets binary ('$listnets_binary') failed with code $c."
+        ;;
+    esac
+
+    pt_expect_line "$expect_str" <&$pfd
+
+    pt_close_fd "$pfd"
+    pt_testcase_end
+}
+
+x_testcase_iface_filter "iface_only = {'lo'}," '$1 == "lo"'
+x_testcase_iface_filter "iface_except = {'lo'}," '$1 != "lo"'
+x_testcase_iface_filter "iface_only = {'l*'}," '$1 ~ /^l/'
+x_testcase_iface_filter "iface_only = {'lo', 'e*'}, iface_except = {'eth0'}," \
+    '$1 == "lo" || ($1 ~ /^e/ && $1 != "eth0")'
+x_testcase_iface_filter "iface_only = {'no-such-iface'}," '0'
@@ -0,0 +1,30 @@
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+x = dofile('$PT_SOURCE_DIR/plugins/network-rate-linux/network-rate-linux.lua')
+widget = x.widget{
+    source = 'netlink',
+    in_array_form = true,
+    period = 0.1,
+    cb = function(t)
+        for _, PQ in ipairs(t) do
+            assert(type(PQ[1]) == 'string')
+            assert(type(PQ[2].R) == 'number' and PQ[2].R >= 0)
+            assert(type(PQ[2].S) == 'number' and PQ[2].S >= 0)
+        end
+        f:write('cb ok\n')
+    end,
+}
+widget.plugin = ('$PT_BUILD_DIR/plugins/{}/plugin-{}.so'):gsub('{}', widget.plugin)
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+pt_expect_line 'cb ok' <&$pfd
+pt_expect_line 'cb ok' <&$pfd
+pt_expect_line 'cb ok' <&$pfd
+pt_close_fd "$pfd"
+pt_testcase_end
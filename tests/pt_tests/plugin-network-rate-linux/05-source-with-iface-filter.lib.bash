@@ -0,0 +1,15 @@
+pt_testcase_begin
+pt_write_widget_file <<__EOF__
+x = dofile('$PT_SOURCE_DIR/plugins/network-rate-linux/network-rate-linux.lua')
+widget = x.widget{
+    source = 'netlink',
+    iface_filter = function(_) return true end,
+    period = 0.1,
+    cb = function(_) end,
+}
+widget.plugin = ('$PT_BUILD_DIR/plugins/{}/plugin-{}.so'):gsub('{}', widget.plugin)
+__EOF__
+# The widget must fail to initialize, so that luastatus exits.
+pt_spawn_luastatus -e
+pt_wait_luastatus || pt_fail "luastatus exited with non-zero code $?"
+pt_testcase_end
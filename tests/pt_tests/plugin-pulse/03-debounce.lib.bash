@@ -0,0 +1,54 @@
+pt_require_tools pacmd
+
+x_pulse_begin
+
+pt_testcase_begin
+
+pt_spawn_thing_pipe pulsetalker "$PT_SOURCE_DIR"/tests/pulsetalker.sh "$sink_name"
+pt_expect_line 'ready' <&${PT_SPAWNED_THINGS_FDS_0[pulsetalker]}
+
+pt_check pacmd set-sink-mute "$sink_name" false
+pt_check pacmd set-sink-volume "$sink_name" 65536
+
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/pulse/plugin-pulse.so',
+    opts = {
+        sink = '$sink_name',
+        debounce = 2,
+    },
+    cb = function(t)
+        f:write(string.format('cb %.0f%%\n', t.cur / t.norm * 100))
+    end,
+}
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+pt_expect_line 'cb 100%' <&$pfd
+
+for (( i = 1; i <= 10; ++i )); do
+    pt_check pacmd set-sink-volume "$sink_name" $(( i * 1000 ))
+done
+
+# The burst of volume changes must be collapsed into (nearly) one call.
+ncalls=0
+while true; do
+    pt_read_line <&$pfd
+    (( ++ncalls ))
+    if [[ "$PT_LINE" == 'cb 15%' ]]; then
+        break
+    fi
+done
+if (( ncalls > 3 )); then
+    pt_fail "too many calls to cb: $ncalls"
+fi
+
+pt_close_fd "$pfd"
+pt_testcase_end
+
+x_pulse_end
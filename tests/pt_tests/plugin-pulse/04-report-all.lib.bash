@@ -0,0 +1,63 @@
+pt_require_tools pacmd
+
+x_pulse_begin
+
+pt_testcase_begin
+
+pt_spawn_thing_pipe pulsetalker "$PT_SOURCE_DIR"/tests/pulsetalker.sh "$sink_name"
+pt_expect_line 'ready' <&${PT_SPAWNED_THINGS_FDS_0[pulsetalker]}
+
+pt_check pacmd set-sink-mute "$sink_name" false
+pt_check pacmd set-sink-volume "$sink_name" 65536
+
+pt_add_fifo "$main_fifo_file"
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+local last_line = nil
+widget = {
+    plugin = '$PT_BUILD_DIR/plugins/pulse/plugin-pulse.so',
+    opts = {
+        report_all = true,
+    },
+    cb = function(t)
+        assert(type(t.sinks) == 'table')
+        assert(type(t.sources) == 'table')
+        local line = 'no sink'
+        for _, sink in ipairs(t.sinks) do
+            if sink.name == '$sink_name' then
+                line = string.format('sink %.0f%%', sink.cur / sink.norm * 100)
+                if sink.mute then
+                    line = line .. ' (mute)'
+                end
+            end
+        end
+        for _, source in ipairs(t.sources) do
+            if source.name == '$sink_name.monitor' then
+                assert(source.is_monitor, 'monitor source is not reported as such')
+                line = line .. ', monitor'
+            end
+        end
+        if line ~= last_line then
+            f:write(line .. '\n')
+        end
+        last_line = line
+    end,
+}
+__EOF__
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+pt_expect_line "sink 100%, monitor" <&$pfd
+
+pacmd set-sink-volume "$sink_name" 32768
+pt_expect_line "sink 50%, monitor" <&$pfd
+
+pacmd set-sink-mute "$sink_name" true
+pt_expect_line "sink 50% (mute), monitor" <&$pfd
+
+pt_close_fd "$pfd"
+pt_testcase_end
+
+x_pulse_end
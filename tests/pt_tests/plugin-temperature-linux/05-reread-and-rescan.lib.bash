@@ -0,0 +1,65 @@
+pt_testcase_begin
+pt_add_fifo "$main_fifo_file"
+tmp_root=$(mktemp -d) || pt_fail "'mktemp -d' failed"
+temperature_linux_create_carcass "$tmp_root" "
+D thermal/thermal_zone10
+F thermal/thermal_zone10/temp 10000
+D thermal/thermal_zone2
+F thermal/thermal_zone2/temp 2000
+D hwmon/hwmon0
+F hwmon/hwmon0/name k10temp
+F hwmon/hwmon0/temp10_input 30000
+F hwmon/hwmon0/temp2_input 32000
+"
+pt_add_dir_to_remove "$tmp_root"
+
+pt_write_widget_file <<__EOF__
+f = assert(io.open('$main_fifo_file', 'w'))
+f:setvbuf('line')
+f:write('init\n')
+x = dofile('$PT_SOURCE_DIR/plugins/temperature-linux/temperature-linux.lua')
+local last_line
+widget = x.widget({
+    timer_opts = {period = 0.05},
+    cb = function(t)
+        local line
+        if not t then
+            line = 'cb nil'
+        else
+            line = 'cb'
+            for _, x in ipairs(t) do
+                line = line .. string.format(' %s:%s:%.0f', x.kind, x.name, x.value * 1000)
+            end
+        end
+        if line ~= last_line then
+            f:write(line .. '\n')
+            last_line = line
+        end
+    end,
+}, {
+    _thermal_path = '$tmp_root/thermal',
+    _hwmon_path = '$tmp_root/hwmon',
+})
+widget.plugin = ('$PT_BUILD_DIR/plugins/{}/plugin-{}.so'):gsub('{}', widget.plugin)
+__EOF__
+
+pt_spawn_luastatus
+exec {pfd}<"$main_fifo_file"
+pt_expect_line 'init' <&$pfd
+pt_expect_line 'cb thermal:thermal_zone2:2000 thermal:thermal_zone10:10000 hwmon:k10temp:32000 hwmon:k10temp:30000' <&$pfd
+
+# The sensor files are overwritten in place (without truncation), so that the plugin never sees an
+# empty file.
+printf '%s\n' 33000 1<> "$tmp_root"/hwmon/hwmon0/temp2_input
+pt_expect_line 'cb thermal:thermal_zone2:2000 thermal:thermal_zone10:10000 hwmon:k10temp:33000 hwmon:k10temp:30000' <&$pfd
+
+printf '%s\n' garbage 1<> "$tmp_root"/thermal/thermal_zone10/temp
+pt_expect_line 'cb nil' <&$pfd
+# After the rescan, the broken sensor has not been readable since it was discovered, so it is just
+# omitted.
+pt_expect_line 'cb thermal:thermal_zone2:2000 hwmon:k10temp:33000 hwmon:k10temp:30000' <&$pfd
+printf '%s\n' 11000 1<> "$tmp_root"/thermal/thermal_zone10/temp
+pt_expect_line 'cb thermal:thermal_zone2:2000 thermal:thermal_zone10:11000 hwmon:k10temp:33000 hwmon:k10temp:30000' <&$pfd
+
+pt_close_fd "$pfd"
+pt_testcase_end
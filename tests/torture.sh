@@ -72,4 +72,51 @@ run2 10000 10000 \
 run2 100000 100000 \
     --tool=helgrind
 
+# Prints the resident set size of luastatus with a multiplex widget of $1 data sources sharing $2
+# Lua interpreter instances (0 means each data source has its own one), once all of them have
+# produced their first value.
+measure_multiplex_rss() {
+    local nsrcs=$1 nstates=$2 fifo pid rss
+    fifo=$(mktemp -u)
+    mkfifo -- "$fifo"
+    "${LUASTATUS[@]}" -b "$BUILD_DIR"/tests/barlib-mock.so <(cat <<__EOF__
+f = assert(io.open('$fifo', 'w'))
+data_sources = {}
+for i = 1, $nsrcs do
+    data_sources['src' .. i] = [[
+        widget = {
+            plugin = '$BUILD_DIR/plugins/timer/plugin-timer.so',
+            opts = {period = 1000},
+            cb = function() return 'x' end,
+        }
+    ]]
+end
+nseen = 0
+widget = {
+    plugin = '$BUILD_DIR/plugins/multiplex/plugin-multiplex.so',
+    opts = {data_sources = data_sources, lua_states = $nstates},
+    cb = function(t)
+        for _ in pairs(t.updates) do
+            nseen = nseen + 1
+        end
+        if nseen == $nsrcs then
+            f:write('ready\n')
+            f:close()
+        end
+    end,
+}
+__EOF__
+) &
+    pid=$!
+    read -r _ < "$fifo"
+    rss=$(awk '$1 == "VmRSS:" { print $2 }' /proc/"$pid"/status)
+    kill "$pid"
+    wait "$pid" || true
+    rm -f -- "$fifo"
+    echo >&2 "multiplex RSS: sources=$nsrcs lua_states=$nstates rss_kb=$rss"
+}
+
+measure_multiplex_rss 64 0
+measure_multiplex_rss 64 4
+
 echo >&2 "=== PASSED ==="